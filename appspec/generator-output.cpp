@@ -217,147 +217,97 @@ void Generator::WriteApplicationCode(ostream &os) const
     if (!symbolsAssigned)
         throw string("Internal error: Symbol not assigned");
 
-    static string engineAppSpec1EngineVersion = "1.2.3.0";
-    static string engineAppSpec1EngineVersionHex = "0x01020300";
-    static string engineAppSpec1EngineVersionGoodCheck =
-        string("#if ASP_VERSION >= ") + engineAppSpec1EngineVersionHex;
-    static string engineAppSpec1EngineVersionBadCheck =
-        string("#if ASP_VERSION < ") + engineAppSpec1EngineVersionHex;
+    static string functionTableEngineVersion = "1.3.1.0";
+    static string functionTableEngineVersionHex = "0x01030100";
+    static string functionTableEngineVersionBadCheck =
+        string("#if ASP_VERSION < ") + functionTableEngineVersionHex;
 
     os
         << "/*** AUTO-GENERATED; DO NOT EDIT ***/\n\n"
            "#include \"" << fileBaseName << ".h\"\n"
            "#include <stdint.h>\n";
 
-    // Write a minimum engine version check if applicable.
-    if (engineAppSpecVersion >= 1u)
-    {
-        os
-            << "\n" << engineAppSpec1EngineVersionBadCheck << "\n"
-               "#error Asp engine must be version "
-            << engineAppSpec1EngineVersion << " or greater\n"
-            << "#endif\n";
-    }
-
-    // Write the dispatch function.
-    os
-        << "\nstatic AspRunResult AspDispatch_" << variableBaseName
-        << "\n    (AspEngine *engine,\n";
-    if (engineAppSpecVersion == 0)
-        os << "     " << engineAppSpec1EngineVersionGoodCheck << '\n';
-    os << "     int32_t moduleSymbol,";
-    if (engineAppSpecVersion == 0)
-        os << "\n     #endif\n    ";
-    os
-        << " int32_t functionSymbol,\n"
-           "     AspDataEntry *ns, AspDataEntry **returnValue)\n"
-           "{\n";
-    if (engineAppSpecVersion == 0)
-        os << "    " << engineAppSpec1EngineVersionGoodCheck << '\n';
+    // Write a minimum engine version check. The function stubs and the
+    // fields of the application specification structure written below
+    // require an engine that dispatches through a function table. Such an
+    // engine also supports every version of the specification format.
     os
-        << "    switch (moduleSymbol)\n"
-           "    {\n";
+        << "\n" << functionTableEngineVersionBadCheck << "\n"
+           "#error Asp engine must be version "
+        << functionTableEngineVersion << " or greater\n"
+        << "#endif\n";
+
+    // Write a stub for each function that gathers its arguments from the
+    // engine and calls the application's implementation.
+    unsigned functionCount = 0;
     for (const auto &moduleEntry: definitionsByModuleKey)
     {
-        const auto &moduleName = moduleEntry.second.moduleName;
-        auto moduleSymbol = -moduleIdTable.Symbol(moduleName);
-
-        os << "        case " << moduleSymbol << ":\n";
-        if (engineAppSpecVersion == 0)
-            os << "    #endif\n";
-        os
-            << "            switch (functionSymbol)\n"
-               "            {\n"
-               "                default:\n"
-               "                    break;\n";
-
         for (const auto &definitionEntry: *moduleEntry.second.definitions)
         {
-            const auto &name = definitionEntry.first;
             const auto &definition = definitionEntry.second.get();
             const auto functionDefinition =
                 dynamic_cast<const FunctionDefinition *>(definition);
             if (functionDefinition == nullptr)
                 continue;
 
-            auto symbol = symbolTable.Symbol(name);
-
-            os
-                << "                case " << symbol << ":\n"
-                << "                {\n";
-
             const auto &parameters = functionDefinition->Parameters();
+            auto parameterCount = parameters.ParametersSize();
 
-            for (auto parameterIter = parameters.ParametersBegin();
-                 parameterIter != parameters.ParametersEnd();
-                 parameterIter++)
+            os
+                << "\nstatic AspRunResult AspAppFunction_" << variableBaseName
+                << '_' << functionCount++
+                << "\n    (AspEngine *engine, AspDataEntry **returnValue)\n"
+                   "{\n";
+            if (parameterCount != 0)
             {
-                const auto &parameter = **parameterIter;
-
-                const auto &parameterName = parameter.Name();
-                auto parameterSymbol = symbolTable.Symbol(parameterName);
-
-                if (parameter.IsGroup())
-                {
-                    os
-                        << "                    AspParameterResult _"
-                        << parameterName
-                        << " = AspGroupParameterValue(engine, ns, "
-                        << parameterSymbol << ", "
-                        << (parameter.IsTupleGroup() ? "false" : "true")
-                        << ");\n"
-                        << "                    if (_" << parameterName
-                        << ".result != AspRunResult_OK)\n"
-                        << "                        return _" << parameterName
-                        << ".result;\n";
-                }
-                else
-                {
-                    os
-                        << "                    AspDataEntry *_"
-                        << parameterName
-                        << " = AspParameterValue(engine, ns, "
-                        << parameterSymbol << ");\n"
-                        << "                    if (_" << parameterName
-                        << " == 0)\n"
-                        << "                        "
-                        << "return AspRunResult_OutOfDataMemory;\n";
-                }
+                os
+                    << "    AspDataEntry *arguments[" << parameterCount
+                    << "];\n"
+                       "    AspRunResult argumentsResult = AspAppArguments\n"
+                       "        (engine, " << parameterCount
+                    << ", arguments);\n"
+                       "    if (argumentsResult != AspRunResult_OK)\n"
+                       "        return argumentsResult;\n";
             }
-
             os
-                << "                    return "
-                << functionDefinition->InternalName()
-                << "(engine, ";
+                << "    return " << functionDefinition->InternalName()
+                << "\n        (engine, ";
+            for (size_t i = 0; i < parameterCount; i++)
+                os << "arguments[" << i << "], ";
+            os
+                << "returnValue);\n"
+                   "}\n";
+        }
+    }
 
-            for (auto parameterIter = parameters.ParametersBegin();
-                 parameterIter != parameters.ParametersEnd();
-                 parameterIter++)
+    // Write the table of application functions, in the order in which the
+    // engine assigns their identifiers.
+    if (functionCount != 0)
+    {
+        os
+            << "\nstatic const AspAppFunctionEntry AspAppFunctions_"
+            << variableBaseName << "[] =\n"
+               "{\n";
+        unsigned functionId = 0;
+        for (const auto &moduleEntry: definitionsByModuleKey)
+        {
+            for (const auto &definitionEntry:
+                 *moduleEntry.second.definitions)
             {
-                const auto &parameter = **parameterIter;
+                const auto &name = definitionEntry.first;
+                const auto &definition = definitionEntry.second.get();
+                if (dynamic_cast<const FunctionDefinition *>(definition) ==
+                    nullptr)
+                    continue;
 
-                os << '_' << parameter.Name();
-                if (parameter.IsGroup())
-                    os << ".value";
-                os << ", ";
+                os
+                    << "    {" << symbolTable.Symbol(name)
+                    << ", AspAppFunction_" << variableBaseName << '_'
+                    << functionId++ << "},\n";
             }
-
-            os
-                << "returnValue);\n"
-                   "                }\n";
         }
-
-        os << "            }\n";
-        if (engineAppSpecVersion == 0)
-            os << "    " << engineAppSpec1EngineVersionGoodCheck << '\n';
-        os << "            break;\n";
+        os << "};\n";
     }
-    os << "    }\n";
-    if (engineAppSpecVersion == 0)
-        os << "    #endif\n";
-    os
-        << "    return AspRunResult_UndefinedAppFunction;\n"
-           "}\n";
 
     // Write the application specification structure.
     os
@@ -539,8 +489,14 @@ void Generator::WriteApplicationCode(ostream &os) const
             << ",\n    " << specByteCount
             << hex << uppercase << setprecision(4) << setfill('0')
             << ", 0x" << setw(4) << CheckValue() << dec
-            << ", AspDispatch_" << variableBaseName << "\n"
-               "};\n";
+            << ", 0";
+        if (functionCount == 0)
+            os << ", 0, 0";
+        else
+            os
+                << ", AspAppFunctions_" << variableBaseName
+                << ", " << functionCount;
+        os << "\n};\n";
 
         os.flags(oldFlags);
         os.fill(oldFill);
@@ -14,6 +14,14 @@
 
 using namespace std;
 
+static bool SimpleTargetSymbol
+    (Executable &, const Expression *, int32_t &symbol);
+static bool SimpleValue(const Expression *);
+static uint8_t EmitCondition(Executable &, const Expression *);
+static Instruction *FalseJumpInstruction
+    (uint8_t compareOpCode, const Executable::Location &,
+     const string &comment);
+
 void Block::Emit(Executable &executable) const
 {
     for (const auto &statement: statements)
@@ -35,6 +43,48 @@ void AssignmentStatement::Emit(Executable &executable) const
 
 void AssignmentStatement::Emit1(Executable &executable, bool top) const
 {
+    // Assign to or update simple variables using fused instructions where
+    // possible. Additions and subtractions are only fused when the value
+    // has no side effects, as the value is evaluated first.
+    int32_t targetSymbol;
+    if (top && SimpleTargetSymbol(executable, targetExpression, targetSymbol))
+    {
+        bool update =
+            (assignmentTokenType == TOKEN_PLUS_ASSIGN ||
+             assignmentTokenType == TOKEN_MINUS_ASSIGN) &&
+            SimpleValue(valueExpression);
+        if (assignmentTokenType == TOKEN_ASSIGN)
+        {
+            if (valueAssignmentStatement != nullptr)
+                valueAssignmentStatement->Emit1(executable, false);
+            else
+                valueExpression->Emit(executable);
+            executable.InsertVariableAccess
+                (Executable::VariableAccess::Set, targetSymbol,
+                 new SetVariableInstruction
+                    (targetSymbol, "Assign variable with pop"),
+                 sourceLocation, "Assign variable with pop");
+            return;
+        }
+        else if (update)
+        {
+            bool subtract = assignmentTokenType == TOKEN_MINUS_ASSIGN;
+            string comment = subtract ?
+                "Subtract from variable with pop" :
+                "Add to variable with pop";
+            valueExpression->Emit(executable);
+            executable.InsertVariableAccess
+                (subtract ?
+                    Executable::VariableAccess::Subtract :
+                    Executable::VariableAccess::Add,
+                 targetSymbol,
+                 new UpdateVariableInstruction
+                    (targetSymbol, subtract, comment),
+                 sourceLocation, comment);
+            return;
+        }
+    }
+
     if (assignmentTokenType != TOKEN_ASSIGN)
         targetExpression->Emit(executable, Expression::EmitType::Value);
 
@@ -43,6 +93,18 @@ void AssignmentStatement::Emit1(Executable &executable, bool top) const
     else
         valueExpression->Emit(executable);
 
+    // Perform additions with a fused instruction that takes the target's
+    // address, allowing the engine to append to the target's value in place
+    // when nothing else refers to it.
+    if (top && assignmentTokenType == TOKEN_PLUS_ASSIGN)
+    {
+        targetExpression->Emit(executable, Expression::EmitType::Address);
+        executable.Insert
+            (new AddSetInstruction("Add and assign with pop"),
+             sourceLocation);
+        return;
+    }
+
     if (assignmentTokenType != TOKEN_ASSIGN)
     {
         static map<int, uint8_t> opCodes =
@@ -174,9 +236,10 @@ void ImportStatement::Emit(Executable &executable) const
             {
                 ostringstream oss;
                 oss << "Push address of variable " << asName;
-                executable.Insert
-                    (new LoadInstruction(asNameSymbol, true, oss.str()),
-                     sourceLocation);
+                executable.InsertVariableAccess
+                    (Executable::VariableAccess::LoadAddress, asNameSymbol,
+                     new LoadInstruction(asNameSymbol, true, oss.str()),
+                     sourceLocation, oss.str());
             }
             executable.Insert(new SetInstruction(true), sourceLocation);
         }
@@ -188,6 +251,10 @@ void ImportStatement::Emit(Executable &executable) const
                 auto nameSymbol = executable.TemporarySymbol();
                 auto valueSymbol = executable.TemporarySymbol();
 
+                /* Members are copied by symbol at run time, so the
+                   enclosing function's variables cannot use slots. */
+                executable.DisableSlots();
+
                 /* Start iteration over the module's symbols. */
                 {
                     ostringstream oss;
@@ -309,10 +376,12 @@ void ImportStatement::Emit(Executable &executable) const
                     {
                         ostringstream oss;
                         oss << "Load address of variable " << asName;
-                        executable.Insert
-                            (new LoadInstruction
+                        executable.InsertVariableAccess
+                            (Executable::VariableAccess::LoadAddress,
+                             asNameSymbol,
+                             new LoadInstruction
                                 (asNameSymbol, true, oss.str()),
-                             sourceLocation);
+                             sourceLocation, oss.str());
                     }
                     executable.Insert
                         (new SetInstruction(true), sourceLocation);
@@ -333,6 +402,7 @@ void GlobalStatement::Emit(Executable &executable) const
     {
         const auto &name = *iter;
         auto symbol = executable.Symbol(name);
+        executable.ExcludeSlot(symbol);
 
         ostringstream oss;
         oss << "Enable global override for variable " << name;
@@ -353,6 +423,7 @@ void LocalStatement::Emit(Executable &executable) const
     {
         const auto &name = *iter;
         auto symbol = executable.Symbol(name);
+        executable.ExcludeSlot(symbol);
 
         ostringstream oss;
         oss << "Disable global override for variable " << name;
@@ -411,9 +482,10 @@ void DelStatement::Emit1
 
         ostringstream oss;
         oss << "Delete variable " << name;
-        executable.Insert
-            (new DeleteInstruction(symbol, oss.str()),
-             sourceLocation);
+        executable.InsertVariableAccess
+            (Executable::VariableAccess::Delete, symbol,
+             new DeleteInstruction(symbol, oss.str()),
+             sourceLocation, oss.str());
     }
     else
         ThrowError("Invalid type for del");
@@ -489,7 +561,7 @@ void AssertStatement::Emit(Executable &executable) const
 
 void IfStatement::Emit(Executable &executable) const
 {
-    conditionExpression->Emit(executable);
+    auto compareOpCode = EmitCondition(executable, conditionExpression);
 
     auto elseLocation = executable.Insert
         (new NullInstruction, sourceLocation);
@@ -498,8 +570,8 @@ void IfStatement::Emit(Executable &executable) const
 
     executable.PushLocation(elseLocation);
     executable.Insert
-        (new ConditionalJumpInstruction
-            (false, elseLocation, "Jump if false to else"),
+        (FalseJumpInstruction
+            (compareOpCode, elseLocation, "Jump if false to else"),
          sourceLocation);
     trueBlock->Emit(executable);
     if (falseBlock != nullptr || elsePart != nullptr)
@@ -538,7 +610,7 @@ void WhileStatement::Emit(Executable &executable) const
 
     continueLocation = executable.Insert
         (new NullInstruction, sourceLocation);
-    conditionExpression->Emit(executable);
+    auto compareOpCode = EmitCondition(executable, conditionExpression);
 
     auto elseLocation = executable.Insert
         (new NullInstruction, sourceLocation);
@@ -547,8 +619,8 @@ void WhileStatement::Emit(Executable &executable) const
 
     executable.PushLocation(elseLocation);
     executable.Insert
-        (new ConditionalJumpInstruction
-            (false, elseLocation, "Jump if false to else"),
+        (FalseJumpInstruction
+            (compareOpCode, elseLocation, "Jump if false to else"),
          sourceLocation);
     if (falseBlock != nullptr)
     {
@@ -639,10 +711,17 @@ void ForStatement::Emit(Executable &executable) const
         signalStatement.Emit(executable);
     }
     executable.Insert(new DereferenceIteratorInstruction, sourceLocation);
-    targetExpression->Emit
-        (executable, Expression::EmitType::Address);
-
-    executable.Insert(new SetInstruction(true), sourceLocation);
+    int32_t targetSymbol;
+    if (SimpleTargetSymbol(executable, targetExpression, targetSymbol))
+        executable.InsertVariableAccess
+            (Executable::VariableAccess::Set, targetSymbol,
+             new SetVariableInstruction(targetSymbol), sourceLocation);
+    else
+    {
+        targetExpression->Emit
+            (executable, Expression::EmitType::Address);
+        executable.Insert(new SetInstruction(true), sourceLocation);
+    }
     trueBlock->Emit(executable);
     executable.PopLocation();
 
@@ -726,9 +805,21 @@ void DefStatement::Emit(Executable &executable) const
          sourceLocation);
     executable.PopLocation();
 
+    // Resolve the function's local variables to slots while emitting its
+    // body. The parameters take the leading slots.
+    vector<int32_t> parameterSymbols;
+    for (auto iter = parameterList->ParametersBegin();
+         iter != parameterList->ParametersEnd(); iter++)
+        parameterSymbols.push_back(executable.Symbol((*iter)->Name()));
+
     executable.PushLocation(defineLocation);
+    executable.PushSlotScope(parameterSymbols);
     try
     {
+        auto slotsInstruction = new LocalSlotsInstruction
+            ("Define local variable slots");
+        executable.Insert(slotsInstruction, sourceLocation);
+
         block->Emit(executable);
 
         // Emit a final return statement if needed.
@@ -741,9 +832,12 @@ void DefStatement::Emit(Executable &executable) const
                  sourceLocation);
             executable.Insert(new ReturnInstruction, sourceLocation);
         }
+
+        slotsInstruction->Symbols(executable.PopSlotScope());
     }
     catch (...)
     {
+        executable.PopSlotScope();
         executable.PopLocation();
         throw;
     }
@@ -899,6 +993,27 @@ void BinaryExpression::Emit
          sourceLocation);
 }
 
+uint8_t BinaryExpression::ComparisonOpCode() const
+{
+    static map<int, uint8_t> opCodes =
+    {
+        {TOKEN_NE, OpCode_NE},
+        {TOKEN_EQ, OpCode_EQ},
+        {TOKEN_LT, OpCode_LT},
+        {TOKEN_LE, OpCode_LE},
+        {TOKEN_GT, OpCode_GT},
+        {TOKEN_GE, OpCode_GE},
+    };
+    auto iter = opCodes.find(operatorTokenType);
+    return iter == opCodes.end() ? 0 : iter->second;
+}
+
+void BinaryExpression::EmitOperands(Executable &executable) const
+{
+    leftExpression->Emit(executable);
+    rightExpression->Emit(executable);
+}
+
 void UnaryExpression::Emit
     (Executable &executable, EmitType emitType) const
 {
@@ -949,9 +1064,10 @@ void TargetExpression::Emit
         auto symbol = executable.Symbol(name);
         ostringstream oss;
         oss << "Push address of variable " << name;
-        executable.Insert
-            (new LoadInstruction(symbol, true, oss.str()),
-             sourceLocation);
+        executable.InsertVariableAccess
+            (Executable::VariableAccess::LoadAddress, symbol,
+             new LoadInstruction(symbol, true, oss.str()),
+             sourceLocation, oss.str());
     }
     else
     {
@@ -1008,6 +1124,11 @@ void Argument::Emit(Executable &executable) const
     }
 }
 
+void Argument::EmitValue(Executable &executable) const
+{
+    valueExpression->Emit(executable);
+}
+
 void ArgumentList::Emit(Executable &executable) const
 {
     executable.Insert
@@ -1022,6 +1143,12 @@ void ArgumentList::Emit(Executable &executable) const
     }
 }
 
+void ArgumentList::EmitValues(Executable &executable) const
+{
+    for (const auto &argument: arguments)
+        argument->EmitValue(executable);
+}
+
 void CallExpression::Emit
     (Executable &executable, EmitType emitType) const
 {
@@ -1030,6 +1157,21 @@ void CallExpression::Emit
     else if (emitType == EmitType::Delete)
         ThrowError("Cannot delete function call");
 
+    // Pass positional arguments directly on the stack when possible,
+    // avoiding the construction of an argument list.
+    const size_t maxPositionalCount = 0xFF;
+    if (argumentList->IsPositional() &&
+        argumentList->Count() <= maxPositionalCount)
+    {
+        argumentList->EmitValues(executable);
+        functionExpression->Emit(executable);
+        executable.Insert
+            (new PositionalCallInstruction
+                (static_cast<uint8_t>(argumentList->Count())),
+             sourceLocation);
+        return;
+    }
+
     argumentList->Emit(executable);
     functionExpression->Emit(executable);
     executable.Insert(new CallInstruction, sourceLocation);
@@ -1091,10 +1233,14 @@ void VariableExpression::Emit
     oss
         << "Push " << (emitType == EmitType::Address ? "address" : "value")
         << " of variable " << name;
-    executable.Insert
-        (new LoadInstruction
+    executable.InsertVariableAccess
+        (emitType == EmitType::Address ?
+            Executable::VariableAccess::LoadAddress :
+            Executable::VariableAccess::Load,
+         symbol,
+         new LoadInstruction
             (symbol, emitType == EmitType::Address, oss.str()),
-         sourceLocation);
+         sourceLocation, oss.str());
 }
 
 void SymbolExpression::Emit
@@ -1249,6 +1395,9 @@ void ConstantExpression::Emit
             executable.Insert(new PushNoneInstruction, sourceLocation);
             break;
         case Type::Ellipsis:
+            // The ellipsis refers to the local namespace as a whole, which
+            // must then hold all of the enclosing function's variables.
+            executable.DisableSlots();
             executable.Insert(new PushEllipsisInstruction, sourceLocation);
             break;
         case Type::Boolean:
@@ -1267,3 +1416,98 @@ void ConstantExpression::Emit
             break;
     }
 }
+
+static bool SimpleTargetSymbol
+    (Executable &executable, const Expression *expression, int32_t &symbol)
+{
+    auto variableExpression = dynamic_cast<const VariableExpression *>
+        (expression);
+    if (variableExpression != nullptr)
+    {
+        symbol = variableExpression->HasSymbol() ?
+            variableExpression->Symbol() :
+            executable.Symbol(variableExpression->Name());
+        return true;
+    }
+
+    auto targetExpression = dynamic_cast<const TargetExpression *>
+        (expression);
+    if (targetExpression != nullptr && !targetExpression->IsTuple())
+    {
+        symbol = executable.Symbol(targetExpression->Name());
+        return true;
+    }
+
+    return false;
+}
+
+static bool SimpleValue(const Expression *expression)
+{
+    // Constants, variables, and list and tuple displays made up of them can
+    // be evaluated without side effects.
+    if (dynamic_cast<const ConstantExpression *>(expression) != nullptr ||
+        dynamic_cast<const VariableExpression *>(expression) != nullptr)
+        return true;
+
+    auto listExpression = dynamic_cast<const ListExpression *>
+        (expression);
+    if (listExpression != nullptr)
+    {
+        for (auto iter = listExpression->ExpressionsBegin();
+             iter != listExpression->ExpressionsEnd(); iter++)
+        {
+            if (!SimpleValue(*iter))
+                return false;
+        }
+        return true;
+    }
+
+    auto tupleExpression = dynamic_cast<const TupleExpression *>
+        (expression);
+    if (tupleExpression != nullptr)
+    {
+        for (auto iter = tupleExpression->ExpressionsBegin();
+             iter != tupleExpression->ExpressionsEnd(); iter++)
+        {
+            if (!SimpleValue(*iter))
+                return false;
+        }
+        return true;
+    }
+
+    return false;
+}
+
+static uint8_t EmitCondition
+    (Executable &executable, const Expression *expression)
+{
+    // Leave out a final comparison so that it can be fused with the
+    // conditional jump that follows. Return the op code of the comparison,
+    // or zero if there is none.
+    auto binaryExpression = dynamic_cast<const BinaryExpression *>
+        (expression);
+    auto compareOpCode = binaryExpression == nullptr ?
+        0 : binaryExpression->ComparisonOpCode();
+    if (compareOpCode == 0)
+        expression->Emit(executable);
+    else
+        binaryExpression->EmitOperands(executable);
+    return compareOpCode;
+}
+
+static Instruction *FalseJumpInstruction
+    (uint8_t compareOpCode, const Executable::Location &targetLocation,
+     const string &comment)
+{
+    if (compareOpCode == 0)
+        return new ConditionalJumpInstruction(false, targetLocation, comment);
+
+    ostringstream oss;
+    oss
+        << "Compare with operation 0x"
+        << hex << uppercase << setfill('0')
+        << setw(2) << static_cast<unsigned>(compareOpCode)
+        << "; " << comment;
+    return new CompareJumpInstruction
+        (compareOpCode, targetLocation, oss.str());
+}
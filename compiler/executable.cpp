@@ -4,6 +4,7 @@
 
 #include "executable.hpp"
 #include "instruction.hpp"
+#include "opcode.h"
 #include "symbols.h"
 #include <iomanip>
 #include <map>
@@ -67,6 +68,101 @@ Executable::Location Executable::CurrentLocation() const
     return currentLocation;
 }
 
+void Executable::PushSlotScope(const vector<int32_t> &parameterSymbols)
+{
+    slotScopes.emplace();
+    slotScopes.top().parameterSymbols = parameterSymbols;
+}
+
+vector<int32_t> Executable::PopSlotScope()
+{
+    auto scope = move(slotScopes.top());
+    slotScopes.pop();
+    vector<int32_t> slotSymbols;
+    if (scope.disabled)
+        return slotSymbols;
+
+    // Parameters occupy the leading slots, in order, so that arguments can be
+    // bound by position. They are followed by each variable that is bound in
+    // the function, in order of first use. Variables that are only read are
+    // left to the global scope, and any that exceed the capacity of a
+    // single-byte slot index are left in the local namespace.
+    static const size_t MaxSlotCount = 0xFF;
+    map<int32_t, uint8_t> slots;
+    auto addSlot = [&](int32_t symbol)
+    {
+        slots.emplace(symbol, static_cast<uint8_t>(slotSymbols.size()));
+        slotSymbols.push_back(symbol);
+    };
+    for (auto symbol: scope.parameterSymbols)
+    {
+        if (slotSymbols.size() >= MaxSlotCount ||
+            scope.excludedSymbols.count(symbol) != 0 ||
+            slots.count(symbol) != 0)
+            return vector<int32_t>();
+        addSlot(symbol);
+    }
+    for (const auto &accessInfo: scope.accesses)
+    {
+        if (slotSymbols.size() >= MaxSlotCount)
+            break;
+        if (accessInfo.access != VariableAccess::Load &&
+            accessInfo.access != VariableAccess::Delete &&
+            scope.excludedSymbols.count(accessInfo.symbol) == 0 &&
+            slots.count(accessInfo.symbol) == 0)
+            addSlot(accessInfo.symbol);
+    }
+
+    // Replace the symbol-based instructions of slot variables in place,
+    // leaving their locations intact for any branches that target them.
+    static const map<VariableAccess, uint8_t> opCodes =
+    {
+        {VariableAccess::Load, OpCode_LDL},
+        {VariableAccess::LoadAddress, OpCode_LDAL},
+        {VariableAccess::Set, OpCode_SETL},
+        {VariableAccess::Add, OpCode_ADDL},
+        {VariableAccess::Subtract, OpCode_SUBL},
+        {VariableAccess::Delete, OpCode_DELL},
+    };
+    for (const auto &accessInfo: scope.accesses)
+    {
+        auto slotIter = slots.find(accessInfo.symbol);
+        if (slotIter == slots.end())
+            continue;
+
+        auto &instruction = accessInfo.location->instruction;
+        delete instruction;
+        instruction = new LocalSlotInstruction
+            (opCodes.at(accessInfo.access), slotIter->second,
+             accessInfo.comment);
+    }
+
+    return slotSymbols;
+}
+
+Executable::Location Executable::InsertVariableAccess
+    (VariableAccess access, int32_t symbol, Instruction *instruction,
+     const SourceLocation &sourceLocation, const string &comment)
+{
+    auto location = Insert(instruction, sourceLocation);
+    if (!slotScopes.empty())
+        slotScopes.top().accesses.push_back
+            (VariableAccessInfo{access, symbol, location, comment});
+    return location;
+}
+
+void Executable::ExcludeSlot(int32_t symbol)
+{
+    if (!slotScopes.empty())
+        slotScopes.top().excludedSymbols.insert(symbol);
+}
+
+void Executable::DisableSlots()
+{
+    if (!slotScopes.empty())
+        slotScopes.top().disabled = true;
+}
+
 void Executable::MarkModuleLocation
     (const string &name, const Location &location)
 {
@@ -82,25 +178,43 @@ unsigned Executable::ModuleOffset(const string &name) const
 
 void Executable::Finalize()
 {
-    // Assign offsets to each instruction.
-    uint32_t offset = 0;
-    for (auto instructionIter = instructions.begin();
-         instructionIter != instructions.end(); instructionIter++)
+    // Assign offsets to each instruction, relaxing branch instructions to
+    // the smallest encoding that reaches their targets. Because an
+    // instruction only ever grows, repeat until no instruction changes size.
+    uint32_t offset;
+    bool relaxed;
+    do
     {
-        const auto &instruction = instructionIter->instruction;
+        offset = 0;
+        for (auto instructionIter = instructions.begin();
+             instructionIter != instructions.end(); instructionIter++)
+        {
+            const auto &instruction = instructionIter->instruction;
 
-        instruction->Offset(offset);
+            instruction->Offset(offset);
 
-        // Update module location if applicable.
-        for (auto moduleIter = moduleLocations.begin();
-             moduleIter != moduleLocations.end(); moduleIter++)
-        {
-            if (moduleIter->second.first == instructionIter)
-                moduleIter->second.second = offset;
+            // Update module location if applicable.
+            for (auto moduleIter = moduleLocations.begin();
+                 moduleIter != moduleLocations.end(); moduleIter++)
+            {
+                if (moduleIter->second.first == instructionIter)
+                    moduleIter->second.second = offset;
+            }
+
+            offset += instruction->Size();
         }
 
-        offset += instruction->Size();
-    }
+        relaxed = false;
+        for (const auto &instructionInfo: instructions)
+        {
+            const auto &instruction = instructionInfo.instruction;
+
+            if (!instruction->Fixed() &&
+                instruction->Relax
+                    (instruction->TargetLocation()->instruction->Offset()))
+                relaxed = true;
+        }
+    } while (relaxed);
 
     // Check and store the final code size.
     if (offset > MaxCodeSize)
@@ -9,8 +9,10 @@
 #include "grammar.hpp"
 #include <iostream>
 #include <map>
+#include <set>
 #include <stack>
 #include <list>
+#include <vector>
 #include <string>
 #include <cstdint>
 #include <utility>
@@ -53,6 +55,24 @@ class Executable
         void PopLocation();
         Location CurrentLocation() const;
 
+        // Local variable slot methods.
+        enum class VariableAccess
+        {
+            Load,
+            LoadAddress,
+            Set,
+            Add,
+            Subtract,
+            Delete,
+        };
+        void PushSlotScope(const std::vector<std::int32_t> &parameterSymbols);
+        std::vector<std::int32_t> PopSlotScope();
+        Location InsertVariableAccess
+            (VariableAccess, std::int32_t symbol, Instruction *,
+             const SourceLocation &, const std::string &comment = "");
+        void ExcludeSlot(std::int32_t symbol);
+        void DisableSlots();
+
         // Module location methods.
         void MarkModuleLocation(const std::string &name, const Location &);
         unsigned ModuleOffset(const std::string &name) const;
@@ -74,6 +94,22 @@ class Executable
 
     private:
 
+        // Local variable slot types.
+        struct VariableAccessInfo
+        {
+            VariableAccess access;
+            std::int32_t symbol;
+            Location location;
+            std::string comment;
+        };
+        struct SlotScope
+        {
+            std::vector<std::int32_t> parameterSymbols;
+            std::vector<VariableAccessInfo> accesses;
+            std::set<std::int32_t> excludedSymbols;
+            bool disabled = false;
+        };
+
         // Data.
         std::uint32_t checkValue = 0;
         SymbolTable &symbolTable;
@@ -81,6 +117,7 @@ class Executable
         Location currentLocation = instructions.end();
         std::uint32_t finalCodeSize = 0;
         std::stack<Location> locationStack;
+        std::stack<SlotScope> slotScopes;
         std::map<unsigned, std::pair<Location, unsigned> > moduleLocations;
 };
 
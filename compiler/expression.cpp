@@ -144,6 +144,11 @@ bool TargetExpression::IsTuple() const
     return name.empty();
 }
 
+string TargetExpression::Name() const
+{
+    return name;
+}
+
 void TargetExpression::Add(TargetExpression *targetExpression)
 {
     if (IsEnclosed())
@@ -203,6 +208,15 @@ void ArgumentList::Parent(const Statement *statement) const
         argument->Parent(statement);
 }
 
+bool ArgumentList::IsPositional() const
+{
+    for (const auto &argument: arguments)
+        if (argument->HasName() ||
+            argument->GetType() != Argument::Type::NonGroup)
+            return false;
+    return true;
+}
+
 CallExpression::CallExpression
     (Expression *functionExpression, ArgumentList *argumentList) :
     Expression((SourceElement &)*functionExpression),
@@ -280,6 +294,11 @@ bool VariableExpression::HasSymbol() const
     return hasSymbol;
 }
 
+int32_t VariableExpression::Symbol() const
+{
+    return symbol;
+}
+
 string VariableExpression::Name() const
 {
     return name;
@@ -99,6 +99,10 @@ class BinaryExpression : public Expression
 
         void Emit(Executable &, EmitType) const override;
 
+        // Fused compare and jump support.
+        std::uint8_t ComparisonOpCode() const;
+        void EmitOperands(Executable &) const;
+
     private:
 
         int operatorTokenType;
@@ -131,6 +135,7 @@ class TargetExpression : public Expression
         ~TargetExpression() override;
 
         bool IsTuple() const;
+        std::string Name() const;
         void Add(TargetExpression *);
 
         void Parent(const Statement *) override;
@@ -171,6 +176,7 @@ class Argument : public NonTerminal
         }
 
         void Emit(Executable &) const;
+        void EmitValue(Executable &) const;
 
     private:
 
@@ -200,7 +206,14 @@ class ArgumentList : public NonTerminal
             return arguments.end();
         }
 
+        bool IsPositional() const;
+        std::size_t Count() const
+        {
+            return arguments.size();
+        }
+
         void Emit(Executable &) const;
+        void EmitValues(Executable &) const;
 
     private:
 
@@ -265,6 +278,7 @@ class VariableExpression : public Expression
         VariableExpression(const SourceElement &, int32_t symbol);
 
         bool HasSymbol() const;
+        int32_t Symbol() const;
         std::string Name() const;
 
         void Emit(Executable &, EmitType) const override;
@@ -357,6 +371,17 @@ class ListExpression : public Expression
 
         void Parent(const Statement *) override;
 
+        using ConstExpressionIterator =
+            std::list<Expression *>::const_iterator;
+        ConstExpressionIterator ExpressionsBegin() const
+        {
+            return expressions.begin();
+        }
+        ConstExpressionIterator ExpressionsEnd() const
+        {
+            return expressions.end();
+        }
+
         void Emit(Executable &, EmitType) const override;
 
     private:
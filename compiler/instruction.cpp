@@ -59,6 +59,12 @@ void Instruction::Fix(uint32_t targetOffset)
     fixed = true;
 }
 
+bool Instruction::Relax(uint32_t)
+{
+    // Most instructions have a fixed size.
+    return false;
+}
+
 unsigned Instruction::Size() const
 {
     return
@@ -139,6 +145,11 @@ uint8_t Instruction::OpCode() const
     return opCode;
 }
 
+uint32_t Instruction::TargetOffset() const
+{
+    return targetOffset;
+}
+
 NullInstruction::NullInstruction() :
     Instruction(0)
 {
@@ -164,6 +175,82 @@ void NullInstruction::PrintCode(ostream &) const
     // Do nothing.
 }
 
+BranchInstruction::BranchInstruction
+    (uint8_t opCode, const Executable::Location &targetLocation,
+     const string &comment) :
+    Instruction(opCode, targetLocation, comment)
+{
+}
+
+bool BranchInstruction::Relax(uint32_t targetOffset)
+{
+    // Grow the operand until the displacement to the target fits. Operands
+    // never shrink, ensuring that repeated relaxation passes terminate.
+    unsigned newOperandSize = operandSize;
+    while (newOperandSize < 4 &&
+           OperandSize(Displacement(targetOffset, newOperandSize)) >
+           newOperandSize)
+        newOperandSize <<= 1;
+
+    bool changed = newOperandSize != operandSize;
+    operandSize = newOperandSize;
+    return changed;
+}
+
+unsigned BranchInstruction::Size() const
+{
+    return 1 + operandSize;
+}
+
+void BranchInstruction::Write(ostream &os) const
+{
+    if (operandSize == 4)
+    {
+        os.put(static_cast<char>(OpCode()));
+        WriteField(os, TargetOffset(), 4);
+        return;
+    }
+
+    auto relativeOpCode = static_cast<uint8_t>
+        (OpCode() - OpCode_JMPF +
+         (operandSize == 1 ? OpCode_JMPF1 : OpCode_JMPF2));
+    os.put(static_cast<char>(relativeOpCode));
+    auto displacement = Displacement(TargetOffset(), operandSize);
+    uint32_t uDisplacement = *reinterpret_cast<const uint32_t *>
+        (&displacement);
+    WriteField(os, uDisplacement, operandSize);
+}
+
+void BranchInstruction::PrintCode(ostream &os) const
+{
+    static map<uint8_t, string> mnemonics =
+    {
+        {OpCode_JMPF, "JMPF"},
+        {OpCode_JMPT, "JMPT"},
+        {OpCode_JMP, "JMP"},
+        {OpCode_LOR, "LOR"},
+        {OpCode_LAND, "LAND"},
+    };
+    auto iter = mnemonics.find(OpCode());
+    os << (iter != mnemonics.end() ? iter->second : "???");
+    if (operandSize != 4)
+        os << operandSize;
+}
+
+unsigned BranchInstruction::BranchOperandSize() const
+{
+    return operandSize;
+}
+
+int32_t BranchInstruction::Displacement
+    (uint32_t targetOffset, unsigned operandSize) const
+{
+    // Relative displacements are from the following instruction.
+    return
+        static_cast<int32_t>(targetOffset) -
+        static_cast<int32_t>(Offset() + 1 + operandSize);
+}
+
 SimpleInstruction::SimpleInstruction
     (uint8_t opCode, const string &comment) :
     Instruction(opCode, comment)
@@ -221,17 +308,13 @@ void SimpleInstruction::PrintCode(ostream &os) const
         {OpCode_IS, "IS"},
         {OpCode_SET, "SET"},
         {OpCode_SETP, "SETP"},
+        {OpCode_ADDSP, "ADDSP"},
         {OpCode_ERASE, "ERASE"},
         {OpCode_SITER, "SITER"},
         {OpCode_TITER, "TITER"},
         {OpCode_NITER, "NITER"},
         {OpCode_DITER, "DITER"},
         {OpCode_NOOP, "NOOP"},
-        {OpCode_JMPF, "JMPF"},
-        {OpCode_JMPT, "JMPT"},
-        {OpCode_JMP, "JMP"},
-        {OpCode_LOR, "LOR"},
-        {OpCode_LAND, "LAND"},
         {OpCode_CALL, "CALL"},
         {OpCode_RET, "RET"},
         {OpCode_XMOD, "XMOD"},
@@ -489,7 +572,7 @@ BinaryInstruction::BinaryInstruction
 LogicalInstruction::LogicalInstruction
     (uint8_t opCode, const Executable::Location &location,
      const string &comment) :
-    SimpleInstruction(opCode, location, comment)
+    BranchInstruction(opCode, location, comment)
 {
 }
 
@@ -543,6 +626,142 @@ SetInstruction::SetInstruction(bool pop, const string &comment) :
 {
 }
 
+AddSetInstruction::AddSetInstruction(const string &comment) :
+    SimpleInstruction(OpCode_ADDSP, comment)
+{
+}
+
+SetVariableInstruction::SetVariableInstruction
+    (int32_t symbol, const string &comment) :
+    Instruction
+        (OperandSize(symbol) <= 1 ? OpCode_SETP1 :
+         OperandSize(symbol) == 2 ? OpCode_SETP2 : OpCode_SETP4,
+         comment),
+    symbol(symbol)
+{
+}
+
+unsigned SetVariableInstruction::OperandsSize() const
+{
+    return max(1U, OperandSize(symbol));
+}
+
+void SetVariableInstruction::WriteOperands(ostream &os) const
+{
+    uint32_t uSymbol = *reinterpret_cast<const uint32_t *>(&symbol);
+    WriteField(os, uSymbol, OperandsSize());
+}
+
+void SetVariableInstruction::PrintCode(ostream &os) const
+{
+    os << "SETP " << symbol;
+}
+
+UpdateVariableInstruction::UpdateVariableInstruction
+    (int32_t symbol, bool subtract, const string &comment) :
+    Instruction
+        (subtract ?
+            (OperandSize(symbol) <= 1 ? OpCode_SUBP1 :
+             OperandSize(symbol) == 2 ? OpCode_SUBP2 : OpCode_SUBP4) :
+            (OperandSize(symbol) <= 1 ? OpCode_ADDP1 :
+             OperandSize(symbol) == 2 ? OpCode_ADDP2 : OpCode_ADDP4),
+         comment),
+    symbol(symbol),
+    subtract(subtract)
+{
+}
+
+unsigned UpdateVariableInstruction::OperandsSize() const
+{
+    return max(1U, OperandSize(symbol));
+}
+
+void UpdateVariableInstruction::WriteOperands(ostream &os) const
+{
+    uint32_t uSymbol = *reinterpret_cast<const uint32_t *>(&symbol);
+    WriteField(os, uSymbol, OperandsSize());
+}
+
+void UpdateVariableInstruction::PrintCode(ostream &os) const
+{
+    os << (subtract ? "SUBP " : "ADDP ") << symbol;
+}
+
+LocalSlotsInstruction::LocalSlotsInstruction(const string &comment) :
+    Instruction(OpCode_SLOTS, comment)
+{
+}
+
+void LocalSlotsInstruction::Symbols(const vector<int32_t> &symbols)
+{
+    this->symbols = symbols;
+}
+
+unsigned LocalSlotsInstruction::Size() const
+{
+    // The instruction is omitted when there are no slots.
+    return symbols.empty() ? 0 : Instruction::Size();
+}
+
+void LocalSlotsInstruction::Write(ostream &os) const
+{
+    if (!symbols.empty())
+        Instruction::Write(os);
+}
+
+unsigned LocalSlotsInstruction::OperandsSize() const
+{
+    return 1 + 4 * static_cast<unsigned>(symbols.size());
+}
+
+void LocalSlotsInstruction::WriteOperands(ostream &os) const
+{
+    WriteField(os, symbols.size(), 1);
+    for (auto symbol: symbols)
+    {
+        uint32_t uSymbol = *reinterpret_cast<const uint32_t *>(&symbol);
+        WriteField(os, uSymbol, 4);
+    }
+}
+
+void LocalSlotsInstruction::PrintCode(ostream &os) const
+{
+    os << "SLOTS " << symbols.size();
+    for (auto symbol: symbols)
+        os << ", " << symbol;
+}
+
+LocalSlotInstruction::LocalSlotInstruction
+    (uint8_t opCode, uint8_t slot, const string &comment) :
+    Instruction(opCode, comment),
+    slot(slot)
+{
+}
+
+unsigned LocalSlotInstruction::OperandsSize() const
+{
+    return 1;
+}
+
+void LocalSlotInstruction::WriteOperands(ostream &os) const
+{
+    WriteField(os, slot, 1);
+}
+
+void LocalSlotInstruction::PrintCode(ostream &os) const
+{
+    static const map<uint8_t, const char *> names =
+    {
+        {OpCode_LDL, "LDL"},
+        {OpCode_LDAL, "LDAL"},
+        {OpCode_SETL, "SETL"},
+        {OpCode_ADDL, "ADDL"},
+        {OpCode_SUBL, "SUBL"},
+        {OpCode_DELL, "DELL"},
+    };
+    os << names.at(OpCode()) << ' ' << static_cast<unsigned>(slot);
+}
+
 DeleteInstruction::DeleteInstruction
     (int32_t symbol, const string &comment) :
     Instruction
@@ -634,16 +853,66 @@ DereferenceIteratorInstruction::DereferenceIteratorInstruction
 ConditionalJumpInstruction::ConditionalJumpInstruction
     (bool condition, const Executable::Location &targetLocation,
      const string &comment) :
-    SimpleInstruction
+    BranchInstruction
         (condition ? OpCode_JMPT : OpCode_JMPF,
          targetLocation, comment)
 {
 }
 
+CompareJumpInstruction::CompareJumpInstruction
+    (uint8_t compareOpCode, const Executable::Location &targetLocation,
+     const string &comment) :
+    BranchInstruction(OpCode_JMPF, targetLocation, comment),
+    compareOpCode(compareOpCode)
+{
+}
+
+unsigned CompareJumpInstruction::Size() const
+{
+    // When the target is out of range of a relative jump, the comparison
+    // is written as a separate instruction ahead of an absolute jump.
+    unsigned size = BranchInstruction::Size();
+    if (BranchOperandSize() == 4)
+        size++;
+    return size;
+}
+
+void CompareJumpInstruction::Write(ostream &os) const
+{
+    auto operandSize = BranchOperandSize();
+    if (operandSize == 4)
+    {
+        os.put(static_cast<char>(compareOpCode));
+        BranchInstruction::Write(os);
+        return;
+    }
+
+    auto fusedOpCode = static_cast<uint8_t>
+        (compareOpCode - OpCode_NE +
+         (operandSize == 1 ? OpCode_NEJF1 : OpCode_NEJF2));
+    os.put(static_cast<char>(fusedOpCode));
+    auto displacement = Displacement(TargetOffset(), operandSize);
+    uint32_t uDisplacement = *reinterpret_cast<const uint32_t *>
+        (&displacement);
+    WriteField(os, uDisplacement, operandSize);
+}
+
+void CompareJumpInstruction::PrintCode(ostream &os) const
+{
+    static const char *const mnemonics[] =
+        {"NE", "EQ", "LT", "LE", "GT", "GE"};
+    os << mnemonics[compareOpCode - OpCode_NE];
+    auto operandSize = BranchOperandSize();
+    if (operandSize == 4)
+        os << "; JMPF";
+    else
+        os << "JF" << operandSize;
+}
+
 JumpInstruction::JumpInstruction
     (const Executable::Location &targetLocation,
      const string &comment) :
-    SimpleInstruction(OpCode_JMP, targetLocation, comment)
+    BranchInstruction(OpCode_JMP, targetLocation, comment)
 {
 }
 
@@ -652,6 +921,28 @@ CallInstruction::CallInstruction(const string &comment) :
 {
 }
 
+PositionalCallInstruction::PositionalCallInstruction
+    (uint8_t argumentCount, const string &comment) :
+    Instruction(OpCode_CALL1, comment),
+    argumentCount(argumentCount)
+{
+}
+
+unsigned PositionalCallInstruction::OperandsSize() const
+{
+    return 1;
+}
+
+void PositionalCallInstruction::WriteOperands(ostream &os) const
+{
+    WriteField(os, argumentCount, 1);
+}
+
+void PositionalCallInstruction::PrintCode(ostream &os) const
+{
+    os << "CALL " << static_cast<unsigned>(argumentCount);
+}
+
 ReturnInstruction::ReturnInstruction(const string &comment) :
     SimpleInstruction(OpCode_RET, comment)
 {
@@ -8,6 +8,7 @@
 #include "executable.hpp"
 #include <iostream>
 #include <string>
+#include <vector>
 #include <cstdint>
 
 class Instruction
@@ -33,6 +34,9 @@ class Instruction
         bool Fixed() const;
         void Fix(std::uint32_t targetOffset);
 
+        // Branch relaxation method.
+        virtual bool Relax(std::uint32_t targetOffset);
+
         // Code generation methods.
         virtual unsigned Size() const;
         virtual void Write(std::ostream &) const;
@@ -51,6 +55,7 @@ class Instruction
         static void WriteField
             (std::ostream &, std::uint64_t value, unsigned size);
         std::uint8_t OpCode() const;
+        std::uint32_t TargetOffset() const;
 
     private:
 
@@ -92,6 +97,34 @@ class SimpleInstruction : public Instruction
         void PrintCode(std::ostream &) const override;
 };
 
+class BranchInstruction : public Instruction
+{
+    protected:
+
+        BranchInstruction
+            (std::uint8_t opCode, const Executable::Location &,
+             const std::string &comment = "");
+
+    public:
+
+        bool Relax(std::uint32_t targetOffset) override;
+        unsigned Size() const override;
+        void Write(std::ostream &) const override;
+
+    protected:
+
+        void PrintCode(std::ostream &) const override;
+        unsigned BranchOperandSize() const;
+        std::int32_t Displacement
+            (std::uint32_t targetOffset, unsigned operandSize) const;
+
+    private:
+
+        // Operand size. Sizes 1 and 2 specify relative jumps, while 4
+        // specifies an absolute jump.
+        unsigned operandSize = 1;
+};
+
 class PushNoneInstruction : public SimpleInstruction
 {
     public:
@@ -296,7 +329,7 @@ class BinaryInstruction : public SimpleInstruction
             (std::uint8_t opCode, const std::string &comment = "");
 };
 
-class LogicalInstruction : public SimpleInstruction
+class LogicalInstruction : public BranchInstruction
 {
     public:
 
@@ -334,6 +367,93 @@ class SetInstruction : public SimpleInstruction
             (bool pop, const std::string &comment = "");
 };
 
+class AddSetInstruction : public SimpleInstruction
+{
+    public:
+
+        explicit AddSetInstruction
+            (const std::string &comment = "");
+};
+
+class SetVariableInstruction : public Instruction
+{
+    public:
+
+        explicit SetVariableInstruction
+            (std::int32_t symbol, const std::string &comment = "");
+
+    protected:
+
+        unsigned OperandsSize() const override;
+        void WriteOperands(std::ostream &) const override;
+        void PrintCode(std::ostream &) const override;
+
+    private:
+
+        std::int32_t symbol;
+};
+
+class UpdateVariableInstruction : public Instruction
+{
+    public:
+
+        UpdateVariableInstruction
+            (std::int32_t symbol, bool subtract,
+             const std::string &comment = "");
+
+    protected:
+
+        unsigned OperandsSize() const override;
+        void WriteOperands(std::ostream &) const override;
+        void PrintCode(std::ostream &) const override;
+
+    private:
+
+        std::int32_t symbol;
+        bool subtract;
+};
+
+class LocalSlotsInstruction : public Instruction
+{
+    public:
+
+        explicit LocalSlotsInstruction(const std::string &comment = "");
+
+        void Symbols(const std::vector<std::int32_t> &);
+
+        unsigned Size() const override;
+        void Write(std::ostream &) const override;
+
+    protected:
+
+        unsigned OperandsSize() const override;
+        void WriteOperands(std::ostream &) const override;
+        void PrintCode(std::ostream &) const override;
+
+    private:
+
+        std::vector<std::int32_t> symbols;
+};
+
+class LocalSlotInstruction : public Instruction
+{
+    public:
+
+        LocalSlotInstruction
+            (std::uint8_t opCode, std::uint8_t slot,
+             const std::string &comment = "");
+
+    protected:
+
+        unsigned OperandsSize() const override;
+        void WriteOperands(std::ostream &) const override;
+        void PrintCode(std::ostream &) const override;
+
+    private:
+
+        std::uint8_t slot;
+};
+
 class DeleteInstruction : public Instruction
 {
     public:
@@ -413,7 +533,7 @@ class DereferenceIteratorInstruction : public SimpleInstruction
             (const std::string &comment = "");
 };
 
-class ConditionalJumpInstruction : public SimpleInstruction
+class ConditionalJumpInstruction : public BranchInstruction
 {
     public:
 
@@ -423,7 +543,27 @@ class ConditionalJumpInstruction : public SimpleInstruction
 };
 
 
-class JumpInstruction : public SimpleInstruction
+class CompareJumpInstruction : public BranchInstruction
+{
+    public:
+
+        CompareJumpInstruction
+            (std::uint8_t compareOpCode, const Executable::Location &,
+             const std::string &comment = "");
+
+        unsigned Size() const override;
+        void Write(std::ostream &) const override;
+
+    protected:
+
+        void PrintCode(std::ostream &) const override;
+
+    private:
+
+        std::uint8_t compareOpCode;
+};
+
+class JumpInstruction : public BranchInstruction
 {
     public:
 
@@ -440,6 +580,24 @@ class CallInstruction : public SimpleInstruction
             (const std::string &comment = "");
 };
 
+class PositionalCallInstruction : public Instruction
+{
+    public:
+
+        explicit PositionalCallInstruction
+            (std::uint8_t argumentCount, const std::string &comment = "");
+
+    protected:
+
+        unsigned OperandsSize() const override;
+        void WriteOperands(std::ostream &) const override;
+        void PrintCode(std::ostream &) const override;
+
+    private:
+
+        std::uint8_t argumentCount;
+};
+
 class ReturnInstruction : public SimpleInstruction
 {
     public:
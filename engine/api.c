@@ -12,6 +12,7 @@
 #include "function.h"
 #include "symbols.h"
 #include "compare.h"
+#include "constant.h"
 #include <math.h>
 #include <stdio.h>
 #include <string.h>
@@ -1196,7 +1197,12 @@ AspDataEntry *AspNewBoolean(AspEngine *engine, bool value)
 
 AspDataEntry *AspNewInteger(AspEngine *engine, int32_t value)
 {
-    AspDataEntry *entry = NewObject(engine, DataType_Integer);
+    /* Return a preallocated integer if the value is in the cached range. */
+    AspDataEntry *entry = AspCachedInteger(engine, value);
+    if (entry != 0)
+        return entry;
+
+    entry = NewObject(engine, DataType_Integer);
     if (entry != 0)
         AspDataSetInteger(entry, value);
     return entry;
@@ -1627,7 +1633,7 @@ bool AspAddIterableGroupArgument
         return false;
 
     AspRunResult result = AspExpandIterableGroupArgument
-        (engine, engine->argumentList, value);
+        (engine, engine->argumentList, value, false);
     if (result != AspRunResult_OK)
         return false;
     if (take)
@@ -1710,6 +1716,8 @@ int32_t AspNextSymbol(AspEngine *engine)
 
 AspDataEntry *AspLoadLocal(AspEngine *engine, int32_t symbol)
 {
+    if (engine->appFunctionNamespace == 0)
+        return 0;
     AspTreeResult findResult = AspFindSymbol
         (engine, engine->appFunctionNamespace, symbol);
     return findResult.value;
@@ -1718,6 +1726,18 @@ AspDataEntry *AspLoadLocal(AspEngine *engine, int32_t symbol)
 bool AspStoreLocal
     (AspEngine *engine, int32_t symbol, AspDataEntry *value, bool take)
 {
+    /* Create the local namespace on first use. Functions dispatched
+       through the application function table receive their arguments in
+       slots, so they start without one. */
+    if (engine->appFunctionNamespace == 0)
+    {
+        AspDataEntry *ns = AspAllocEntry(engine, DataType_Namespace);
+        if (ns == 0)
+            return false;
+        AspDataSetNamespaceIsLocal(ns, true);
+        engine->appFunctionNamespace = ns;
+    }
+
     AspTreeResult insertResult = AspTreeTryInsertBySymbol
         (engine, engine->appFunctionNamespace, symbol, value);
     if (insertResult.result != AspRunResult_OK)
@@ -1738,6 +1758,8 @@ bool AspStoreLocal
 
 bool AspEraseLocal(AspEngine *engine, int32_t symbol)
 {
+    if (engine->appFunctionNamespace == 0)
+        return false;
     AspTreeResult findResult = AspFindSymbol
         (engine, engine->appFunctionNamespace, symbol);
     if (findResult.result != AspRunResult_OK)
@@ -1764,6 +1786,16 @@ bool AspAgain(const AspEngine *engine)
     return engine->again;
 }
 
+AspRunResult AspWait(AspEngine *engine, void *token)
+{
+    /* Note the token for the application to wake the engine with. The
+       calling function must return the result. */
+    if (!engine->inApp)
+        return AspRunResult_InvalidState;
+    engine->waitToken = token;
+    return AspRunResult_Wait;
+}
+
 AspRunResult AspAssert(AspEngine *engine, bool condition)
 {
     /* Bail if a previous error condition exists. */
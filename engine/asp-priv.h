@@ -20,6 +20,9 @@ extern "C" {
 typedef struct AspEngine AspEngine;
 typedef union AspDataEntry AspDataEntry;
 typedef struct AspCodePageEntry AspCodePageEntry;
+typedef struct AspDecodedInstruction AspDecodedInstruction;
+typedef struct AspTraversalPair AspTraversalPair;
+typedef struct AspAppFunctionEntry AspAppFunctionEntry;
 typedef struct AspAppSpec AspAppSpec;
 
 #ifdef __cplusplus
@@ -35,6 +38,8 @@ extern "C" {
 typedef AspRunResult (AspDispatchFunction)
     (AspEngine *, int32_t moduleSymbol, int32_t functionSymbol,
      AspDataEntry *ns, AspDataEntry **returnValue);
+typedef AspRunResult (AspAppFunction)
+    (AspEngine *, AspDataEntry **returnValue);
 
 struct AspCodePageEntry
 {
@@ -42,12 +47,46 @@ struct AspCodePageEntry
     int8_t age;
 };
 
+struct AspDecodedInstruction
+{
+    union
+    {
+        double f;
+        int32_t s[2];
+        uint32_t u[2];
+    } operand;
+    uint32_t address;
+    uint8_t opCode;
+};
+
+/* Number of pairs of entries the traversal worklist can hold. Comparing
+   nested objects takes up to three pairs per level of nesting. */
+#define AspTraversalPairCount 64U
+
+struct AspTraversalPair
+{
+    uint32_t leftIndex, rightIndex;
+};
+
+struct AspAppFunctionEntry
+{
+    int32_t symbol;
+    AspAppFunction *function;
+};
+
 struct AspAppSpec
 {
     const char *spec;
     unsigned specSize;
     uint32_t checkValue;
     AspDispatchFunction *dispatch;
+
+    /* Table of application functions indexed by the identifier assigned
+       to each in order of definition. When present, arguments are bound by
+       position into slots instead of into a namespace, and the dispatch
+       function is not used. */
+    const AspAppFunctionEntry *functions;
+    unsigned functionCount;
 };
 
 typedef enum AspEngineState
@@ -62,6 +101,18 @@ typedef enum AspEngineState
     AspEngineState_Ended,
 } AspEngineState;
 
+typedef enum AspCyclePhase
+{
+    AspCyclePhase_Idle,
+    AspCyclePhase_Mark,
+    AspCyclePhase_Count,
+    AspCyclePhase_Clear,
+} AspCyclePhase;
+
+/* Number of entries awaiting a cycle collection scan that can be held
+   before resorting to a search of the grey marks. */
+#define AspCycleStackCount 32U
+
 struct AspEngine
 {
     /* Application context. */
@@ -79,9 +130,11 @@ struct AspEngine
     /* Version information. */
     uint8_t version[4]; /* major, minor, patch, tweak */
 
-    /* Code space. */
+    /* Code space. The check value is computed over resident code when it
+       is sealed, and identifies the executable in snapshots. */
     uint8_t *codeArea, *code;
     size_t maxCodeSize, codeEndIndex;
+    uint32_t codeCheckValue;
     uint32_t pc, instructionAddress;
 
     /* Code paging data. */
@@ -93,11 +146,22 @@ struct AspEngine
     void *pagedCodeId;
     size_t codePageReadCount;
 
-    /* Data space. */
+    /* Pre-decoded code data. */
+    AspDecodedInstruction *decodedCode;
+    size_t decodedCodeCapacity;
+    const AspDecodedInstruction *decodedCodeEnd;
+    const AspDecodedInstruction *decodedInstruction, *nextDecodedInstruction;
+    unsigned decodedOperandIndex;
+
+    /* Data space. Entries at and above the high-water index have not been
+       used since the data area was last cleared. They are free without
+       being on the free list, which holds only recycled entries, and are
+       allocated in order once the free list is exhausted. */
     AspDataEntry *data;
     size_t maxDataSize, dataEndIndex;
     size_t freeCount, lowFreeCount;
-    uint32_t freeListIndex;
+    uint32_t freeListIndex, highWaterIndex;
+    size_t allocationCount;
 
     /* Loop iteration limit for detecting potential cycles in data
        structures. */
@@ -108,9 +172,73 @@ struct AspEngine
         *noneSingleton, *ellipsisSingleton,
         *falseSingleton, *trueSingleton;
 
-    /* Stack. */
+    /* Stack. When a stack depth is set, entries are taken from a fixed
+       region following the data entries instead of being allocated. */
     AspDataEntry *stackTop;
     unsigned stackCount;
+    AspDataEntry *stackBase;
+    size_t stackDepth;
+
+    /* Name lookup cache. When a size is set, entries are taken from a fixed
+       region following the stack region. Entries are valid only for the
+       namespace version in effect when they were made. */
+    AspDataEntry *nameCache;
+    size_t nameCacheSize;
+    uint32_t namespaceVersion;
+
+    /* Constant caches. When configured, preallocated integers in a given
+       range and interned string literals, keyed by the address of the
+       instruction that pushes them, are taken from fixed regions following
+       the name cache. The engine holds a reference to each cached object,
+       so none is ever freed or modified in place while cached. */
+    AspDataEntry *integerCache, *stringCache;
+    int32_t integerCacheMin;
+    size_t integerCacheSize, stringCacheSize;
+    size_t constantCacheHitCount;
+
+    /* Traversal worklist. Comparisons of nested objects and immutability
+       checks of nested tuples hold their pending pairs of entries here
+       instead of allocating stack entries. Nesting too deep to fit fails
+       with the NestingTooDeep run result. */
+    AspTraversalPair traversalPairs[AspTraversalPairCount];
+    unsigned traversalPairCount;
+
+    /* Deferred destruction. Objects released for the last time whose
+       contents must be released in turn are queued, linked through the
+       entries themselves, and destroyed a limited amount of work at a time.
+       A limit of zero destroys each released object in full at once. */
+    uint32_t garbageIndex;
+    uint32_t collectLimit;
+    bool collecting;
+
+    /* Resumable operations. Instructions whose work grows with the size of
+       their operands (sequence repetition, string formatting and group
+       argument expansion) do at most a limited number of units of work per
+       step when a limit is set. The partial result and the progress made are
+       held here between steps, and the instruction is executed again until
+       it completes. */
+    uint32_t workLimit;
+    AspDataEntry *resumeValue;
+    uint32_t resumeElementIndex, resumeItemIndex;
+    uint32_t resumeCount, resumeIterationCount;
+
+    /* Cycle collection. When enabled, reference cycles no longer reachable
+       from the stack, the modules or the engine itself are found by an
+       incremental mark pass and broken up so that reference counting can
+       reclaim them. A black and a grey mark bit for each data entry are
+       kept in a map reserved from the data area. A pass starts when the
+       number of free entries falls below the trigger count, and does a
+       limited amount of work before each instruction until it completes. */
+    uint32_t *cycleMarks;
+    size_t cycleMarkWordCount;
+    size_t cycleTriggerFreeCount, cycleTriggerCount;
+    uint32_t cycleLimit;
+    AspCyclePhase cyclePhase;
+    uint32_t cycleIndex;
+    AspDataEntry *cycleScanEntry, *cycleScanMember;
+    uint32_t cycleStack[AspCycleStackCount];
+    unsigned cycleStackCount;
+    size_t cycleCount, cycleReclaimCount;
 
     /* Modules namespace. */
     AspDataEntry *modules;
@@ -124,13 +252,19 @@ struct AspEngine
     /* Current namespaces. */
     AspDataEntry *systemNamespace, *globalNamespace, *localNamespace;
 
+    /* Current function's local variable slots, if any. */
+    AspDataEntry *localSlots;
+
     /* Application specification (functions). */
     const AspAppSpec *appSpec;
 
     /* Application function call state. */
     bool inApp, again, callFromApp, callReturning;
+    bool waiting;
+    void *waitToken;
     AspDataEntry *argumentList;
     AspDataEntry *appFunction, *appFunctionNamespace, *appFunctionReturnValue;
+    AspDataEntry *appFunctionSlots;
     int32_t nextSymbol;
 
     #ifdef ASP_DEBUG
@@ -150,6 +284,8 @@ ASP_API AspDataEntry *AspParameterValue
     (AspEngine *, const AspDataEntry *ns, int32_t symbol);
 ASP_API AspParameterResult AspGroupParameterValue
     (AspEngine *, const AspDataEntry *ns, int32_t symbol, bool dictionary);
+ASP_API AspRunResult AspAppArguments
+    (AspEngine *, unsigned count, AspDataEntry **arguments);
 
 #ifdef __cplusplus
 }
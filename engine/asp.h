@@ -44,6 +44,7 @@ typedef enum
     AspRunResult_BeyondEndOfCode = 0x06,
     AspRunResult_StackUnderflow = 0x07,
     AspRunResult_CycleDetected = 0x08,
+    AspRunResult_StackOverflow = 0x09,
     AspRunResult_InvalidContext = 0x0A,
     AspRunResult_Redundant = 0x0B,
     AspRunResult_UnexpectedType = 0x0C,
@@ -59,7 +60,9 @@ typedef enum
     AspRunResult_InvalidAppFunction = 0x16,
     AspRunResult_DivideByZero = 0x18,
     AspRunResult_ArithmeticOverflow = 0x19,
+    AspRunResult_NestingTooDeep = 0x1A,
     AspRunResult_OutOfDataMemory = 0x20,
+    AspRunResult_Wait = 0xF9,
     AspRunResult_Again = 0xFA,
     AspRunResult_Abort = 0xFB,
     AspRunResult_Call = 0xFC,
@@ -98,6 +101,16 @@ ASP_API AspRunResult AspInitializeEx
      const AspAppSpec *, void *context, AspFloatConverter);
 ASP_API AspRunResult AspSetCodePaging
     (AspEngine *, uint8_t pageCount, size_t pageSize, AspCodeReader);
+ASP_API size_t AspDecodedInstructionSize(void);
+ASP_API AspRunResult AspSetCodeDecoding
+    (AspEngine *, void *buffer, size_t bufferSize);
+ASP_API AspRunResult AspSetStackDepth(AspEngine *, size_t depth);
+ASP_API AspRunResult AspSetNameCacheSize(AspEngine *, size_t size);
+ASP_API AspRunResult AspSetIntegerCacheRange
+    (AspEngine *, int32_t min, int32_t max);
+ASP_API AspRunResult AspSetStringCacheSize(AspEngine *, size_t size);
+ASP_API AspRunResult AspSetCycleCollection
+    (AspEngine *, size_t triggerFreeCount);
 ASP_API void AspCodeVersion(const AspEngine *, uint8_t version[4]);
 ASP_API size_t AspMaxCodeSize(const AspEngine *);
 ASP_API size_t AspMaxDataSize(const AspEngine *);
@@ -112,16 +125,43 @@ ASP_API AspRunResult AspSetArguments(AspEngine *, const char * const *);
 ASP_API AspRunResult AspSetArgumentsString(AspEngine *, const char *);
 ASP_API AspRunResult AspSetCycleDetectionLimit(AspEngine *, uint32_t);
 ASP_API uint32_t AspGetCycleDetectionLimit(const AspEngine *);
+ASP_API AspRunResult AspSetCollectLimit(AspEngine *, uint32_t);
+ASP_API uint32_t AspGetCollectLimit(const AspEngine *);
+ASP_API AspRunResult AspSetWorkLimit(AspEngine *, uint32_t);
+ASP_API uint32_t AspGetWorkLimit(const AspEngine *);
+ASP_API AspRunResult AspSetCycleCollectionLimit(AspEngine *, uint32_t);
+ASP_API uint32_t AspGetCycleCollectionLimit(const AspEngine *);
 
 /* Execution control. */
 ASP_API AspRunResult AspRestart(AspEngine *);
+ASP_API size_t AspSnapshotSize(const AspEngine *);
+ASP_API AspRunResult AspSnapshot
+    (const AspEngine *, void *buffer, size_t bufferSize);
+ASP_API AspRunResult AspRestore
+    (AspEngine *, const void *buffer, size_t bufferSize);
+ASP_API AspRunResult AspClone
+    (AspEngine *, const AspEngine *source,
+     void *data, size_t dataSize, void *context);
 ASP_API AspRunResult AspStep(AspEngine *);
+ASP_API AspRunResult AspWake
+    (AspEngine *, void *token, AspRunResult result);
+ASP_API AspRunResult AspRun(AspEngine *, uint32_t stepCountLimit);
+ASP_API AspRunResult AspRunFor
+    (AspEngine *, uint32_t stepCountLimit, uint32_t *stepCount);
+ASP_API bool AspCollect(AspEngine *, uint32_t limit);
+ASP_API bool AspCollectCycles(AspEngine *, uint32_t limit);
 ASP_API bool AspIsReady(const AspEngine *);
 ASP_API bool AspIsRunning(const AspEngine *);
+ASP_API bool AspIsWaiting(const AspEngine *);
 ASP_API bool AspIsRunnable(const AspEngine *);
 ASP_API size_t AspProgramCounter(const AspEngine *);
 ASP_API size_t AspLowFreeCount(const AspEngine *);
 ASP_API size_t AspCodePageReadCount(AspEngine *, bool reset);
+ASP_API size_t AspDecodedInstructionCount(const AspEngine *);
+ASP_API size_t AspAllocationCount(AspEngine *, bool reset);
+ASP_API size_t AspConstantCacheHitCount(AspEngine *, bool reset);
+ASP_API size_t AspCycleCollectionCount(AspEngine *, bool reset);
+ASP_API size_t AspCycleReclaimCount(AspEngine *, bool reset);
 #ifdef ASP_DEBUG
 ASP_API uint32_t AspDataAddress(const AspEngine *, const AspDataEntry *);
 ASP_API uint32_t AspUseCount(const AspDataEntry *);
@@ -259,6 +299,7 @@ ASP_API void AspUnref(AspEngine *, AspDataEntry *);
 ASP_API AspDataEntry *AspArguments(AspEngine *);
 ASP_API void *AspContext(const AspEngine *);
 ASP_API bool AspAgain(const AspEngine *);
+ASP_API AspRunResult AspWait(AspEngine *, void *token);
 ASP_API AspRunResult AspAssert(AspEngine *, bool);
 
 #ifdef __cplusplus
@@ -5,6 +5,7 @@
 #include "assign.h"
 #include "stack.h"
 #include "sequence.h"
+#include "slot.h"
 
 static AspRunResult CheckSequenceMatch
     (AspEngine *, const AspDataEntry *address, const AspDataEntry *newValue);
@@ -18,10 +19,18 @@ AspRunResult AspAssignSimple
         (engine,
          addressType == DataType_Element ||
          addressType == DataType_DictionaryNode ||
-         addressType == DataType_NamespaceNode);
+         addressType == DataType_NamespaceNode ||
+         addressType == DataType_SlotAddress);
     if (assertResult != AspRunResult_OK)
         return assertResult;
 
+    /* Local slots manage references on their own. */
+    if (addressType == DataType_SlotAddress)
+        return AspAssignLocalSlot
+            (engine,
+             AspEntry(engine, AspDataGetSlotAddressSlotsIndex(address)),
+             (uint8_t)AspDataGetSlotAddressSlot(address), newValue);
+
     AspRef(engine, newValue);
     uint32_t newValueIndex = AspIndex(engine, newValue);
     switch (addressType)
@@ -3,9 +3,28 @@
  */
 
 #include "code.h"
+#include "opcode.h"
 #include <stdint.h>
+#include <stdbool.h>
+
+typedef enum
+{
+    OperandKind_None,
+    OperandKind_Unsigned,
+    OperandKind_Signed,
+    OperandKind_Float,
+    OperandKind_String,
+    OperandKind_Address,
+    OperandKind_SignedAddress,
+    OperandKind_SymbolTable,
+} OperandKind;
 
 static void UpdateAges(AspEngine *);
+static bool GetOperandLayout
+    (uint8_t opCode, OperandKind *, unsigned *operandSize);
+static bool IsJump(uint8_t opCode, bool *relative);
+static uint32_t DecodeUnsigned(const uint8_t *, unsigned size);
+static int32_t DecodeSigned(const uint8_t *, unsigned size);
 
 AspRunResult AspLoadCodeBytes
     (AspEngine *engine, uint8_t *bytes, size_t count)
@@ -39,6 +58,17 @@ AspRunResult AspLoadCodeBytes
     return AspRunResult_OK;
 }
 
+AspRunResult AspLoadCodeBytesAt
+    (AspEngine *engine, uint32_t address, uint8_t *bytes, size_t count)
+{
+    /* Read from the given address, leaving the program counter intact. */
+    uint32_t pc = engine->pc;
+    engine->pc = address;
+    AspRunResult result = AspLoadCodeBytes(engine, bytes, count);
+    engine->pc = pc;
+    return result;
+}
+
 AspRunResult AspValidateCodeAddress(AspEngine *engine, uint32_t address)
 {
     if (engine->cachedCodePageCount == 0)
@@ -148,6 +178,163 @@ AspRunResult AspLoadCodePage(AspEngine *engine, uint32_t offset)
     return AspRunResult_OK;
 }
 
+void AspDecodeCode(AspEngine *engine)
+{
+    engine->decodedCodeEnd = 0;
+    engine->decodedInstruction = 0;
+    engine->nextDecodedInstruction = engine->decodedCode;
+    if (engine->decodedCode == 0 || engine->decodedCodeCapacity == 0 ||
+        engine->cachedCodePageCount != 0)
+        return;
+
+    /* Decode instructions from the start of the code until the end of the
+       code is reached, the buffer fills up (leaving room for the end marker),
+       or something is encountered that the instruction handlers must report
+       on (e.g., an invalid op code or a truncated operand). Instructions
+       beyond this point are executed directly from the code. */
+    AspDecodedInstruction *instruction = engine->decodedCode;
+    AspDecodedInstruction *end =
+        engine->decodedCode + engine->decodedCodeCapacity - 1;
+    uint32_t address = 0;
+    for (; instruction < end && address < engine->codeEndIndex; instruction++)
+    {
+        const uint8_t *code = engine->code + address;
+        OperandKind kind;
+        unsigned operandSize;
+        if (!GetOperandLayout(*code, &kind, &operandSize))
+            break;
+
+        size_t size = 1 + operandSize;
+        if (kind == OperandKind_SignedAddress)
+            size += 4;
+        if (address + size > engine->codeEndIndex)
+            break;
+        if (kind == OperandKind_String)
+        {
+            uint32_t stringSize = DecodeUnsigned(code + 1, operandSize);
+            if (stringSize > engine->codeEndIndex - address - size)
+                break;
+            size += stringSize;
+        }
+        if (kind == OperandKind_SymbolTable)
+        {
+            uint32_t tableSize = 4 * DecodeUnsigned(code + 1, operandSize);
+            if (tableSize > engine->codeEndIndex - address - size)
+                break;
+            size += tableSize;
+        }
+
+        instruction->opCode = *code;
+        instruction->address = address;
+        instruction->operand.u[0] = instruction->operand.u[1] = 0;
+        switch (kind)
+        {
+            case OperandKind_None:
+                break;
+
+            case OperandKind_Unsigned:
+            case OperandKind_String:
+            case OperandKind_Address:
+            case OperandKind_SymbolTable:
+                instruction->operand.u[0] =
+                    DecodeUnsigned(code + 1, operandSize);
+                break;
+
+            case OperandKind_Signed:
+                instruction->operand.s[0] =
+                    DecodeSigned(code + 1, operandSize);
+                break;
+
+            case OperandKind_SignedAddress:
+                instruction->operand.s[0] =
+                    DecodeSigned(code + 1, operandSize);
+                instruction->operand.u[1] =
+                    DecodeUnsigned(code + 1 + operandSize, 4);
+                break;
+
+            case OperandKind_Float:
+            {
+                uint8_t data[8];
+                for (unsigned i = 0; i < sizeof data; i++)
+                    data[i] = code[1 + i];
+                instruction->operand.f = AspTranslateFloat(engine, data);
+                break;
+            }
+        }
+
+        address += (uint32_t)size;
+    }
+
+    /* Add the end marker, which records the address of the first
+       instruction not decoded. */
+    instruction->opCode = OpCode_END;
+    instruction->address = address;
+    instruction->operand.u[0] = instruction->operand.u[1] = 0;
+    engine->decodedCodeEnd = instruction;
+
+    /* Resolve jump targets to decoded instructions so that taken jumps can
+       continue without a search. Targets outside the decoded code resolve
+       to the end marker, which causes a fall back to a search. */
+    for (instruction = engine->decodedCode;
+         instruction < engine->decodedCodeEnd; instruction++)
+    {
+        bool relative;
+        if (!IsJump(instruction->opCode, &relative))
+            continue;
+
+        uint32_t targetAddress = relative ?
+            (instruction + 1)->address + (uint32_t)instruction->operand.s[0] :
+            instruction->operand.u[0];
+        const AspDecodedInstruction *target = AspFindDecodedInstruction
+            (engine, targetAddress);
+        if (target == 0)
+            target = engine->decodedCodeEnd;
+        instruction->operand.u[1] =
+            (uint32_t)(target - engine->decodedCode);
+    }
+}
+
+const AspDecodedInstruction *AspFindDecodedInstruction
+    (const AspEngine *engine, uint32_t address)
+{
+    if (engine->decodedCodeEnd == 0)
+        return 0;
+
+    const AspDecodedInstruction *low = engine->decodedCode;
+    const AspDecodedInstruction *high = engine->decodedCodeEnd;
+    while (low < high)
+    {
+        const AspDecodedInstruction *middle = low + (high - low) / 2;
+        if (middle->address < address)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+
+    return low < engine->decodedCodeEnd && low->address == address ?
+        low : 0;
+}
+
+double AspTranslateFloat(const AspEngine *engine, uint8_t data[8])
+{
+    static const uint16_t word = 1;
+    bool be = *(const char *)&word == 0;
+
+    if (!be)
+    {
+        for (unsigned i = 0; i < 4; i++)
+        {
+            data[i] ^= data[7 - i];
+            data[7 - i] ^= data[i];
+            data[i] ^= data[7 - i];
+        }
+    }
+
+    /* Convert IEEE 754 binary64 to the native format. */
+    return engine->floatConverter != 0 ?
+        engine->floatConverter(data) : *(double *)data;
+}
+
 static void UpdateAges(AspEngine *engine)
 {
     for (unsigned i = 0; i < engine->cachedCodePageCount; i++)
@@ -160,3 +347,271 @@ static void UpdateAges(AspEngine *engine)
             entry->age++;
     }
 }
+
+static bool GetOperandLayout
+    (uint8_t opCode, OperandKind *kind, unsigned *operandSize)
+{
+    *kind = OperandKind_None;
+    *operandSize = 0;
+    switch (opCode)
+    {
+        default:
+            return false;
+
+        case OpCode_PUSHN:
+        case OpCode_PUSHE:
+        case OpCode_PUSHF:
+        case OpCode_PUSHT:
+        case OpCode_PUSHI0:
+        case OpCode_PUSHS0:
+        case OpCode_PUSHTU:
+        case OpCode_PUSHLI:
+        case OpCode_PUSHSE:
+        case OpCode_PUSHDI:
+        case OpCode_PUSHAL:
+        case OpCode_PUSHPL:
+        case OpCode_POP:
+        case OpCode_LNOT:
+        case OpCode_POS:
+        case OpCode_NEG:
+        case OpCode_NOT:
+        case OpCode_OR:
+        case OpCode_XOR:
+        case OpCode_AND:
+        case OpCode_LSH:
+        case OpCode_RSH:
+        case OpCode_ADD:
+        case OpCode_SUB:
+        case OpCode_MUL:
+        case OpCode_DIV:
+        case OpCode_FDIV:
+        case OpCode_MOD:
+        case OpCode_POW:
+        case OpCode_NE:
+        case OpCode_EQ:
+        case OpCode_LT:
+        case OpCode_LE:
+        case OpCode_GT:
+        case OpCode_GE:
+        case OpCode_NIN:
+        case OpCode_IN:
+        case OpCode_NIS:
+        case OpCode_IS:
+        case OpCode_ORDER:
+        case OpCode_LD:
+        case OpCode_LDA:
+        case OpCode_SET:
+        case OpCode_SETP:
+        case OpCode_ADDSP:
+        case OpCode_ERASE:
+        case OpCode_SITER:
+        case OpCode_TITER:
+        case OpCode_NITER:
+        case OpCode_DITER:
+        case OpCode_NOOP:
+        case OpCode_CALL:
+        case OpCode_RET:
+        case OpCode_XMOD:
+        case OpCode_MKARG:
+        case OpCode_MKIGARG:
+        case OpCode_MKDGARG:
+        case OpCode_MKFUN:
+        case OpCode_MKKVP:
+        case OpCode_MKR0:
+        case OpCode_MKRS:
+        case OpCode_MKRE:
+        case OpCode_MKRSE:
+        case OpCode_MKRT:
+        case OpCode_MKRST:
+        case OpCode_MKRET:
+        case OpCode_MKR:
+        case OpCode_INS:
+        case OpCode_INSP:
+        case OpCode_BLD:
+        case OpCode_IDX:
+        case OpCode_IDXA:
+        case OpCode_MEM:
+        case OpCode_MEMA:
+        case OpCode_ABORT:
+        case OpCode_END:
+            return true;
+
+        case OpCode_PUSHD:
+            *kind = OperandKind_Float;
+            *operandSize = 8;
+            return true;
+
+        case OpCode_PUSHS4:
+            (*operandSize) += 2;
+        case OpCode_PUSHS2:
+            (*operandSize)++;
+        case OpCode_PUSHS1:
+            (*operandSize)++;
+            *kind = OperandKind_String;
+            return true;
+
+        case OpCode_PUSHCA:
+            *kind = OperandKind_Unsigned;
+            *operandSize = 4;
+            return true;
+
+        case OpCode_POP1:
+        case OpCode_LDL:
+        case OpCode_LDAL:
+        case OpCode_SETL:
+        case OpCode_ADDL:
+        case OpCode_SUBL:
+        case OpCode_DELL:
+        case OpCode_CALL1:
+            *kind = OperandKind_Unsigned;
+            *operandSize = 1;
+            return true;
+
+        case OpCode_SLOTS:
+            *kind = OperandKind_SymbolTable;
+            *operandSize = 1;
+            return true;
+
+        case OpCode_JMPF:
+        case OpCode_JMPT:
+        case OpCode_JMP:
+        case OpCode_LOR:
+        case OpCode_LAND:
+            *kind = OperandKind_Address;
+            *operandSize = 4;
+            return true;
+
+        case OpCode_JMPF2:
+        case OpCode_JMPT2:
+        case OpCode_JMP2:
+        case OpCode_LOR2:
+        case OpCode_LAND2:
+        case OpCode_NEJF2:
+        case OpCode_EQJF2:
+        case OpCode_LTJF2:
+        case OpCode_LEJF2:
+        case OpCode_GTJF2:
+        case OpCode_GEJF2:
+            (*operandSize)++;
+        case OpCode_JMPF1:
+        case OpCode_JMPT1:
+        case OpCode_JMP1:
+        case OpCode_LOR1:
+        case OpCode_LAND1:
+        case OpCode_NEJF1:
+        case OpCode_EQJF1:
+        case OpCode_LTJF1:
+        case OpCode_LEJF1:
+        case OpCode_GTJF1:
+        case OpCode_GEJF1:
+            (*operandSize)++;
+            *kind = OperandKind_Signed;
+            return true;
+
+        case OpCode_ADDMOD4:
+            (*operandSize) += 2;
+        case OpCode_ADDMOD2:
+            (*operandSize)++;
+        case OpCode_ADDMOD1:
+            (*operandSize)++;
+            *kind = OperandKind_SignedAddress;
+            return true;
+
+        case OpCode_PUSHI4:
+        case OpCode_PUSHY4:
+        case OpCode_PUSHM4:
+        case OpCode_LD4:
+        case OpCode_LDA4:
+        case OpCode_DEL4:
+        case OpCode_GLOB4:
+        case OpCode_LOC4:
+        case OpCode_LDMOD4:
+        case OpCode_MKNARG4:
+        case OpCode_MKPAR4:
+        case OpCode_MKDPAR4:
+        case OpCode_MKTGPAR4:
+        case OpCode_MKDGPAR4:
+        case OpCode_MEM4:
+        case OpCode_MEMA4:
+        case OpCode_SETP4:
+        case OpCode_ADDP4:
+        case OpCode_SUBP4:
+            (*operandSize) += 2;
+        case OpCode_PUSHI2:
+        case OpCode_PUSHY2:
+        case OpCode_PUSHM2:
+        case OpCode_LD2:
+        case OpCode_LDA2:
+        case OpCode_DEL2:
+        case OpCode_GLOB2:
+        case OpCode_LOC2:
+        case OpCode_LDMOD2:
+        case OpCode_MKNARG2:
+        case OpCode_MKPAR2:
+        case OpCode_MKDPAR2:
+        case OpCode_MKTGPAR2:
+        case OpCode_MKDGPAR2:
+        case OpCode_MEM2:
+        case OpCode_MEMA2:
+        case OpCode_SETP2:
+        case OpCode_ADDP2:
+        case OpCode_SUBP2:
+            (*operandSize)++;
+        case OpCode_PUSHI1:
+        case OpCode_PUSHY1:
+        case OpCode_PUSHM1:
+        case OpCode_LD1:
+        case OpCode_LDA1:
+        case OpCode_DEL1:
+        case OpCode_GLOB1:
+        case OpCode_LOC1:
+        case OpCode_LDMOD1:
+        case OpCode_MKNARG1:
+        case OpCode_MKPAR1:
+        case OpCode_MKDPAR1:
+        case OpCode_MKTGPAR1:
+        case OpCode_MKDGPAR1:
+        case OpCode_MEM1:
+        case OpCode_MEMA1:
+        case OpCode_SETP1:
+        case OpCode_ADDP1:
+        case OpCode_SUBP1:
+            (*operandSize)++;
+            *kind = OperandKind_Signed;
+            return true;
+    }
+}
+
+static bool IsJump(uint8_t opCode, bool *relative)
+{
+    *relative =
+        (opCode >= OpCode_JMPF1 && opCode <= OpCode_LAND1) ||
+        (opCode >= OpCode_JMPF2 && opCode <= OpCode_LAND2) ||
+        (opCode >= OpCode_NEJF1 && opCode <= OpCode_GEJF2);
+    return *relative || (opCode >= OpCode_JMPF && opCode <= OpCode_LAND);
+}
+
+static uint32_t DecodeUnsigned(const uint8_t *bytes, unsigned size)
+{
+    uint32_t value = 0;
+    for (unsigned i = 0; i < size; i++)
+    {
+        value <<= 8;
+        value |= bytes[i];
+    }
+    return value;
+}
+
+static int32_t DecodeSigned(const uint8_t *bytes, unsigned size)
+{
+    uint32_t value = DecodeUnsigned(bytes, size);
+
+    /* Sign extend if applicable. */
+    if (size != 0 && (bytes[0] & 0x80) != 0)
+    {
+        for (unsigned i = size; i < 4; i++)
+            value |= 0xFFU << (i << 3);
+    }
+
+    return *(int32_t *)&value;
+}
@@ -14,8 +14,14 @@ extern "C" {
 #endif
 
 AspRunResult AspLoadCodeBytes(AspEngine *, uint8_t *bytes, size_t count);
+AspRunResult AspLoadCodeBytesAt
+    (AspEngine *, uint32_t address, uint8_t *bytes, size_t count);
 AspRunResult AspValidateCodeAddress(AspEngine *, uint32_t address);
 AspRunResult AspLoadCodePage(AspEngine *, uint32_t offset);
+void AspDecodeCode(AspEngine *);
+const AspDecodedInstruction *AspFindDecodedInstruction
+    (const AspEngine *, uint32_t address);
+double AspTranslateFloat(const AspEngine *, uint8_t data[8]);
 
 #ifdef __cplusplus
 }
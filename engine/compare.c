@@ -10,6 +10,10 @@
 #include <math.h>
 #include <string.h>
 
+static AspRunResult Compare
+    (AspEngine *,
+     const AspDataEntry *leftEntry, const AspDataEntry *rightEntry,
+     AspCompareType, int *result, bool *nanDetected);
 static int CompareFloats(double, double, AspCompareType, bool *nanDetected);
 static int CompareIterators
     (AspEngine *, const AspDataEntry *, const AspDataEntry *);
@@ -18,6 +22,94 @@ AspRunResult AspCompare
     (AspEngine *engine,
      const AspDataEntry *leftEntry, const AspDataEntry *rightEntry,
      AspCompareType compareType, int *result, bool *nanDetected)
+{
+    /* Discard any pairs left in the traversal worklist, which may happen
+       when the comparison ends in error. */
+    unsigned startPairCount = engine->traversalPairCount;
+    AspRunResult compareResult = Compare
+        (engine, leftEntry, rightEntry, compareType, result, nanDetected);
+    engine->traversalPairCount = startPairCount;
+    return compareResult;
+}
+
+AspRunResult AspCompareStrings
+    (AspEngine *engine,
+     const AspDataEntry *leftEntry, const AspDataEntry *rightEntry,
+     int *comparison)
+{
+    /* Walk both fragment chains together, comparing the overlapping part
+       of each pair of fragments at once. Fragment boundaries need not
+       line up, so track the offset into the current fragment of each. */
+    *comparison = 0;
+    AspSequenceResult
+        leftResult = AspSequenceNext(engine, leftEntry, 0, true),
+        rightResult = AspSequenceNext(engine, rightEntry, 0, true);
+    uint32_t leftOffset = 0, rightOffset = 0;
+    uint32_t iterationCount = 0;
+    for (;
+         iterationCount < engine->cycleDetectionLimit &&
+         leftResult.element != 0 && rightResult.element != 0;
+         iterationCount++)
+    {
+        const AspDataEntry
+            *leftFragment = leftResult.value,
+            *rightFragment = rightResult.value;
+        uint32_t
+            leftSize = AspDataGetStringFragmentSize(leftFragment),
+            rightSize = AspDataGetStringFragmentSize(rightFragment);
+        uint32_t
+            leftRemaining = leftSize - leftOffset,
+            rightRemaining = rightSize - rightOffset;
+        uint32_t size =
+            leftRemaining < rightRemaining ? leftRemaining : rightRemaining;
+        const char
+            *leftData = AspDataGetStringFragmentData(leftFragment)
+                + leftOffset,
+            *rightData = AspDataGetStringFragmentData(rightFragment)
+                + rightOffset;
+        if (memcmp(leftData, rightData, size) != 0)
+        {
+            /* Locate the first difference and compare the characters as
+               plain chars, as done elsewhere for string elements. */
+            uint32_t i = 0;
+            while (leftData[i] == rightData[i])
+                i++;
+            *comparison = leftData[i] < rightData[i] ? -1 : 1;
+            return AspRunResult_OK;
+        }
+
+        leftOffset += size;
+        rightOffset += size;
+        if (leftOffset >= leftSize)
+        {
+            leftResult = AspSequenceNext
+                (engine, leftEntry, leftResult.element, true);
+            leftOffset = 0;
+        }
+        if (rightOffset >= rightSize)
+        {
+            rightResult = AspSequenceNext
+                (engine, rightEntry, rightResult.element, true);
+            rightOffset = 0;
+        }
+    }
+    if (iterationCount >= engine->cycleDetectionLimit)
+        return AspRunResult_CycleDetected;
+
+    /* With no differing characters, the shorter string is the lesser. */
+    int32_t
+        leftCount = AspDataGetSequenceCount(leftEntry),
+        rightCount = AspDataGetSequenceCount(rightEntry);
+    if (leftCount != rightCount)
+        *comparison = leftCount < rightCount ? -1 : 1;
+
+    return AspRunResult_OK;
+}
+
+static AspRunResult Compare
+    (AspEngine *engine,
+     const AspDataEntry *leftEntry, const AspDataEntry *rightEntry,
+     AspCompareType compareType, int *result, bool *nanDetected)
 {
     AspAssert
         (engine, leftEntry != 0 && AspIsObject(leftEntry));
@@ -27,10 +119,13 @@ AspRunResult AspCompare
         return assertResult;
     bool localNanDetected = false;
 
-    /* Avoid recursion by using the engine's stack. */
-    const AspDataEntry *startStackTop = engine->stackTop;
+    /* Avoid recursion by keeping pending pairs of entries in the engine's
+       traversal worklist. The pair to be compared next is held aside rather
+       than saved. */
+    unsigned startPairCount = engine->traversalPairCount;
     int comparison = 0;
     const AspDataEntry *leftNext = 0, *rightNext = 0;
+    const AspDataEntry *leftPending = 0, *rightPending = 0;
     uint32_t iterationCount = 0;
     for (; iterationCount < engine->cycleDetectionLimit; iterationCount++)
     {
@@ -211,27 +306,10 @@ AspRunResult AspCompare
 
                     case DataType_String:
                     {
-                        int32_t
-                            leftCount = AspDataGetSequenceCount(leftEntry),
-                            rightCount = AspDataGetSequenceCount(rightEntry);
-                        int32_t shortCount =
-                            leftCount < rightCount ? leftCount : rightCount;
-                        for (int32_t i = 0; i < shortCount; i++)
-                        {
-                            char
-                                leftChar = AspStringElement
-                                    (engine, leftEntry, i),
-                                rightChar = AspStringElement
-                                    (engine, rightEntry, i);
-                            if (leftChar != rightChar)
-                            {
-                                comparison = leftChar < rightChar ? -1 : 1;
-                                break;
-                            }
-                        }
-                        if (comparison == 0 && leftCount != rightCount)
-                            comparison = leftCount < rightCount ? -1 : 1;
-
+                        AspRunResult compareResult = AspCompareStrings
+                            (engine, leftEntry, rightEntry, &comparison);
+                        if (compareResult != AspRunResult_OK)
+                            return compareResult;
                         break;
                     }
 
@@ -272,30 +350,11 @@ AspRunResult AspCompare
 
                         /* Save state and defer element comparison to the
                            next iteration. */
-                        AspDataEntry *entriesStackEntry = AspPushNoUse
-                            (engine, leftEntry);
-                        AspDataEntry *nextsStackEntry = AspPushNoUse
-                            (engine, leftNext);
-                        AspDataEntry *valuesStackEntry = AspPushNoUse
-                            (engine, leftResult.value);
-                        if (entriesStackEntry == 0 ||
-                            nextsStackEntry == 0 ||
-                            valuesStackEntry == 0)
-                            return AspRunResult_OutOfDataMemory;
-                        AspDataSetStackEntryHasValue2
-                            (entriesStackEntry, true);
-                        AspDataSetStackEntryValue2Index
-                            (entriesStackEntry,
-                             AspIndex(engine, rightEntry));
-                        AspDataSetStackEntryHasValue2
-                            (nextsStackEntry, true);
-                        AspDataSetStackEntryValue2Index
-                            (nextsStackEntry, AspIndex(engine, rightNext));
-                        AspDataSetStackEntryHasValue2
-                            (valuesStackEntry, true);
-                        AspDataSetStackEntryValue2Index
-                            (valuesStackEntry,
-                             AspIndex(engine, rightResult.value));
+                        if (!AspPushPair(engine, leftEntry, rightEntry) ||
+                            !AspPushPair(engine, leftNext, rightNext))
+                            return AspRunResult_NestingTooDeep;
+                        leftPending = leftResult.value;
+                        rightPending = rightResult.value;
 
                         break;
                     }
@@ -334,41 +393,22 @@ AspRunResult AspCompare
 
                         /* Save state and defer member comparison to the
                            next iteration. */
-                        AspDataEntry *entriesStackEntry = AspPushNoUse
-                            (engine, leftEntry);
-                        AspDataEntry *nextsStackEntry = AspPushNoUse
-                            (engine, leftNext);
-                        AspDataEntry *leftKeyStackEntry = AspPushNoUse
-                            (engine, leftResult.key);
-                        if (entriesStackEntry == 0 ||
-                            nextsStackEntry == 0 ||
-                            leftKeyStackEntry == 0)
-                            return AspRunResult_OutOfDataMemory;
-                        AspDataSetStackEntryHasValue2
-                            (entriesStackEntry, true);
-                        AspDataSetStackEntryValue2Index
-                            (entriesStackEntry,
-                             AspIndex(engine, rightEntry));
-                        AspDataSetStackEntryHasValue2
-                            (nextsStackEntry, true);
-                        AspDataSetStackEntryValue2Index
-                            (nextsStackEntry, AspIndex(engine, rightNext));
-                        AspDataSetStackEntryHasValue2
-                            (leftKeyStackEntry, true);
-                        AspDataSetStackEntryValue2Index
-                            (leftKeyStackEntry,
-                             AspIndex(engine, rightResult.key));
+                        if (!AspPushPair(engine, leftEntry, rightEntry) ||
+                            !AspPushPair(engine, leftNext, rightNext))
+                            return AspRunResult_NestingTooDeep;
                         if (type == DataType_Dictionary)
                         {
-                            AspDataEntry *valuesStackEntry = AspPushNoUse
-                                (engine, leftResult.value);
-                            if (valuesStackEntry == 0)
-                                return AspRunResult_OutOfDataMemory;
-                            AspDataSetStackEntryHasValue2
-                                (valuesStackEntry, true);
-                            AspDataSetStackEntryValue2Index
-                                (valuesStackEntry,
-                                 AspIndex(engine, rightResult.value));
+                            if (!AspPushPair
+                                    (engine,
+                                     leftResult.key, rightResult.key))
+                                return AspRunResult_NestingTooDeep;
+                            leftPending = leftResult.value;
+                            rightPending = rightResult.value;
+                        }
+                        else
+                        {
+                            leftPending = leftResult.key;
+                            rightPending = rightResult.key;
                         }
 
                         break;
@@ -493,17 +533,25 @@ AspRunResult AspCompare
 
         /* Check if there's more to do. */
         if (comparison != 0 || localNanDetected ||
-            engine->stackTop == startStackTop ||
             engine->runResult != AspRunResult_OK)
             break;
+        if (leftPending != 0)
+        {
+            leftEntry = leftPending;
+            rightEntry = rightPending;
+            leftPending = rightPending = 0;
+            rightNext = leftNext = 0;
+            continue;
+        }
+        if (engine->traversalPairCount == startPairCount)
+            break;
 
-        /* Fetch the next pair of items from the stack. */
-        rightEntry = AspTopValue2(engine);
-        assertResult = AspAssert(engine, rightEntry != 0);
+        /* Fetch the next pair of items from the worklist. */
+        assertResult = AspAssert
+            (engine,
+             AspPopPair(engine, &leftEntry, &rightEntry));
         if (assertResult != AspRunResult_OK)
             return assertResult;
-        leftEntry = AspTopValue(engine);
-        AspPopNoErase(engine);
 
         /* Fetch more items if applicable. */
         switch (AspDataGetType(leftEntry))
@@ -520,12 +568,11 @@ AspRunResult AspCompare
                    of containers as well. */
                 rightNext = rightEntry;
                 leftNext = leftEntry;
-                rightEntry = AspTopValue2(engine);
-                assertResult = AspAssert(engine, rightEntry != 0);
+                assertResult = AspAssert
+                    (engine,
+                     AspPopPair(engine, &leftEntry, &rightEntry));
                 if (assertResult != AspRunResult_OK)
                     return assertResult;
-                leftEntry = AspTopValue(engine);
-                AspPopNoErase(engine);
                 break;
             }
         }
@@ -533,21 +580,6 @@ AspRunResult AspCompare
     if (iterationCount >= engine->cycleDetectionLimit)
         return AspRunResult_CycleDetected;
 
-    /* Unwind the working stack if necessary. */
-    if (engine->runResult == AspRunResult_OK)
-    {
-        uint32_t iterationCount = 0;
-        for (;
-             iterationCount < engine->cycleDetectionLimit &&
-             engine->stackTop != startStackTop;
-             iterationCount++)
-        {
-            AspPopNoErase(engine);
-        }
-        if (iterationCount >= engine->cycleDetectionLimit)
-            return AspRunResult_CycleDetected;
-    }
-
     *result = comparison;
     if (nanDetected != 0)
         *nanDetected = localNanDetected;
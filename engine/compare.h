@@ -25,6 +25,9 @@ AspRunResult AspCompare
     (AspEngine *engine,
      const AspDataEntry *left, const AspDataEntry *right,
      AspCompareType, int *result, bool *nanDetected);
+AspRunResult AspCompareStrings
+    (AspEngine *engine,
+     const AspDataEntry *left, const AspDataEntry *right, int *result);
 
 #ifdef __cplusplus
 }
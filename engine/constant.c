@@ -0,0 +1,91 @@
+/*
+ * Asp engine constant cache implementation.
+ *
+ * The integer cache holds one preallocated object for each value in a
+ * configured range. The string cache holds the string objects created by
+ * string literal instructions, each entry being chosen by the address of its
+ * instruction alone, so a different instruction may later replace it. Since
+ * code does not change while the engine runs, an entry remains valid until
+ * it is replaced or the engine is reset.
+ */
+
+#include "constant.h"
+#include "data.h"
+#include <string.h>
+
+static AspDataEntry *StringCacheEntry(AspEngine *);
+
+void AspResetConstantCache(AspEngine *engine)
+{
+    /* Create the cached integers, each holding a reference on behalf of the
+       engine so that it is never freed. */
+    for (size_t i = 0; i < engine->integerCacheSize; i++)
+    {
+        AspDataEntry *entry = engine->integerCache + i;
+        memset(entry, 0, sizeof *entry);
+        AspDataSetType(entry, DataType_Integer);
+        AspDataSetUseCount(entry, 1);
+        AspDataSetInteger(entry, engine->integerCacheMin + (int32_t)i);
+    }
+
+    for (size_t i = 0; i < engine->stringCacheSize; i++)
+    {
+        AspDataEntry *entry = engine->stringCache + i;
+        memset(entry, 0, sizeof *entry);
+        AspDataSetType(entry, DataType_StringCacheEntry);
+    }
+}
+
+AspDataEntry *AspCachedInteger(AspEngine *engine, int32_t value)
+{
+    if (engine->integerCacheSize == 0 ||
+        value < engine->integerCacheMin ||
+        (uint32_t)(value - engine->integerCacheMin) >=
+            engine->integerCacheSize)
+        return 0;
+
+    AspDataEntry *entry =
+        engine->integerCache + (value - engine->integerCacheMin);
+    AspRef(engine, entry);
+    engine->constantCacheHitCount++;
+    return entry;
+}
+
+AspDataEntry *AspFindCachedString(AspEngine *engine)
+{
+    if (engine->stringCacheSize == 0)
+        return 0;
+
+    const AspDataEntry *entry = StringCacheEntry(engine);
+    uint32_t stringIndex = AspDataGetStringCacheEntryStringIndex(entry);
+    if (stringIndex == 0 ||
+        AspDataGetStringCacheEntryAddress(entry) !=
+            engine->instructionAddress)
+        return 0;
+
+    engine->constantCacheHitCount++;
+    return AspEntry(engine, stringIndex);
+}
+
+void AspCacheString(AspEngine *engine, AspDataEntry *str)
+{
+    if (engine->stringCacheSize == 0)
+        return;
+
+    /* Release the string being replaced, if any. */
+    AspDataEntry *entry = StringCacheEntry(engine);
+    uint32_t stringIndex = AspDataGetStringCacheEntryStringIndex(entry);
+    if (stringIndex != 0)
+        AspUnref(engine, AspEntry(engine, stringIndex));
+
+    AspRef(engine, str);
+    AspDataSetStringCacheEntryAddress(entry, engine->instructionAddress);
+    AspDataSetStringCacheEntryStringIndex(entry, AspIndex(engine, str));
+}
+
+static AspDataEntry *StringCacheEntry(AspEngine *engine)
+{
+    return
+        engine->stringCache +
+        engine->instructionAddress % engine->stringCacheSize;
+}
@@ -0,0 +1,24 @@
+/*
+ * Asp engine constant cache definitions.
+ */
+
+#ifndef ASP_CONSTANT_H
+#define ASP_CONSTANT_H
+
+#include "asp-priv.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void AspResetConstantCache(AspEngine *);
+AspDataEntry *AspCachedInteger(AspEngine *, int32_t value);
+AspDataEntry *AspFindCachedString(AspEngine *);
+void AspCacheString(AspEngine *, AspDataEntry *str);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
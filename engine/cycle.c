@@ -0,0 +1,660 @@
+/*
+ * Asp engine cycle collection implementation.
+ *
+ * Reference counting alone cannot reclaim objects that refer to each other
+ * (e.g., a list that contains itself) once they become unreachable. When
+ * enabled, cycle collection finds such objects in passes, each made up of
+ * the following phases, doing a limited amount of work at a time between
+ * instructions.
+ *
+ * Mark: Starting from the stack, the modules, and the objects referenced by
+ * the engine itself (including the current local variable slots), every
+ * reachable entry is marked black. Entries whose contents have yet to be
+ * scanned are also marked grey. The roots are shaded all at once at the start
+ * of the pass. After that, each entry is shaded as a reference to it is
+ * dropped or taken out of a collection, so everything reachable at the start
+ * is marked no matter how the program rearranges its references in the
+ * meantime. Entries allocated during a pass are marked as they are allocated.
+ *
+ * Count: Entries left unmarked were unreachable when the pass started, and
+ * therefore still are. They are tallied for the statistics.
+ *
+ * Clear: The contents of each unmarked list and dictionary are released.
+ * Since only these mutable collections can close a reference cycle, doing
+ * so breaks every cycle, and reference counting reclaims the rest.
+ */
+
+#include "cycle.h"
+#include "data.h"
+#include "sequence.h"
+#include "tree.h"
+#include <string.h>
+
+static void StartPass(AspEngine *);
+static void ShadeRoots(AspEngine *);
+static AspRunResult MarkStep(AspEngine *);
+static AspRunResult ScanMember(AspEngine *);
+static void CountStep(AspEngine *);
+static AspRunResult ClearStep(AspEngine *);
+static void EndPass(AspEngine *);
+static void Shade(AspEngine *, const AspDataEntry *);
+static void ShadeChildren(AspEngine *, const AspDataEntry *);
+static bool HasChildren(const AspDataEntry *);
+static bool IsCollection(const AspDataEntry *);
+static bool TestMark(const uint32_t *marks, uint32_t index);
+static void SetMark(uint32_t *marks, uint32_t index);
+static void ClearMark(uint32_t *marks, uint32_t index);
+
+bool AspCollectCycles(AspEngine *engine, uint32_t limit)
+{
+    if (engine->inApp || engine->cycleMarks == 0 ||
+        engine->runResult != AspRunResult_OK ||
+        (engine->state != AspEngineState_Ready &&
+         engine->state != AspEngineState_Running &&
+         engine->state != AspEngineState_Ended))
+        return engine->cyclePhase == AspCyclePhase_Idle;
+
+    AspRunResult result = AspCycleStep(engine, limit);
+    if (result != AspRunResult_OK)
+        engine->runResult = result;
+
+    return engine->cyclePhase == AspCyclePhase_Idle;
+}
+
+void AspResetCycleCollection(AspEngine *engine)
+{
+    engine->cyclePhase = AspCyclePhase_Idle;
+    engine->cycleTriggerCount =
+        engine->cycleMarks == 0 ? 0 : engine->cycleTriggerFreeCount;
+    engine->cycleIndex = 0;
+    engine->cycleScanEntry = engine->cycleScanMember = 0;
+    engine->cycleStackCount = 0;
+}
+
+AspRunResult AspCycleStep(AspEngine *engine, uint32_t limit)
+{
+    /* Before starting a pass, finish any deferred destruction. Queued
+       entries are linked through their use count fields, so they must be
+       out of the way before marking begins. */
+    if (engine->cyclePhase == AspCyclePhase_Idle)
+    {
+        if (!AspCollect(engine, limit))
+            return engine->runResult;
+        StartPass(engine);
+    }
+
+    /* Do up to the given number of units of work. A limit of zero completes
+       the pass. */
+    for (uint32_t count = 0;
+         (limit == 0 || count < limit) &&
+         engine->cyclePhase != AspCyclePhase_Idle &&
+         engine->runResult == AspRunResult_OK;
+         count++)
+    {
+        AspRunResult result = AspRunResult_OK;
+        switch (engine->cyclePhase)
+        {
+            case AspCyclePhase_Mark:
+                result = MarkStep(engine);
+                break;
+            case AspCyclePhase_Count:
+                CountStep(engine);
+                break;
+            case AspCyclePhase_Clear:
+                result = ClearStep(engine);
+                break;
+            default:
+                result = AspRunResult_InternalError;
+                break;
+        }
+        if (result != AspRunResult_OK)
+            return result;
+    }
+
+    return engine->runResult;
+}
+
+void AspCycleShade(AspEngine *engine, const AspDataEntry *entry)
+{
+    /* While marking, a shaded entry's contents are scanned in turn. After
+       that, marking the entry merely keeps it from being counted or
+       cleared, as is needed for queued entries. */
+    if (engine->cyclePhase == AspCyclePhase_Mark)
+    {
+        Shade(engine, entry);
+        return;
+    }
+
+    uint32_t index = AspIndex(engine, entry);
+    if (index < engine->highWaterIndex)
+        SetMark(engine->cycleMarks, index);
+}
+
+void AspCycleAllocated(AspEngine *engine, uint32_t index)
+{
+    SetMark(engine->cycleMarks, index);
+}
+
+void AspCycleEraseMember
+    (AspEngine *engine, const AspDataEntry *container,
+     const AspDataEntry *member)
+{
+    /* The erased member's references may be taken over by the caller
+       rather than released, so shade what it refers to. */
+    ShadeChildren(engine, member);
+
+    /* If the member is the last one scanned in the collection being
+       scanned, step back to its predecessor so that the scan resumes with
+       the member that follows it. */
+    if (member != engine->cycleScanMember)
+        return;
+    if (AspDataGetType(member) == DataType_Element)
+    {
+        engine->cycleScanMember = AspEntry
+            (engine, AspDataGetElementPreviousIndex(member));
+        return;
+    }
+    AspTreeResult previousResult = AspTreeNext
+        (engine, container, member, false);
+    engine->cycleScanMember =
+        previousResult.result == AspRunResult_OK ? previousResult.node : 0;
+}
+
+void AspCyclePopFrame(AspEngine *engine, const AspDataEntry *frame)
+{
+    /* The frame's references (e.g., the caller's local variables) are taken
+       over by the engine rather than released, so shade what it refers to
+       in case the frame has yet to be scanned. */
+    ShadeChildren(engine, frame);
+}
+
+static void StartPass(AspEngine *engine)
+{
+    /* Clear the marks of entries used since the data area was cleared.
+       Entries beyond the high-water index are marked as they are
+       allocated. */
+    size_t wordCount = (engine->highWaterIndex + 31U) / 32U;
+    memset
+        (engine->cycleMarks, 0, wordCount * sizeof *engine->cycleMarks);
+    memset
+        (engine->cycleMarks + engine->cycleMarkWordCount, 0,
+         wordCount * sizeof *engine->cycleMarks);
+    engine->cyclePhase = AspCyclePhase_Mark;
+    engine->cycleTriggerCount = SIZE_MAX;
+    engine->cycleIndex = engine->highWaterIndex;
+    engine->cycleScanEntry = engine->cycleScanMember = 0;
+    engine->cycleStackCount = 0;
+
+    #ifdef ASP_DEBUG
+    fprintf
+        (engine->traceFile, "Cycle collection pass starting; free: %zu\n",
+         engine->freeCount);
+    #endif
+
+    ShadeRoots(engine);
+}
+
+static void ShadeRoots(AspEngine *engine)
+{
+    /* Shade the contents of the stack. Entries in the fixed stack region
+       lie outside the data entries, so each entry's values are shaded
+       directly. */
+    for (AspDataEntry *entry = engine->stackTop; entry != 0;
+         entry = AspEntry
+            (engine, AspDataGetStackEntryPreviousIndex(entry)))
+    {
+        uint32_t index = AspIndex(engine, entry);
+        if (index < engine->highWaterIndex)
+            SetMark(engine->cycleMarks, index);
+        ShadeChildren(engine, entry);
+    }
+
+    /* Shade the objects referenced by the engine. */
+    Shade(engine, engine->noneSingleton);
+    Shade(engine, engine->ellipsisSingleton);
+    Shade(engine, engine->falseSingleton);
+    Shade(engine, engine->trueSingleton);
+    Shade(engine, engine->modules);
+    Shade(engine, engine->systemModule);
+    Shade(engine, engine->module);
+    Shade(engine, engine->systemNamespace);
+    Shade(engine, engine->globalNamespace);
+    Shade(engine, engine->localNamespace);
+    Shade(engine, engine->localSlots);
+    Shade(engine, engine->argumentList);
+    Shade(engine, engine->appFunction);
+    Shade(engine, engine->appFunctionNamespace);
+    Shade(engine, engine->appFunctionSlots);
+    Shade(engine, engine->appFunctionReturnValue);
+    Shade(engine, engine->resumeValue);
+    for (size_t i = 0; i < engine->stringCacheSize; i++)
+        Shade(engine, AspEntry
+            (engine, AspDataGetStringCacheEntryStringIndex
+                (engine->stringCache + i)));
+}
+
+static AspRunResult MarkStep(AspEngine *engine)
+{
+    /* Continue scanning a collection, one member at a time. */
+    if (engine->cycleScanEntry != 0)
+        return ScanMember(engine);
+
+    /* Take the next entry awaiting a scan. When the mark stack is empty,
+       search the grey marks for entries that did not fit on it, one word
+       of marks at a time. Marking is complete when none remain. */
+    uint32_t index;
+    if (engine->cycleStackCount != 0)
+        index = engine->cycleStack[--engine->cycleStackCount];
+    else
+    {
+        if (engine->cycleIndex >= engine->highWaterIndex)
+        {
+            engine->cyclePhase = AspCyclePhase_Count;
+            engine->cycleIndex = 0;
+            return AspRunResult_OK;
+        }
+
+        const uint32_t *greyMarks =
+            engine->cycleMarks + engine->cycleMarkWordCount;
+        uint32_t bitIndex = engine->cycleIndex % 32U;
+        uint32_t word = greyMarks[engine->cycleIndex / 32U] >> bitIndex;
+        if (word == 0)
+        {
+            engine->cycleIndex += 32U - bitIndex;
+            return AspRunResult_OK;
+        }
+        for (; (word & 1U) == 0; word >>= 1)
+            engine->cycleIndex++;
+        index = engine->cycleIndex++;
+    }
+
+    uint32_t *greyMarks = engine->cycleMarks + engine->cycleMarkWordCount;
+    if (!TestMark(greyMarks, index))
+        return AspRunResult_OK;
+    ClearMark(greyMarks, index);
+
+    /* Scan the entry. The members of collections are scanned in subsequent
+       steps. */
+    AspDataEntry *entry = AspEntry(engine, index);
+    if (IsCollection(entry))
+    {
+        engine->cycleScanEntry = entry;
+        engine->cycleScanMember = 0;
+    }
+    else
+        ShadeChildren(engine, entry);
+
+    return AspRunResult_OK;
+}
+
+static AspRunResult ScanMember(AspEngine *engine)
+{
+    AspDataEntry *collection = engine->cycleScanEntry;
+    uint8_t t = AspDataGetType(collection);
+    AspDataEntry *member;
+    if (t == DataType_Set || t == DataType_Dictionary ||
+        t == DataType_Namespace)
+    {
+        AspTreeResult nextResult = AspTreeNext
+            (engine, collection, engine->cycleScanMember, true);
+        if (nextResult.result != AspRunResult_OK)
+            return nextResult.result;
+        member = nextResult.node;
+    }
+    else
+    {
+        AspSequenceResult nextResult = AspSequenceNext
+            (engine, collection, engine->cycleScanMember, true);
+        if (nextResult.result != AspRunResult_OK)
+            return nextResult.result;
+        member = nextResult.element;
+    }
+    if (member == 0)
+    {
+        engine->cycleScanEntry = engine->cycleScanMember = 0;
+        return AspRunResult_OK;
+    }
+
+    /* Members are reachable only through their collection, so they can be
+       marked black and scanned at once. */
+    engine->cycleScanMember = member;
+    SetMark(engine->cycleMarks, AspIndex(engine, member));
+    ShadeChildren(engine, member);
+
+    return AspRunResult_OK;
+}
+
+static void CountStep(AspEngine *engine)
+{
+    /* Tally the unmarked entries covered by one word of marks. */
+    uint32_t index = engine->cycleIndex;
+    if (index >= engine->highWaterIndex)
+    {
+        engine->cyclePhase = AspCyclePhase_Clear;
+        engine->cycleIndex = 0;
+        return;
+    }
+    uint32_t word = engine->cycleMarks[index / 32U];
+    uint32_t endIndex = index + 32U;
+    if (endIndex > engine->highWaterIndex)
+        endIndex = engine->highWaterIndex;
+    for (; index < endIndex; index++, word >>= 1)
+    {
+        if ((word & 1U) == 0 &&
+            AspDataGetType(engine->data + index) != DataType_Free &&
+            engine->cycleReclaimCount < SIZE_MAX)
+            engine->cycleReclaimCount++;
+    }
+    engine->cycleIndex = endIndex;
+}
+
+static AspRunResult ClearStep(AspEngine *engine)
+{
+    /* Release the next member of the collection being cleared, holding a
+       reference to the collection until it is empty. */
+    AspDataEntry *collection = engine->cycleScanEntry;
+    if (collection != 0)
+    {
+        bool released;
+        AspRunResult releaseResult = AspReleaseMember
+            (engine, collection, &released);
+        if (releaseResult != AspRunResult_OK)
+            return releaseResult;
+        if (!released)
+        {
+            engine->cycleScanEntry = 0;
+            AspUnref(engine, collection);
+        }
+        else if (engine->garbageIndex != 0)
+            AspCollect(engine, engine->collectLimit);
+        return engine->runResult;
+    }
+
+    if (engine->cycleIndex >= engine->highWaterIndex)
+    {
+        EndPass(engine);
+        return AspRunResult_OK;
+    }
+
+    /* Find the next unmarked entry among those covered by one word of
+       marks. */
+    uint32_t index = engine->cycleIndex;
+    uint32_t endIndex = (index / 32U + 1U) * 32U;
+    if (endIndex > engine->highWaterIndex)
+        endIndex = engine->highWaterIndex;
+    while (index < endIndex && TestMark(engine->cycleMarks, index))
+        index++;
+    engine->cycleIndex = index < endIndex ? index + 1U : endIndex;
+    if (index >= endIndex)
+        return AspRunResult_OK;
+
+    /* Select the entry for clearing if it is a list or dictionary.
+       Unmarked entries are never queued, so their use counts are
+       intact. */
+    AspDataEntry *entry = AspEntry(engine, index);
+    uint8_t t = AspDataGetType(entry);
+    if ((t == DataType_List || t == DataType_Dictionary) &&
+        AspDataGetUseCount(entry) != 0)
+    {
+        AspRef(engine, entry);
+        engine->cycleScanEntry = entry;
+    }
+
+    return AspRunResult_OK;
+}
+
+static void EndPass(AspEngine *engine)
+{
+    engine->cyclePhase = AspCyclePhase_Idle;
+    if (engine->cycleCount < SIZE_MAX)
+        engine->cycleCount++;
+
+    /* If the pass did not free enough entries to get back above the
+       trigger count, the remaining entries are mostly in use. In that case,
+       wait for the number of free entries to halve before starting another
+       pass, to avoid passes running back to back. */
+    engine->cycleTriggerCount =
+        engine->freeCount >= engine->cycleTriggerFreeCount ?
+        engine->cycleTriggerFreeCount : engine->freeCount / 2;
+
+    #ifdef ASP_DEBUG
+    fprintf
+        (engine->traceFile, "Cycle collection pass ended; free: %zu\n",
+         engine->freeCount);
+    #endif
+}
+
+static void Shade(AspEngine *engine, const AspDataEntry *entry)
+{
+    /* Entries outside the data entries (e.g., cached integers) are never
+       reclaimed, and so are not marked. */
+    if (entry == 0)
+        return;
+    uint32_t index = AspIndex(engine, entry);
+    if (index >= engine->highWaterIndex ||
+        TestMark(engine->cycleMarks, index))
+        return;
+    SetMark(engine->cycleMarks, index);
+    if (!HasChildren(entry))
+        return;
+
+    /* Record the entry as awaiting a scan. If the mark stack is full, leave
+       it to be found by searching the grey marks. */
+    SetMark(engine->cycleMarks + engine->cycleMarkWordCount, index);
+    if (engine->cycleStackCount < AspCycleStackCount)
+        engine->cycleStack[engine->cycleStackCount++] = index;
+    else if (index < engine->cycleIndex)
+        engine->cycleIndex = index;
+}
+
+static void ShadeChildren(AspEngine *engine, const AspDataEntry *entry)
+{
+    switch (AspDataGetType(entry))
+    {
+        case DataType_ForwardIterator:
+        case DataType_ReverseIterator:
+            Shade(engine, AspValueEntry
+                (engine, AspDataGetIteratorIterableIndex(entry)));
+            Shade(engine, AspEntry
+                (engine, AspDataGetIteratorMemberIndex(entry)));
+            break;
+
+        case DataType_Function:
+            Shade(engine, AspValueEntry
+                (engine, AspDataGetFunctionModuleIndex(entry)));
+            if (!AspDataGetFunctionIsPending(entry))
+                Shade(engine, AspValueEntry
+                    (engine, AspDataGetFunctionParametersIndex(entry)));
+            break;
+
+        case DataType_AppFunctionInfo:
+            if (!AspDataGetAppFunctionInfoIsPending(entry))
+                Shade(engine, AspEntry
+                    (engine,
+                     AspDataGetAppFunctionInfoParametersIndex(entry)));
+            break;
+
+        case DataType_Module:
+            Shade(engine, AspEntry
+                (engine, AspDataGetModuleNamespaceIndex(entry)));
+            break;
+
+        case DataType_Range:
+            if (AspDataGetRangeHasStart(entry))
+                Shade(engine, AspValueEntry
+                    (engine, AspDataGetRangeStartIndex(entry)));
+            if (AspDataGetRangeHasEnd(entry))
+                Shade(engine, AspValueEntry
+                    (engine, AspDataGetRangeEndIndex(entry)));
+            if (AspDataGetRangeHasStep(entry))
+                Shade(engine, AspValueEntry
+                    (engine, AspDataGetRangeStepIndex(entry)));
+            break;
+
+        case DataType_AppIntegerObject:
+        case DataType_AppPointerObject:
+        {
+            AspDataEntry *info = AspAppObjectInfoEntry
+                (engine, (AspDataEntry *)entry);
+            if (info != entry)
+                Shade(engine, info);
+            break;
+        }
+
+        case DataType_Frame:
+            Shade(engine, AspValueEntry
+                (engine, AspDataGetFrameModuleIndex(entry)));
+            Shade(engine, AspEntry
+                (engine, AspDataGetFrameLocalNamespaceIndex(entry)));
+            Shade(engine, AspEntry
+                (engine, AspDataGetFrameLocalSlotsIndex(entry)));
+            break;
+
+        case DataType_LocalSlots:
+            Shade(engine, AspEntry
+                (engine, AspDataGetLocalSlotsRootIndex(entry)));
+            break;
+
+        case DataType_SlotBlock:
+            for (unsigned i = 0; i < 4; i++)
+                if (AspDataGetSlotBlockIsBound(entry, i))
+                    Shade(engine, AspValueEntry
+                        (engine, AspDataGetSlotBlockIndex(entry, i)));
+            break;
+
+        case DataType_AppFrame:
+            Shade(engine, AspEntry
+                (engine, AspDataGetAppFrameFunctionIndex(entry)));
+            Shade(engine, AspEntry
+                (engine, AspDataGetAppFrameLocalNamespaceIndex(entry)));
+            Shade(engine, AspEntry
+                (engine, AspDataGetAppFrameLocalSlotsIndex(entry)));
+            if (AspDataGetAppFrameReturnValueDefined(entry))
+                Shade(engine, AspValueEntry
+                    (engine, AspDataGetAppFrameReturnValueIndex(entry)));
+            break;
+
+        case DataType_StackEntry:
+            Shade(engine, AspValueEntry
+                (engine, AspDataGetStackEntryValueIndex(entry)));
+            if (AspDataGetStackEntryHasValue2(entry))
+                Shade(engine, AspValueEntry
+                    (engine, AspDataGetStackEntryValue2Index(entry)));
+            break;
+
+        case DataType_Element:
+            Shade(engine, AspValueEntry
+                (engine, AspDataGetElementValueIndex(entry)));
+            break;
+
+        case DataType_KeyValuePair:
+            Shade(engine, AspValueEntry
+                (engine, AspDataGetKeyValuePairKeyIndex(entry)));
+            Shade(engine, AspValueEntry
+                (engine, AspDataGetKeyValuePairValueIndex(entry)));
+            break;
+
+        case DataType_SetNode:
+            Shade(engine, AspValueEntry
+                (engine, AspDataGetTreeNodeKeyIndex(entry)));
+            break;
+
+        case DataType_DictionaryNode:
+            Shade(engine, AspValueEntry
+                (engine, AspDataGetTreeNodeKeyIndex(entry)));
+
+            /* Fall through... */
+
+        case DataType_NamespaceNode:
+        {
+            Shade(engine, AspValueEntry
+                (engine, AspDataGetTreeNodeValueIndex(entry)));
+            uint32_t linksIndex = AspDataGetTreeNodeLinksIndex(entry);
+            if (linksIndex != 0 && linksIndex < engine->highWaterIndex)
+                SetMark(engine->cycleMarks, linksIndex);
+            break;
+        }
+
+        case DataType_Parameter:
+            if (AspDataGetParameterHasDefault(entry))
+                Shade(engine, AspValueEntry
+                    (engine, AspDataGetParameterDefaultIndex(entry)));
+            break;
+
+        case DataType_Argument:
+            Shade(engine, AspValueEntry
+                (engine, AspDataGetArgumentValueIndex(entry)));
+            break;
+
+        default:
+            break;
+    }
+}
+
+static bool HasChildren(const AspDataEntry *entry)
+{
+    static uint8_t parentTypes[] =
+    {
+        DataType_Range,
+        DataType_String,
+        DataType_Tuple,
+        DataType_List,
+        DataType_Set,
+        DataType_Dictionary,
+        DataType_Function,
+        DataType_AppFunctionInfo,
+        DataType_Module,
+        DataType_ReverseIterator,
+        DataType_ForwardIterator,
+        DataType_AppIntegerObject,
+        DataType_AppPointerObject,
+        DataType_StackEntry,
+        DataType_Frame,
+        DataType_AppFrame,
+        DataType_Element,
+        DataType_KeyValuePair,
+        DataType_Namespace,
+        DataType_SetNode,
+        DataType_DictionaryNode,
+        DataType_NamespaceNode,
+        DataType_Parameter,
+        DataType_ParameterList,
+        DataType_Argument,
+        DataType_ArgumentList,
+        DataType_LocalSlots,
+        DataType_SlotBlock,
+    };
+
+    uint8_t t = AspDataGetType(entry);
+    for (unsigned i = 0; i < sizeof parentTypes / sizeof *parentTypes; i++)
+        if (t == parentTypes[i])
+            return true;
+
+    return false;
+}
+
+static bool IsCollection(const AspDataEntry *entry)
+{
+    uint8_t t = AspDataGetType(entry);
+    return
+        t == DataType_String ||
+        t == DataType_Tuple || t == DataType_List ||
+        t == DataType_ParameterList || t == DataType_ArgumentList ||
+        t == DataType_Set || t == DataType_Dictionary ||
+        t == DataType_Namespace;
+}
+
+static bool TestMark(const uint32_t *marks, uint32_t index)
+{
+    return (marks[index / 32U] & 1U << index % 32U) != 0;
+}
+
+static void SetMark(uint32_t *marks, uint32_t index)
+{
+    marks[index / 32U] |= 1U << index % 32U;
+}
+
+static void ClearMark(uint32_t *marks, uint32_t index)
+{
+    marks[index / 32U] &= ~(1U << index % 32U);
+}
@@ -0,0 +1,27 @@
+/*
+ * Asp engine cycle collection definitions.
+ */
+
+#ifndef ASP_CYCLE_H
+#define ASP_CYCLE_H
+
+#include "asp-priv.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void AspResetCycleCollection(AspEngine *);
+AspRunResult AspCycleStep(AspEngine *, uint32_t limit);
+void AspCycleShade(AspEngine *, const AspDataEntry *);
+void AspCycleAllocated(AspEngine *, uint32_t index);
+void AspCycleEraseMember
+    (AspEngine *, const AspDataEntry *container, const AspDataEntry *member);
+void AspCyclePopFrame(AspEngine *, const AspDataEntry *frame);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
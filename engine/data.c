@@ -5,8 +5,10 @@
 #include "data.h"
 #include "stack.h"
 #include "sequence.h"
+#include "cycle.h"
 #include "asp-priv.h"
 #include <string.h>
+#include <stdint.h>
 
 static bool IsSimpleImmutableObject(const AspDataEntry *);
 
@@ -41,6 +43,40 @@ int32_t AspDataGetSignedWord3(const AspDataEntry *entry)
     return *(int32_t *)&value;
 }
 
+void AspDataSetSlotBlockIndex(AspDataEntry *entry, unsigned i, uint32_t value)
+{
+    switch (i)
+    {
+        case 0:
+            AspDataSetWord0(entry, value);
+            break;
+        case 1:
+            AspDataSetWord1(entry, value);
+            break;
+        case 2:
+            AspDataSetWord2(entry, value);
+            break;
+        default:
+            AspDataSetWord3(entry, value);
+            break;
+    }
+}
+
+uint32_t AspDataGetSlotBlockIndex(const AspDataEntry *entry, unsigned i)
+{
+    switch (i)
+    {
+        case 0:
+            return AspDataGetWord0(entry);
+        case 1:
+            return AspDataGetWord1(entry);
+        case 2:
+            return AspDataGetWord2(entry);
+        default:
+            return AspDataGetWord3(entry);
+    }
+}
+
 size_t AspDataEntrySize(void)
 {
     return sizeof(AspDataEntry);
@@ -48,49 +84,62 @@ size_t AspDataEntrySize(void)
 
 void AspClearData(AspEngine *engine)
 {
-    /* Clear data storage, setting every element to a free entry. */
+    /* Mark every entry as free by resetting the high-water index. Entries
+       are initialized only as they are allocated, so the cost of clearing
+       does not depend on the size of the data area. */
     engine->freeListIndex = 0;
-    AspDataEntry *data = engine->data;
-    for (unsigned i = 0; i < engine->dataEndIndex; i++)
-    {
-        memset(data + i, 0, sizeof *data);
-        AspDataSetType(data + i, DataType_Free);
-        AspDataSetFreeNext(data + i, i + 1);
-    }
-    if (engine->dataEndIndex != 0)
-        AspDataSetFreeNext(data + engine->dataEndIndex - 1, 0);
+    engine->highWaterIndex = 0;
     engine->lowFreeCount = engine->freeCount = engine->dataEndIndex;
 }
 
 uint32_t AspAlloc(AspEngine *engine)
 {
+    /* If out of entries, complete enough deferred destruction to free
+       one up. */
+    while (engine->freeCount == 0 && engine->garbageIndex != 0 &&
+           !engine->collecting && engine->runResult == AspRunResult_OK)
+        AspCollect(engine, 1);
     if (engine->freeCount == 0)
     {
         engine->runResult = AspRunResult_OutOfDataMemory;
         return 0;
     }
 
+    /* Reuse a recycled entry if there is one. Otherwise, take the next
+       entry never used since the data area was cleared. */
     AspDataEntry *data = engine->data;
-    uint32_t index = engine->freeListIndex;
-
-    AspRunResult assertResult = AspAssert
-        (engine, AspDataGetType(data + index) == DataType_Free);
-    if (assertResult != AspRunResult_OK)
-        return 0;
-
-    engine->freeListIndex = AspDataGetFreeNext(data + index);
+    uint32_t index;
+    if (engine->freeCount > engine->dataEndIndex - engine->highWaterIndex)
+    {
+        index = engine->freeListIndex;
+        AspRunResult assertResult = AspAssert
+            (engine, AspDataGetType(data + index) == DataType_Free);
+        if (assertResult != AspRunResult_OK)
+            return 0;
+        engine->freeListIndex = AspDataGetFreeNext(data + index);
+    }
+    else
+        index = engine->highWaterIndex++;
     engine->freeCount--;
     if (engine->freeCount < engine->lowFreeCount)
         engine->lowFreeCount = engine->freeCount;
+    if (engine->allocationCount < SIZE_MAX)
+        engine->allocationCount++;
     memset(data + index, 0, sizeof *data);
     AspDataSetType(data + index, DataType_None);
+
+    /* Entries allocated during a cycle collection pass are considered
+       reachable. */
+    if (engine->cyclePhase != AspCyclePhase_Idle)
+        AspCycleAllocated(engine, index);
+
     return index;
 }
 
 bool AspFree(AspEngine *engine, uint32_t index)
 {
     AspRunResult assertResult = AspAssert
-        (engine, index < engine->dataEndIndex);
+        (engine, index < engine->highWaterIndex);
     if (assertResult != AspRunResult_OK)
         return false;
     AspDataEntry *data = engine->data;
@@ -105,6 +154,10 @@ bool AspFree(AspEngine *engine, uint32_t index)
     engine->freeListIndex = index;
     engine->freeCount++;
 
+    /* Abandon the scan of a collection freed by the program. */
+    if (data + index == engine->cycleScanEntry)
+        engine->cycleScanEntry = engine->cycleScanMember = 0;
+
     return true;
 }
 
@@ -123,66 +176,56 @@ AspRunResult AspCheckIsImmutableObject
         return AspRunResult_OK;
     }
 
-    /* For tuples, we must examine the contents. Avoid recursion by using
-       the engine's stack. */
+    /* For tuples, we must examine the contents, descending into nested
+       tuples as they are found. Avoid recursion by keeping the place at
+       which to resume each enclosing tuple in the engine's traversal
+       worklist. */
     bool isImmutable = true;
-    const AspDataEntry *startStackTop = engine->stackTop;
+    unsigned startPairCount = engine->traversalPairCount;
+    const AspDataEntry *element = 0;
+    AspRunResult checkResult = AspRunResult_OK;
     uint32_t iterationCount = 0;
     for (; iterationCount < engine->cycleDetectionLimit; iterationCount++)
     {
-        uint32_t iterationCount = 0;
-        for (AspSequenceResult nextResult = AspSequenceNext
-                (engine, entry, 0, true);
-             iterationCount < engine->cycleDetectionLimit &&
-             nextResult.element != 0;
-             iterationCount++,
-             nextResult = AspSequenceNext
-                (engine, entry, nextResult.element, true))
+        AspSequenceResult nextResult = AspSequenceNext
+            (engine, entry, element, true);
+        element = nextResult.element;
+        if (element == 0)
         {
-            const AspDataEntry *value = nextResult.value;
+            /* Resume the enclosing tuple, if any. */
+            if (engine->traversalPairCount == startPairCount)
+                break;
+            checkResult = AspAssert
+                (engine, AspPopPair(engine, &entry, &element));
+            if (checkResult != AspRunResult_OK)
+                break;
+            continue;
+        }
 
-            if (AspDataGetType(value) == DataType_Tuple)
-            {
-                if (AspPushNoUse(engine, nextResult.value) == 0)
-                    return AspRunResult_OutOfDataMemory;
-            }
-            else if (!IsSimpleImmutableObject(value))
+        const AspDataEntry *value = nextResult.value;
+        if (AspDataGetType(value) == DataType_Tuple)
+        {
+            if (!AspPushPair(engine, entry, element))
             {
-                isImmutable = false;
+                checkResult = AspRunResult_NestingTooDeep;
                 break;
             }
+            entry = value;
+            element = 0;
         }
-        if (iterationCount >= engine->cycleDetectionLimit)
-            return AspRunResult_CycleDetected;
-        if (!isImmutable)
-            break;
-
-        /* Check if there's more to do. */
-        if (engine->stackTop == startStackTop ||
-            engine->runResult != AspRunResult_OK)
+        else if (!IsSimpleImmutableObject(value))
+        {
+            isImmutable = false;
             break;
-
-        /* Fetch the next item from the stack. */
-        entry = AspTopValue(engine);
-        AspPopNoErase(engine);
+        }
     }
     if (iterationCount >= engine->cycleDetectionLimit)
-        return AspRunResult_CycleDetected;
+        checkResult = AspRunResult_CycleDetected;
 
-    /* Unwind the working stack if necessary. */
-    if (engine->runResult == AspRunResult_OK)
-    {
-        uint32_t iterationCount = 0;
-        for (;
-             iterationCount < engine->cycleDetectionLimit &&
-             engine->stackTop != startStackTop;
-             iterationCount++)
-        {
-            AspPopNoErase(engine);
-        }
-        if (iterationCount >= engine->cycleDetectionLimit)
-            return AspRunResult_CycleDetected;
-    }
+    /* Discard any pairs left in the worklist. */
+    engine->traversalPairCount = startPairCount;
+    if (checkResult != AspRunResult_OK)
+        return checkResult;
 
     *result = isImmutable;
     return AspRunResult_OK;
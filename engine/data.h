@@ -45,9 +45,14 @@ typedef enum
 
     /* Support types. */
     DataType_CodeAddress = 0x40,
+    DataType_NameCacheEntry = 0x44,
+    DataType_StringCacheEntry = 0x48,
     DataType_StackEntry = 0x50,
     DataType_Frame = 0x52,
     DataType_AppFrame = 0x54,
+    DataType_LocalSlots = 0x56,
+    DataType_SlotBlock = 0x58,
+    DataType_SlotAddress = 0x5A,
     DataType_Element = 0x62,
     DataType_StringFragment = 0x64,
     DataType_KeyValuePair = 0x66,
@@ -62,6 +67,7 @@ typedef enum
     DataType_ArgumentList = 0x83,
     DataType_AppIntegerObjectInfo = 0xAA,
     DataType_AppPointerObjectInfo = 0xAB,
+    DataType_AppFunctionInfo = 0xAC,
     DataType_Free = 0xFF,
 } DataType;
 
@@ -238,6 +244,12 @@ int32_t AspDataGetSignedWord3(const AspDataEntry *);
 #define AspDataGetTreeRootIndex(eptr) \
     (AspDataGetWord1((eptr)))
 
+/* Namespace entry field access. */
+#define AspDataSetNamespaceIsLocal(eptr, value) \
+    (AspDataSetBit0((eptr), (unsigned)(value)))
+#define AspDataGetNamespaceIsLocal(eptr) \
+    ((bool)(AspDataGetBit0((eptr))))
+
 /* Iterator entry field access. */
 #define AspDataSetIteratorIterableIndex(eptr, value) \
     (AspDataSetWord0((eptr), (value)))
@@ -265,6 +277,10 @@ int32_t AspDataGetSignedWord3(const AspDataEntry *);
     (AspDataSetBit0((eptr), (unsigned)(value)))
 #define AspDataGetFunctionIsApp(eptr) \
     ((bool)(AspDataGetBit0((eptr))))
+#define AspDataSetFunctionIsPending(eptr, value) \
+    (AspDataSetBit1((eptr), (unsigned)(value)))
+#define AspDataGetFunctionIsPending(eptr) \
+    ((bool)(AspDataGetBit1((eptr))))
 #define AspDataSetFunctionSymbol(eptr, value) \
     (AspDataSetSignedWord0((eptr), (value)))
 #define AspDataGetFunctionSymbol(eptr) \
@@ -281,6 +297,35 @@ int32_t AspDataGetSignedWord3(const AspDataEntry *);
     (AspDataSetWord3((eptr), (value)))
 #define AspDataGetFunctionParametersIndex(eptr) \
     (AspDataGetWord3((eptr)))
+#define AspDataSetFunctionInfoIndex(eptr, value) \
+    (AspDataSetWord3((eptr), (value)))
+#define AspDataGetFunctionInfoIndex(eptr) \
+    (AspDataGetWord3((eptr)))
+#define AspDataSetFunctionSpecIndex(eptr, value) \
+    (AspDataSetWord3((eptr), (value)))
+#define AspDataGetFunctionSpecIndex(eptr) \
+    (AspDataGetWord3((eptr)))
+
+/* Application function info entry field access. An application function
+   dispatched through the application function table refers to one of these
+   in place of its parameter list, there being no room for its table index
+   in the function entry itself. */
+#define AspDataSetAppFunctionInfoId(eptr, value) \
+    (AspDataSetWord0((eptr), (value)))
+#define AspDataGetAppFunctionInfoId(eptr) \
+    (AspDataGetWord0((eptr)))
+#define AspDataSetAppFunctionInfoParametersIndex(eptr, value) \
+    (AspDataSetWord1((eptr), (value)))
+#define AspDataGetAppFunctionInfoParametersIndex(eptr) \
+    (AspDataGetWord1((eptr)))
+#define AspDataSetAppFunctionInfoIsPending(eptr, value) \
+    (AspDataSetBit0((eptr), (unsigned)(value)))
+#define AspDataGetAppFunctionInfoIsPending(eptr) \
+    ((bool)(AspDataGetBit0((eptr))))
+#define AspDataSetAppFunctionInfoSpecIndex(eptr, value) \
+    (AspDataSetWord1((eptr), (value)))
+#define AspDataGetAppFunctionInfoSpecIndex(eptr) \
+    (AspDataGetWord1((eptr)))
 
 /* Module entry field access. */
 #define AspDataSetModuleIsApp(eptr, value) \
@@ -349,6 +394,38 @@ int32_t AspDataGetSignedWord3(const AspDataEntry *);
 #define AspDataGetCodeAddress(eptr) \
     (AspDataGetWord0((eptr)))
 
+/* NameCacheEntry entry field access. */
+#define AspDataSetNameCacheEntryAddress(eptr, value) \
+    (AspDataSetWord0((eptr), (value)))
+#define AspDataGetNameCacheEntryAddress(eptr) \
+    (AspDataGetWord0((eptr)))
+#define AspDataSetNameCacheEntryNodeIndex(eptr, value) \
+    (AspDataSetWord1((eptr), (value)))
+#define AspDataGetNameCacheEntryNodeIndex(eptr) \
+    (AspDataGetWord1((eptr)))
+#define AspDataSetNameCacheEntryVersion(eptr, value) \
+    (AspDataSetWord2((eptr), (value)))
+#define AspDataGetNameCacheEntryVersion(eptr) \
+    (AspDataGetWord2((eptr)))
+#define AspDataSetNameCacheEntryNamespaceIndex(eptr, value) \
+    (AspDataSetWord3((eptr), (value)))
+#define AspDataGetNameCacheEntryNamespaceIndex(eptr) \
+    (AspDataGetWord3((eptr)))
+#define AspDataSetNameCacheEntryIsAddress(eptr, value) \
+    (AspDataSetBit0((eptr), (unsigned)(value)))
+#define AspDataGetNameCacheEntryIsAddress(eptr) \
+    ((bool)(AspDataGetBit0((eptr))))
+
+/* StringCacheEntry entry field access. */
+#define AspDataSetStringCacheEntryAddress(eptr, value) \
+    (AspDataSetWord0((eptr), (value)))
+#define AspDataGetStringCacheEntryAddress(eptr) \
+    (AspDataGetWord0((eptr)))
+#define AspDataSetStringCacheEntryStringIndex(eptr, value) \
+    (AspDataSetWord1((eptr), (value)))
+#define AspDataGetStringCacheEntryStringIndex(eptr) \
+    (AspDataGetWord1((eptr)))
+
 /* StackEntry entry field access. */
 #define AspDataSetStackEntryPreviousIndex(eptr, value) \
     (AspDataSetWord0((eptr), (value)))
@@ -384,6 +461,10 @@ int32_t AspDataGetSignedWord3(const AspDataEntry *);
     (AspDataSetWord2((eptr), (value)))
 #define AspDataGetFrameLocalNamespaceIndex(eptr) \
     (AspDataGetWord2((eptr)))
+#define AspDataSetFrameLocalSlotsIndex(eptr, value) \
+    (AspDataSetWord3((eptr), (value)))
+#define AspDataGetFrameLocalSlotsIndex(eptr) \
+    (AspDataGetWord3((eptr)))
 
 /* Application function frame entry field access. */
 #define AspDataSetAppFrameFunctionIndex(eptr, value) \
@@ -402,6 +483,44 @@ int32_t AspDataGetSignedWord3(const AspDataEntry *);
     (AspDataSetWord2((eptr), (value)))
 #define AspDataGetAppFrameReturnValueIndex(eptr) \
     (AspDataGetWord2((eptr)))
+#define AspDataSetAppFrameLocalSlotsIndex(eptr, value) \
+    (AspDataSetWord3((eptr), (value)))
+#define AspDataGetAppFrameLocalSlotsIndex(eptr) \
+    (AspDataGetWord3((eptr)))
+
+/* LocalSlots entry field access. */
+#define AspDataSetLocalSlotsRootIndex(eptr, value) \
+    (AspDataSetWord0((eptr), (value)))
+#define AspDataGetLocalSlotsRootIndex(eptr) \
+    (AspDataGetWord0((eptr)))
+#define AspDataSetLocalSlotsSymbolsAddress(eptr, value) \
+    (AspDataSetWord1((eptr), (value)))
+#define AspDataGetLocalSlotsSymbolsAddress(eptr) \
+    (AspDataGetWord1((eptr)))
+#define AspDataSetLocalSlotsCount(eptr, value) \
+    (AspDataSetWord2((eptr), (value)))
+#define AspDataGetLocalSlotsCount(eptr) \
+    (AspDataGetWord2((eptr)))
+
+/* SlotBlock entry field access. Each of the four words refers to a child
+   block (interior blocks) or a slot's value (leaf blocks), and is valid only
+   if its corresponding bound flag is set. */
+void AspDataSetSlotBlockIndex(AspDataEntry *, unsigned i, uint32_t value);
+uint32_t AspDataGetSlotBlockIndex(const AspDataEntry *, unsigned i);
+#define AspDataSetSlotBlockIsBound(eptr, i, value) \
+    (AspBitSet(&(eptr)->w.u.u.u1, (AspWordBitSize) + (i), (unsigned)(value)))
+#define AspDataGetSlotBlockIsBound(eptr, i) \
+    ((bool)(AspBitGet((eptr)->w.u.u.u1, (AspWordBitSize) + (i))))
+
+/* SlotAddress entry field access. */
+#define AspDataSetSlotAddressSlotsIndex(eptr, value) \
+    (AspDataSetWord0((eptr), (value)))
+#define AspDataGetSlotAddressSlotsIndex(eptr) \
+    (AspDataGetWord0((eptr)))
+#define AspDataSetSlotAddressSlot(eptr, value) \
+    (AspDataSetWord1((eptr), (value)))
+#define AspDataGetSlotAddressSlot(eptr) \
+    (AspDataGetWord1((eptr)))
 
 /* Common element entry field access. */
 #define AspDataSetElementPreviousIndex(eptr, value) \
@@ -543,6 +662,14 @@ int32_t AspDataGetSignedWord3(const AspDataEntry *);
 #define AspDataGetArgumentValueIndex(eptr) \
     (AspDataGetWord1((eptr)))
 
+/* Garbage entry field access. Entries awaiting destruction are linked
+   through a field that for each such type is either the use count or
+   otherwise unused. */
+#define AspDataSetGarbageNext(eptr, value) \
+    (AspDataSetWord2((eptr), (value)))
+#define AspDataGetGarbageNext(eptr) \
+    (AspDataGetWord2((eptr)))
+
 /* Free entry field access. */
 #define AspDataSetFreeNext(eptr, value) \
     (AspDataSetWord0((eptr), (value)))
@@ -561,6 +688,8 @@ AspDataEntry *AspEntry(AspEngine *, uint32_t index);
 AspDataEntry *AspValueEntry(AspEngine *, uint32_t index);
 uint32_t AspIndex(const AspEngine *, const AspDataEntry *);
 AspDataEntry *AspAppObjectInfoEntry(AspEngine *, AspDataEntry *);
+AspRunResult AspReleaseMember
+    (AspEngine *, AspDataEntry *collection, bool *released);
 
 #ifdef __cplusplus
 }
@@ -55,7 +55,22 @@ void AspDump(const AspEngine *engine, FILE *fp)
         fprintf(fp, "top=0x%07X", AspIndex(engine, engine->stackTop));
         fprintf(fp, ", count=%d", engine->stackCount);
     }
+    if (engine->stackBase != 0)
+        fprintf(fp, ", depth=%zu", engine->stackDepth);
     fputc('\n', fp);
+    if (engine->nameCache != 0)
+        fprintf
+            (fp, "Name cache: size=%zu, version=%u\n",
+             engine->nameCacheSize, engine->namespaceVersion);
+    if (engine->integerCache != 0)
+        fprintf
+            (fp, "Integer cache: %d..%d\n",
+             engine->integerCacheMin,
+             engine->integerCacheMin +
+             (int32_t)(engine->integerCacheSize - 1));
+    if (engine->stringCache != 0)
+        fprintf
+            (fp, "String cache: size=%zu\n", engine->stringCacheSize);
 
     fprintf
         (fp, "Modules: 0x%07X\n",
@@ -72,6 +87,9 @@ void AspDump(const AspEngine *engine, FILE *fp)
     fprintf
         (fp, "Current local namespace: 0x%07X\n",
          AspIndex(engine, engine->localNamespace));
+    fprintf
+        (fp, "Current local slots: 0x%07X\n",
+         AspIndex(engine, engine->localSlots));
 }
 
 static void DumpData(const AspEngine *engine, FILE *fp)
@@ -81,7 +99,9 @@ static void DumpData(const AspEngine *engine, FILE *fp)
     unsigned freeRangeStart = 0;
     for (unsigned i = 0; i < engine->dataEndIndex; i++)
     {
-        uint8_t t = AspDataGetType(data + i);
+        /* Entries beyond the high-water index are free but uninitialized. */
+        uint8_t t = i < engine->highWaterIndex ?
+            AspDataGetType(data + i) : DataType_Free;
         if (inFree)
         {
             if (t != DataType_Free)
@@ -145,9 +165,14 @@ static TypeName gTypeNames[] =
 
     /* Support types. */
     {DataType_CodeAddress, "caddr"},
+    {DataType_NameCacheEntry, "ncache"},
+    {DataType_StringCacheEntry, "scache"},
     {DataType_StackEntry, "stkent"},
     {DataType_Frame, "frame"},
     {DataType_AppFrame, "appframe"},
+    {DataType_LocalSlots, "slots"},
+    {DataType_SlotBlock, "sblk"},
+    {DataType_SlotAddress, "saddr"},
     {DataType_Element, "elem"},
     {DataType_StringFragment, "strfrag"},
     {DataType_KeyValuePair, "kvp"},
@@ -162,6 +187,7 @@ static TypeName gTypeNames[] =
     {DataType_ArgumentList, "args"},
     {DataType_AppIntegerObjectInfo, "app-ii"},
     {DataType_AppPointerObjectInfo, "app-pi"},
+    {DataType_AppFunctionInfo, "app-fi"},
     {DataType_Free, "free"},
 };
 
@@ -249,9 +275,13 @@ static void DumpDataEntry(uint32_t index, const AspDataEntry *entry, FILE *fp)
             else
                 fprintf(fp, " code=0x%07X",
                     AspDataGetFunctionCodeAddress(entry));
-            fprintf(fp, " mod=0x%07X params=0x%07X",
-                AspDataGetFunctionModuleIndex(entry),
-                AspDataGetFunctionParametersIndex(entry));
+            fprintf(fp, " mod=0x%07X",
+                AspDataGetFunctionModuleIndex(entry));
+            if (AspDataGetFunctionIsPending(entry))
+                fprintf(fp, " spec=%u", AspDataGetFunctionSpecIndex(entry));
+            else
+                fprintf(fp, " params=0x%07X",
+                    AspDataGetFunctionParametersIndex(entry));
             break;
 
         case DataType_Module:
@@ -321,21 +351,45 @@ static void DumpDataEntry(uint32_t index, const AspDataEntry *entry, FILE *fp)
             break;
 
         case DataType_Frame:
-            fprintf(fp, " ra=0x%07X mod=0x%07X locns=0x%07X",
+            fprintf(fp, " ra=0x%07X mod=0x%07X locns=0x%07X slots=0x%07X",
                 AspDataGetFrameReturnAddress(entry),
                 AspDataGetFrameModuleIndex(entry),
-                AspDataGetFrameLocalNamespaceIndex(entry));
+                AspDataGetFrameLocalNamespaceIndex(entry),
+                AspDataGetFrameLocalSlotsIndex(entry));
             break;
 
         case DataType_AppFrame:
-            fprintf(fp, " func=0x%07X locns=0x%07X",
+            fprintf(fp, " func=0x%07X locns=0x%07X slots=0x%07X",
                 AspDataGetAppFrameFunctionIndex(entry),
-                AspDataGetAppFrameLocalNamespaceIndex(entry));
+                AspDataGetAppFrameLocalNamespaceIndex(entry),
+                AspDataGetAppFrameLocalSlotsIndex(entry));
             if (AspDataGetAppFrameReturnValueDefined(entry))
                 fprintf(fp, " rv=0x%07X",
                     AspDataGetAppFrameReturnValueIndex(entry));
             break;
 
+        case DataType_LocalSlots:
+            fprintf(fp, " root=0x%07X syms=0x%07X count=%u",
+                AspDataGetLocalSlotsRootIndex(entry),
+                AspDataGetLocalSlotsSymbolsAddress(entry),
+                AspDataGetLocalSlotsCount(entry));
+            break;
+
+        case DataType_SlotBlock:
+            for (unsigned i = 0; i < 4; i++)
+            {
+                if (AspDataGetSlotBlockIsBound(entry, i))
+                    fprintf(fp, " %u=0x%07X",
+                        i, AspDataGetSlotBlockIndex(entry, i));
+            }
+            break;
+
+        case DataType_SlotAddress:
+            fprintf(fp, " slots=0x%07X slot=%u",
+                AspDataGetSlotAddressSlotsIndex(entry),
+                AspDataGetSlotAddressSlot(entry));
+            break;
+
         case DataType_Element:
             fprintf(fp, " prev=0x%07X next=0x%07X val=0x%07X",
                 AspDataGetElementPreviousIndex(entry),
@@ -440,6 +494,16 @@ static void DumpDataEntry(uint32_t index, const AspDataEntry *entry, FILE *fp)
                 AspDataGetAppPointerObjectValue(entry));
             break;
 
+        case DataType_AppFunctionInfo:
+            fprintf(fp, " id=%u", AspDataGetAppFunctionInfoId(entry));
+            if (AspDataGetAppFunctionInfoIsPending(entry))
+                fprintf(fp, " spec=%u",
+                    AspDataGetAppFunctionInfoSpecIndex(entry));
+            else
+                fprintf(fp, " params=0x%07X",
+                    AspDataGetAppFunctionInfoParametersIndex(entry));
+            break;
+
         case DataType_Free:
             fprintf(fp, " next=0x%07X", AspDataGetFreeNext(entry));
             break;
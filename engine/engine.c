@@ -4,6 +4,9 @@
 
 #include "asp-priv.h"
 #include "code.h"
+#include "lookup.h"
+#include "constant.h"
+#include "cycle.h"
 #include "data.h"
 #include "sequence.h"
 #include "tree.h"
@@ -21,10 +24,27 @@
 #endif
 
 static void ProcessCodeHeader(AspEngine *);
+static uint32_t ComputeCodeCheckValue(const AspEngine *);
+static AspRunResult SetRegions
+    (AspEngine *, size_t pageEntriesSize,
+     size_t stackDepth, size_t nameCacheSize,
+     size_t integerCacheSize, size_t stringCacheSize,
+     bool cycleMarks);
 static AspRunResult ResetData(AspEngine *);
 static AspRunResult InitializeAppDefinitions(AspEngine *);
+static AspRunResult LoadParameterCount
+    (const uint8_t *, unsigned specSize, unsigned *specIndex,
+     uint8_t version, uint8_t prefix, uint32_t *parameterCount);
+static AspRunResult LoadParameters
+    (AspEngine *, unsigned specSize, unsigned *specIndex,
+     uint32_t parameterCount, AspDataEntry *parameters);
+static AspRunResult SkipParameters
+    (const uint8_t *, unsigned specSize, unsigned *specIndex,
+     uint32_t parameterCount);
 static AspRunResult LoadValue
     (AspEngine *, unsigned specSize, unsigned *specIndex, AspDataEntry **);
+static AspRunResult SkipValue
+    (const uint8_t *, unsigned specSize, unsigned *specIndex);
 static AspRunResult LoadUnsignedInteger
     (const uint8_t *, unsigned specSize, unsigned *specIndex, uint32_t *);
 static AspRunResult LoadSignedInteger
@@ -64,10 +84,27 @@ AspRunResult AspInitializeEx
     engine->codePageSize = 0;
     engine->cachedCodePages = 0;
     engine->codeReader = 0;
+    engine->decodedCode = 0;
+    engine->decodedCodeCapacity = 0;
     engine->data = data;
     engine->maxDataSize = dataSize;
     engine->dataEndIndex = dataSize / AspDataEntrySize();
+    engine->stackBase = 0;
+    engine->stackDepth = 0;
+    engine->nameCache = 0;
+    engine->nameCacheSize = 0;
+    engine->integerCache = 0;
+    engine->integerCacheMin = 0;
+    engine->integerCacheSize = 0;
+    engine->stringCache = 0;
+    engine->stringCacheSize = 0;
+    engine->cycleMarks = 0;
+    engine->cycleMarkWordCount = 0;
+    engine->cycleTriggerFreeCount = 0;
+    engine->cycleLimit = 0;
     engine->cycleDetectionLimit = (uint32_t)(engine->dataEndIndex / 2);
+    engine->collectLimit = 0;
+    engine->workLimit = 0;
     engine->appSpec = appSpec;
     engine->inApp = false;
 
@@ -100,9 +137,13 @@ AspRunResult AspSetCodePaging
     size_t pageEntriesSize = pageCount * sizeof(AspCodePageEntry);
     if (pageEntriesSize >= engine->maxDataSize)
         return AspRunResult_OutOfDataMemory;
+    AspRunResult setRegionsResult = SetRegions
+        (engine, pageEntriesSize, engine->stackDepth, engine->nameCacheSize,
+         engine->integerCacheSize, engine->stringCacheSize,
+         engine->cycleMarks != 0);
+    if (setRegionsResult != AspRunResult_OK)
+        return setRegionsResult;
 
-    engine->dataEndIndex =
-        (engine->maxDataSize - pageEntriesSize) / AspDataEntrySize();
     engine->cachedCodePageCount = pageCount;
     engine->codePageSize = pageSize;
     engine->codeReader = reader;
@@ -112,6 +153,119 @@ AspRunResult AspSetCodePaging
     return AspReset(engine);
 }
 
+size_t AspDecodedInstructionSize(void)
+{
+    return sizeof(AspDecodedInstruction);
+}
+
+AspRunResult AspSetCodeDecoding
+    (AspEngine *engine, void *buffer, size_t bufferSize)
+{
+    if (engine->inApp || engine->state != AspEngineState_Reset)
+        return AspRunResult_InvalidState;
+
+    size_t capacity = buffer == 0 ? 0 :
+        bufferSize / sizeof(AspDecodedInstruction);
+    if (buffer != 0 && capacity == 0)
+        return AspRunResult_ValueOutOfRange;
+    if ((uintptr_t)buffer % sizeof(double) != 0)
+        return AspRunResult_InitializationError;
+
+    engine->decodedCode = capacity == 0 ? 0 : (AspDecodedInstruction *)buffer;
+    engine->decodedCodeCapacity = capacity;
+
+    return AspReset(engine);
+}
+
+AspRunResult AspSetStackDepth(AspEngine *engine, size_t depth)
+{
+    if (engine->inApp || engine->state != AspEngineState_Reset)
+        return AspRunResult_InvalidState;
+
+    AspRunResult setRegionsResult = SetRegions
+        (engine, engine->cachedCodePageCount * sizeof(AspCodePageEntry),
+         depth, engine->nameCacheSize,
+         engine->integerCacheSize, engine->stringCacheSize,
+         engine->cycleMarks != 0);
+    if (setRegionsResult != AspRunResult_OK)
+        return setRegionsResult;
+
+    return AspReset(engine);
+}
+
+AspRunResult AspSetNameCacheSize(AspEngine *engine, size_t size)
+{
+    if (engine->inApp || engine->state != AspEngineState_Reset)
+        return AspRunResult_InvalidState;
+
+    AspRunResult setRegionsResult = SetRegions
+        (engine, engine->cachedCodePageCount * sizeof(AspCodePageEntry),
+         engine->stackDepth, size,
+         engine->integerCacheSize, engine->stringCacheSize,
+         engine->cycleMarks != 0);
+    if (setRegionsResult != AspRunResult_OK)
+        return setRegionsResult;
+
+    return AspReset(engine);
+}
+
+AspRunResult AspSetIntegerCacheRange
+    (AspEngine *engine, int32_t min, int32_t max)
+{
+    if (engine->inApp || engine->state != AspEngineState_Reset)
+        return AspRunResult_InvalidState;
+
+    /* An empty range (i.e., max less than min) disables the cache. */
+    size_t size = max < min ? 0 : (size_t)((int64_t)max - min + 1);
+    AspRunResult setRegionsResult = SetRegions
+        (engine, engine->cachedCodePageCount * sizeof(AspCodePageEntry),
+         engine->stackDepth, engine->nameCacheSize,
+         size, engine->stringCacheSize, engine->cycleMarks != 0);
+    if (setRegionsResult != AspRunResult_OK)
+        return setRegionsResult;
+    engine->integerCacheMin = size == 0 ? 0 : min;
+
+    return AspReset(engine);
+}
+
+AspRunResult AspSetStringCacheSize(AspEngine *engine, size_t size)
+{
+    if (engine->inApp || engine->state != AspEngineState_Reset)
+        return AspRunResult_InvalidState;
+
+    AspRunResult setRegionsResult = SetRegions
+        (engine, engine->cachedCodePageCount * sizeof(AspCodePageEntry),
+         engine->stackDepth, engine->nameCacheSize,
+         engine->integerCacheSize, size, engine->cycleMarks != 0);
+    if (setRegionsResult != AspRunResult_OK)
+        return setRegionsResult;
+
+    return AspReset(engine);
+}
+
+AspRunResult AspSetCycleCollection
+    (AspEngine *engine, size_t triggerFreeCount)
+{
+    if (engine->inApp || engine->state != AspEngineState_Reset)
+        return AspRunResult_InvalidState;
+
+    /* A trigger count of zero disables cycle collection, releasing the
+       space reserved for its marks. Note that the collector cannot see
+       references held by the application, so while it is enabled, any
+       object the application keeps between steps must remain reachable
+       from the script. */
+    AspRunResult setRegionsResult = SetRegions
+        (engine, engine->cachedCodePageCount * sizeof(AspCodePageEntry),
+         engine->stackDepth, engine->nameCacheSize,
+         engine->integerCacheSize, engine->stringCacheSize,
+         triggerFreeCount != 0);
+    if (setRegionsResult != AspRunResult_OK)
+        return setRegionsResult;
+    engine->cycleTriggerFreeCount = triggerFreeCount;
+
+    return AspReset(engine);
+}
+
 void AspCodeVersion
     (const AspEngine *engine, uint8_t version[sizeof engine->version])
 {
@@ -198,8 +352,13 @@ AspAddCodeResult AspSeal(AspEngine *engine)
     }
 
     engine->codeEndKnown = true;
+    engine->codeCheckValue = ComputeCodeCheckValue(engine);
     engine->state = AspEngineState_Ready;
     engine->runResult = AspRunResult_OK;
+
+    /* Pre-decode the resident code if configured to do so. */
+    AspDecodeCode(engine);
+
     return engine->loadResult;
 }
 
@@ -269,11 +428,20 @@ AspRunResult AspReset(AspEngine *engine)
         memset(engine->codeArea, 0, engine->maxCodeSize);
     engine->code = engine->codeArea;
     engine->codeEndIndex = 0;
+    engine->codeCheckValue = 0;
     engine->pc = engine->instructionAddress = 0;
     engine->cachedCodePageIndex = 0;
     engine->codeEndKnown = false;
     engine->pagedCodeId = 0;
     engine->codePageReadCount = 0;
+    engine->allocationCount = 0;
+    engine->constantCacheHitCount = 0;
+    engine->cycleCount = 0;
+    engine->cycleReclaimCount = 0;
+    engine->decodedCodeEnd = 0;
+    engine->decodedInstruction = 0;
+    engine->nextDecodedInstruction = 0;
+    engine->decodedOperandIndex = 0;
     if (engine->cachedCodePages != 0)
     {
         for (size_t i = 0; i < engine->cachedCodePageCount; i++)
@@ -286,9 +454,12 @@ AspRunResult AspReset(AspEngine *engine)
     engine->again = false;
     engine->callFromApp = false;
     engine->callReturning = false;
+    engine->waiting = false;
+    engine->waitToken = 0;
     engine->argumentList = 0;
     engine->appFunction = 0;
     engine->appFunctionNamespace = 0;
+    engine->appFunctionSlots = 0;
     engine->appFunctionReturnValue = 0;
     engine->nextSymbol = -1;
 
@@ -306,6 +477,39 @@ uint32_t AspGetCycleDetectionLimit(const AspEngine *engine)
     return engine->cycleDetectionLimit;
 }
 
+AspRunResult AspSetCollectLimit(AspEngine *engine, uint32_t limit)
+{
+    engine->collectLimit = limit;
+    return AspRunResult_OK;
+}
+
+uint32_t AspGetCollectLimit(const AspEngine *engine)
+{
+    return engine->collectLimit;
+}
+
+AspRunResult AspSetWorkLimit(AspEngine *engine, uint32_t limit)
+{
+    engine->workLimit = limit;
+    return AspRunResult_OK;
+}
+
+uint32_t AspGetWorkLimit(const AspEngine *engine)
+{
+    return engine->workLimit;
+}
+
+AspRunResult AspSetCycleCollectionLimit(AspEngine *engine, uint32_t limit)
+{
+    engine->cycleLimit = limit;
+    return AspRunResult_OK;
+}
+
+uint32_t AspGetCycleCollectionLimit(const AspEngine *engine)
+{
+    return engine->cycleLimit;
+}
+
 AspRunResult AspRestart(AspEngine *engine)
 {
     if (engine->inApp)
@@ -321,12 +525,21 @@ AspRunResult AspRestart(AspEngine *engine)
     engine->runResult = AspRunResult_OK;
     engine->pc = engine->instructionAddress = 0;
     engine->codePageReadCount = 0;
+    engine->allocationCount = 0;
+    engine->constantCacheHitCount = 0;
+    engine->cycleCount = 0;
+    engine->cycleReclaimCount = 0;
+    engine->decodedInstruction = 0;
+    engine->nextDecodedInstruction = engine->decodedCode;
     engine->again = false;
     engine->callFromApp = false;
     engine->callReturning = false;
+    engine->waiting = false;
+    engine->waitToken = 0;
     engine->argumentList = 0;
     engine->appFunction = 0;
     engine->appFunctionNamespace = 0;
+    engine->appFunctionSlots = 0;
     engine->appFunctionReturnValue = 0;
     engine->nextSymbol = -1;
 
@@ -377,10 +590,78 @@ static void ProcessCodeHeader(AspEngine *engine)
     }
 }
 
+static uint32_t ComputeCodeCheckValue(const AspEngine *engine)
+{
+    /* Use the 32-bit FNV-1a hash of the code, which is cheap to compute
+       and sensitive to every byte. */
+    uint32_t checkValue = 0x811C9DC5U;
+    for (size_t i = 0; i < engine->codeEndIndex; i++)
+    {
+        checkValue ^= engine->code[i];
+        checkValue *= 0x01000193U;
+    }
+    return checkValue;
+}
+
+static AspRunResult SetRegions
+    (AspEngine *engine, size_t pageEntriesSize,
+     size_t stackDepth, size_t nameCacheSize,
+     size_t integerCacheSize, size_t stringCacheSize,
+     bool cycleMarks)
+{
+    /* Carve the stack, name cache, integer cache, string cache, and cycle
+       collection mark regions out of the data area, in that order, between
+       the data entries and any code page entries. */
+    size_t entryCount =
+        (engine->maxDataSize - pageEntriesSize) / AspDataEntrySize();
+    if (stackDepth >= entryCount ||
+        nameCacheSize >= entryCount - stackDepth ||
+        integerCacheSize >= entryCount - stackDepth - nameCacheSize ||
+        stringCacheSize >=
+            entryCount - stackDepth - nameCacheSize - integerCacheSize)
+        return AspRunResult_OutOfDataMemory;
+    size_t availableCount =
+        entryCount - stackDepth - nameCacheSize -
+        integerCacheSize - stringCacheSize;
+
+    /* Each entry of the mark region holds the black and grey mark bits of
+       a number of data entries, the black bits of all entries preceding the
+       grey ones. Split the remaining entries accordingly. */
+    size_t markWordCount = sizeof(AspDataEntry) / (2 * sizeof(uint32_t));
+    size_t markBitCount = markWordCount * 32;
+    size_t markEntryCount = !cycleMarks ? 0 :
+        (availableCount + markBitCount) / (markBitCount + 1);
+    if (markEntryCount >= availableCount)
+        return AspRunResult_OutOfDataMemory;
+
+    engine->dataEndIndex = availableCount - markEntryCount;
+    AspDataEntry *region = engine->data + engine->dataEndIndex;
+    engine->stackDepth = stackDepth;
+    engine->stackBase = stackDepth == 0 ? 0 : region;
+    region += stackDepth;
+    engine->nameCacheSize = nameCacheSize;
+    engine->nameCache = nameCacheSize == 0 ? 0 : region;
+    region += nameCacheSize;
+    engine->integerCacheSize = integerCacheSize;
+    engine->integerCache = integerCacheSize == 0 ? 0 : region;
+    region += integerCacheSize;
+    engine->stringCacheSize = stringCacheSize;
+    engine->stringCache = stringCacheSize == 0 ? 0 : region;
+    region += stringCacheSize;
+    engine->cycleMarkWordCount = markEntryCount * markWordCount;
+    engine->cycleMarks = markEntryCount == 0 ? 0 : (uint32_t *)region;
+
+    return AspRunResult_OK;
+}
+
 static AspRunResult ResetData(AspEngine *engine)
 {
-    /* Clear data storage, setting every element to a free entry. */
+    /* Clear data storage, making every entry free. */
     AspClearData(engine);
+    engine->garbageIndex = 0;
+    engine->collecting = false;
+    engine->resumeValue = 0;
+    AspResetCycleCollection(engine);
 
     /* Allocate the None singleton. Note that this is the only time we expect
        a zero index returned from AspAlloc to be valid. Subsequently, a zero
@@ -404,9 +685,21 @@ static AspRunResult ResetData(AspEngine *engine)
     engine->falseSingleton = 0;
     engine->trueSingleton = 0;
 
-    /* Initialize stack. */
+    /* Initialize stack. Entries in the fixed stack region, if any, are
+       typed once here so that pushing need only fill in the fields. */
     engine->stackTop = 0;
     engine->stackCount = 0;
+    for (size_t i = 0; i < engine->stackDepth; i++)
+    {
+        AspDataEntry *entry = engine->stackBase + i;
+        memset(entry, 0, sizeof *entry);
+        AspDataSetType(entry, DataType_StackEntry);
+    }
+    engine->traversalPairCount = 0;
+
+    /* Initialize the name and constant caches, if any. */
+    AspResetNameCache(engine);
+    AspResetConstantCache(engine);
 
     /* Create empty modules collection. */
     engine->modules = AspAllocEntry(engine, DataType_Namespace);
@@ -448,6 +741,7 @@ static AspRunResult ResetData(AspEngine *engine)
 
     /* Set local and global namespaces initially to the system namespace. */
     engine->localNamespace = engine->globalNamespace = engine->systemNamespace;
+    engine->localSlots = 0;
 
     /* Initialize application definitions. */
     AspRunResult appDefinitionsResult = InitializeAppDefinitions(engine);
@@ -527,6 +821,7 @@ static AspRunResult InitializeAppDefinitions(AspEngine *engine)
     /* Create definitions for application variables, functions, and application
        module imports. Note that the first few symbols are reserved. */
     int32_t nextAppModuleId = 0;
+    uint32_t nextAppFunctionId = 0;
     AspDataEntry *currentAppModule = engine->module;
     AspDataEntry *currentAppNamespace = engine->systemNamespace;
     for (int32_t nextSymbol = AspScriptSymbolBase;
@@ -536,6 +831,7 @@ static AspRunResult InitializeAppDefinitions(AspEngine *engine)
             break;
 
         /* Read the entry prefix. */
+        unsigned entryIndex = specIndex;
         uint8_t prefix = spec[specIndex++];
 
         /* Determine the entry's symbol. */
@@ -627,66 +923,22 @@ static AspRunResult InitializeAppDefinitions(AspEngine *engine)
         else if (version >= 1u && prefix == AppSpecPrefix_Function ||
                  prefix != AppSpecPrefix_Symbol)
         {
-            /* Determine the number of parameters for the function. */
+            /* Skip over the function's parameter specifications. The
+               parameter list is created from them when the function is
+               first called, sparing the entries of functions that are
+               never used. */
             uint32_t parameterCount;
-            if (version == 0 || prefix != AppSpecPrefix_Function)
-                parameterCount = prefix;
-            else
-            {
-                AspRunResult result = LoadUnsignedInteger
-                    (spec, specSize, &specIndex, &parameterCount);
-                if (result != AspRunResult_OK)
-                    return result;
-            }
-
-            /* Create the function's parameter list. */
-            AspDataEntry *parameters = AspAllocEntry
-                (engine, DataType_ParameterList);
-            if (parameters == 0)
-                return AspRunResult_OutOfDataMemory;
-            for (uint32_t p = 0; p < parameterCount; p++)
-            {
-                uint32_t parameterSpec;
-                AspRunResult result = LoadUnsignedInteger
-                    (spec, specSize, &specIndex, &parameterSpec);
-                if (result != AspRunResult_OK)
-                    return result;
-                uint32_t parameterSymbol =
-                    (int32_t)(parameterSpec & ParameterSpecMask);
-                uint8_t parameterType =
-                    (int8_t)(parameterSpec >> AspWordBitSize);
-                bool hasDefault =
-                    parameterType == AppSpecParameterType_Defaulted;
-
-                AspDataEntry *parameter = AspAllocEntry
-                    (engine, DataType_Parameter);
-                if (parameter == 0)
-                    return AspRunResult_OutOfDataMemory;
-                AspDataSetParameterSymbol(parameter, parameterSymbol);
-                AspDataSetParameterHasDefault(parameter, hasDefault);
-                AspDataSetParameterIsTupleGroup
-                    (parameter,
-                     parameterType == AppSpecParameterType_TupleGroup);
-                AspDataSetParameterIsDictionaryGroup
-                    (parameter,
-                     parameterType == AppSpecParameterType_DictionaryGroup);
-
-                if (hasDefault)
-                {
-                    AspDataEntry *defaultValue = 0;
-                    AspRunResult loadValueResult = LoadValue
-                        (engine, specSize, &specIndex, &defaultValue);
-                    if (loadValueResult != AspRunResult_OK)
-                        return loadValueResult;
-                    AspDataSetParameterDefaultIndex
-                        (parameter, AspIndex(engine, defaultValue));
-                }
-
-                AspSequenceResult parameterResult = AspSequenceAppend
-                    (engine, parameters, parameter);
-                if (parameterResult.result != AspRunResult_OK)
-                    return parameterResult.result;
-            }
+            AspRunResult countResult = LoadParameterCount
+                (spec, specSize, &specIndex, version, prefix,
+                 &parameterCount);
+            if (countResult != AspRunResult_OK)
+                return countResult;
+            AspRunResult skipResult = SkipParameters
+                (spec, specSize, &specIndex, parameterCount);
+            if (skipResult != AspRunResult_OK)
+                return skipResult;
+            if (entryIndex > AspWordMax)
+                return AspRunResult_InitializationError;
 
             /* Create the function. */
             AspDataEntry *function = AspAllocEntry(engine, DataType_Function);
@@ -697,8 +949,33 @@ static AspRunResult InitializeAppDefinitions(AspEngine *engine)
             AspRef(engine, currentAppModule);
             AspDataSetFunctionModuleIndex
                 (function, AspIndex(engine, currentAppModule));
-            AspDataSetFunctionParametersIndex
-                (function, AspIndex(engine, parameters));
+            if (engine->appSpec->functions == 0)
+            {
+                AspDataSetFunctionIsPending(function, true);
+                AspDataSetFunctionSpecIndex(function, entryIndex);
+            }
+            else
+            {
+                /* Identify the function by its position in the table of
+                   application functions, ensuring the two agree. Its
+                   arguments are bound to slots, which limits the number of
+                   parameters. */
+                uint32_t appFunctionId = nextAppFunctionId++;
+                if (appFunctionId >= engine->appSpec->functionCount ||
+                    engine->appSpec->functions[appFunctionId].symbol !=
+                    symbol ||
+                    parameterCount > UINT8_MAX)
+                    return AspRunResult_InitializationError;
+                AspDataEntry *info = AspAllocEntry
+                    (engine, DataType_AppFunctionInfo);
+                if (info == 0)
+                    return AspRunResult_OutOfDataMemory;
+                AspDataSetAppFunctionInfoId(info, appFunctionId);
+                AspDataSetAppFunctionInfoIsPending(info, true);
+                AspDataSetAppFunctionInfoSpecIndex(info, entryIndex);
+                AspDataSetFunctionInfoIndex
+                    (function, AspIndex(engine, info));
+            }
 
             /* Insert the function into the current namespace. */
             AspTreeResult insertResult = AspTreeTryInsertBySymbol
@@ -735,10 +1012,166 @@ static AspRunResult InitializeAppDefinitions(AspEngine *engine)
 
     /* Ensure we read the application spec correctly. */
     return
-        specIndex != specSize ?
+        specIndex != specSize ||
+        engine->appSpec->functions != 0 &&
+        nextAppFunctionId != engine->appSpec->functionCount ?
         AspRunResult_InitializationError : AspRunResult_OK;
 }
 
+AspRunResult AspLoadAppFunctionParameters
+    (AspEngine *engine, AspDataEntry *function)
+{
+    /* Locate the entry that holds the function's parameter list, which
+       for functions in the application function table is its info
+       entry. */
+    if (!AspDataGetFunctionIsApp(function))
+        return AspRunResult_OK;
+    bool usesTable = engine->appSpec->functions != 0;
+    AspDataEntry *info = usesTable ?
+        AspEntry(engine, AspDataGetFunctionInfoIndex(function)) : 0;
+    if (usesTable ?
+        !AspDataGetAppFunctionInfoIsPending(info) :
+        !AspDataGetFunctionIsPending(function))
+        return AspRunResult_OK;
+
+    /* Reread the function's entry in the application spec, which was
+       validated when the definitions were initialized. */
+    const uint8_t *spec = (const uint8_t *)engine->appSpec->spec;
+    unsigned specSize = engine->appSpec->specSize;
+    uint8_t version =
+        specSize >= 3 && spec[0] == 0xFF && spec[1] == 0xFF ? spec[2] : 0;
+    unsigned specIndex = usesTable ?
+        AspDataGetAppFunctionInfoSpecIndex(info) :
+        AspDataGetFunctionSpecIndex(function);
+    if (specIndex >= specSize)
+        return AspRunResult_InternalError;
+    uint8_t prefix = spec[specIndex++];
+    if (version >= 1u)
+        specIndex += 4;
+    uint32_t parameterCount;
+    AspRunResult countResult = LoadParameterCount
+        (spec, specSize, &specIndex, version, prefix, &parameterCount);
+    if (countResult != AspRunResult_OK)
+        return countResult;
+
+    /* Create the function's parameter list. */
+    AspDataEntry *parameters = AspAllocEntry
+        (engine, DataType_ParameterList);
+    if (parameters == 0)
+        return AspRunResult_OutOfDataMemory;
+    AspRunResult loadResult = LoadParameters
+        (engine, specSize, &specIndex, parameterCount, parameters);
+    if (loadResult != AspRunResult_OK)
+    {
+        AspUnref(engine, parameters);
+        return loadResult;
+    }
+
+    if (usesTable)
+    {
+        AspDataSetAppFunctionInfoIsPending(info, false);
+        AspDataSetAppFunctionInfoParametersIndex
+            (info, AspIndex(engine, parameters));
+    }
+    else
+    {
+        AspDataSetFunctionIsPending(function, false);
+        AspDataSetFunctionParametersIndex
+            (function, AspIndex(engine, parameters));
+    }
+
+    return AspRunResult_OK;
+}
+
+static AspRunResult LoadParameterCount
+    (const uint8_t *spec, unsigned specSize, unsigned *specIndex,
+     uint8_t version, uint8_t prefix, uint32_t *parameterCount)
+{
+    if (version == 0 || prefix != AppSpecPrefix_Function)
+    {
+        *parameterCount = prefix;
+        return AspRunResult_OK;
+    }
+    return LoadUnsignedInteger(spec, specSize, specIndex, parameterCount);
+}
+
+static AspRunResult LoadParameters
+    (AspEngine *engine, unsigned specSize, unsigned *specIndex,
+     uint32_t parameterCount, AspDataEntry *parameters)
+{
+    const uint8_t *spec = (const uint8_t *)engine->appSpec->spec;
+    for (uint32_t p = 0; p < parameterCount; p++)
+    {
+        uint32_t parameterSpec;
+        AspRunResult result = LoadUnsignedInteger
+            (spec, specSize, specIndex, &parameterSpec);
+        if (result != AspRunResult_OK)
+            return result;
+        uint32_t parameterSymbol =
+            (int32_t)(parameterSpec & ParameterSpecMask);
+        uint8_t parameterType =
+            (int8_t)(parameterSpec >> AspWordBitSize);
+        bool hasDefault =
+            parameterType == AppSpecParameterType_Defaulted;
+
+        AspDataEntry *parameter = AspAllocEntry
+            (engine, DataType_Parameter);
+        if (parameter == 0)
+            return AspRunResult_OutOfDataMemory;
+        AspDataSetParameterSymbol(parameter, parameterSymbol);
+        AspDataSetParameterHasDefault(parameter, hasDefault);
+        AspDataSetParameterIsTupleGroup
+            (parameter,
+             parameterType == AppSpecParameterType_TupleGroup);
+        AspDataSetParameterIsDictionaryGroup
+            (parameter,
+             parameterType == AppSpecParameterType_DictionaryGroup);
+
+        if (hasDefault)
+        {
+            AspDataEntry *defaultValue = 0;
+            AspRunResult loadValueResult = LoadValue
+                (engine, specSize, specIndex, &defaultValue);
+            if (loadValueResult != AspRunResult_OK)
+                return loadValueResult;
+            AspDataSetParameterDefaultIndex
+                (parameter, AspIndex(engine, defaultValue));
+        }
+
+        AspSequenceResult parameterResult = AspSequenceAppend
+            (engine, parameters, parameter);
+        if (parameterResult.result != AspRunResult_OK)
+            return parameterResult.result;
+    }
+
+    return AspRunResult_OK;
+}
+
+static AspRunResult SkipParameters
+    (const uint8_t *spec, unsigned specSize, unsigned *specIndex,
+     uint32_t parameterCount)
+{
+    for (uint32_t p = 0; p < parameterCount; p++)
+    {
+        uint32_t parameterSpec;
+        AspRunResult result = LoadUnsignedInteger
+            (spec, specSize, specIndex, &parameterSpec);
+        if (result != AspRunResult_OK)
+            return result;
+        uint8_t parameterType =
+            (int8_t)(parameterSpec >> AspWordBitSize);
+        if (parameterType == AppSpecParameterType_Defaulted)
+        {
+            AspRunResult skipValueResult = SkipValue
+                (spec, specSize, specIndex);
+            if (skipValueResult != AspRunResult_OK)
+                return skipValueResult;
+        }
+    }
+
+    return AspRunResult_OK;
+}
+
 static AspRunResult LoadValue
     (AspEngine *engine, unsigned specSize, unsigned *specIndex,
      AspDataEntry **valueEntry)
@@ -821,6 +1254,53 @@ static AspRunResult LoadValue
         AspRunResult_OutOfDataMemory : AspRunResult_OK;
 }
 
+static AspRunResult SkipValue
+    (const uint8_t *spec, unsigned specSize, unsigned *specIndex)
+{
+    if (*specIndex + 1 > specSize)
+        return AspRunResult_InitializationError;
+    uint32_t valueType = spec[(*specIndex)++];
+    unsigned valueSize;
+    switch (valueType)
+    {
+        default:
+            return AspRunResult_InitializationError;
+
+        case AppSpecValueType_None:
+        case AppSpecValueType_Ellipsis:
+            valueSize = 0;
+            break;
+
+        case AppSpecValueType_Boolean:
+            valueSize = 1;
+            break;
+
+        case AppSpecValueType_Integer:
+            valueSize = 4;
+            break;
+
+        case AppSpecValueType_Float:
+            valueSize = 8;
+            break;
+
+        case AppSpecValueType_String:
+        {
+            uint32_t stringSize;
+            AspRunResult result = LoadUnsignedInteger
+                (spec, specSize, specIndex, &stringSize);
+            if (result != AspRunResult_OK)
+                return result;
+            valueSize = stringSize;
+            break;
+        }
+    }
+
+    if (*specIndex + valueSize > specSize)
+        return AspRunResult_InitializationError;
+    *specIndex += valueSize;
+    return AspRunResult_OK;
+}
+
 static AspRunResult LoadUnsignedInteger
     (const uint8_t *spec, unsigned specSize, unsigned *specIndex,
      uint32_t *value)
@@ -861,6 +1341,11 @@ bool AspIsRunning(const AspEngine *engine)
     return engine->state == AspEngineState_Running;
 }
 
+bool AspIsWaiting(const AspEngine *engine)
+{
+    return engine->waiting;
+}
+
 bool AspIsRunnable(const AspEngine *engine)
 {
     return
@@ -885,3 +1370,41 @@ size_t AspCodePageReadCount(AspEngine *engine, bool reset)
         engine->codePageReadCount = 0;
     return count;
 }
+
+size_t AspAllocationCount(AspEngine *engine, bool reset)
+{
+    size_t count = engine->allocationCount;
+    if (reset)
+        engine->allocationCount = 0;
+    return count;
+}
+
+size_t AspConstantCacheHitCount(AspEngine *engine, bool reset)
+{
+    size_t count = engine->constantCacheHitCount;
+    if (reset)
+        engine->constantCacheHitCount = 0;
+    return count;
+}
+
+size_t AspCycleCollectionCount(AspEngine *engine, bool reset)
+{
+    size_t count = engine->cycleCount;
+    if (reset)
+        engine->cycleCount = 0;
+    return count;
+}
+
+size_t AspCycleReclaimCount(AspEngine *engine, bool reset)
+{
+    size_t count = engine->cycleReclaimCount;
+    if (reset)
+        engine->cycleReclaimCount = 0;
+    return count;
+}
+
+size_t AspDecodedInstructionCount(const AspEngine *engine)
+{
+    return engine->decodedCodeEnd == 0 ? 0 :
+        (size_t)(engine->decodedCodeEnd - engine->decodedCode);
+}
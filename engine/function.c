@@ -4,6 +4,7 @@
 
 #include "function.h"
 #include "asp-priv.h"
+#include "slot.h"
 #include "range.h"
 #include "stack.h"
 #include "sequence.h"
@@ -12,24 +13,68 @@
 #include "integer-result.h"
 #include "code.h"
 #include "data.h"
+#include "cycle.h"
+#include "opcode.h"
 
 #ifdef ASP_DEBUG
 #include <stdio.h>
 #endif
 
+static AspRunResult NewCallSlots
+    (AspEngine *, const AspDataEntry *function,
+     const AspDataEntry *parameterList,
+     AspDataEntry **slots, uint32_t *bodyOffset);
+static bool WorkLimitReached
+    (AspEngine *, bool limitWork, uint32_t *workCount);
+static void SuspendExpansion
+    (AspEngine *, AspDataEntry *argumentList, const AspDataEntry *previous,
+     uint32_t count, uint32_t iterationCount);
 static AspRunResult LoadArguments
     (AspEngine *,
      const AspDataEntry *argumentList, const AspDataEntry *parameterList,
-     AspDataEntry *ns);
+     AspDataEntry *ns, AspDataEntry *slots);
+static AspRunResult BindParameter
+    (AspEngine *, AspDataEntry *ns, AspDataEntry *slots,
+     int32_t symbol, uint32_t index, AspDataEntry *value);
+static AspRunResult IsParameterBound
+    (AspEngine *, const AspDataEntry *ns, const AspDataEntry *slots,
+     int32_t symbol, uint32_t index, bool *isBound);
+static AspRunResult BindPositionalArguments
+    (AspEngine *, uint32_t argumentCount,
+     const AspDataEntry *parameterList,
+     AspDataEntry *ns, AspDataEntry *slots);
+static AspRunResult PopArgumentList
+    (AspEngine *, uint32_t argumentCount, AspDataEntry **argumentList);
+static bool UsesFunctionTable
+    (const AspEngine *, const AspDataEntry *function);
+static const AspDataEntry *FunctionParameters
+    (AspEngine *, const AspDataEntry *function);
+static AspRunResult NewCallContext
+    (AspEngine *, const AspDataEntry *function,
+     const AspDataEntry *parameterList,
+     AspDataEntry **ns, AspDataEntry **slots, uint32_t *bodyOffset);
+static AspRunResult EnterFunction
+    (AspEngine *, AspDataEntry *function,
+     AspDataEntry *ns, AspDataEntry *slots, bool fromApp);
+static AspRunResult InvokeFunction
+    (AspEngine *, AspDataEntry *function, bool callerAgain,
+     uint32_t bodyOffset);
 
 AspRunResult AspExpandIterableGroupArgument
     (AspEngine *engine, AspDataEntry *argumentList,
-     const AspDataEntry *iterable)
+     const AspDataEntry *iterable, bool limitWork)
 {
     AspRunResult assertResult = AspAssert(engine, iterable != 0);
     if (assertResult != AspRunResult_OK)
         return assertResult;
 
+    /* Continue an expansion begun in an earlier step if applicable. The
+       argument list itself serves as the partial result. It remains on the
+       stack between steps, so no reference to it is held. */
+    bool resuming = engine->resumeValue != 0;
+    engine->resumeValue = 0;
+    uint32_t workCount = 0;
+
     switch (AspDataGetType(iterable))
     {
         default:
@@ -42,12 +87,21 @@ AspRunResult AspExpandIterableGroupArgument
             AspGetRange(engine, iterable, &start, &end, &step, &bounded);
             if (!bounded)
                 return AspRunResult_ValueOutOfRange;
+            if (resuming)
+                start = (int32_t)engine->resumeCount;
             AspRunResult stepResult = AspRunResult_OK;
             for (int32_t i = start;
                  stepResult == AspRunResult_OK && step < 0 ? i > end : i < end;
                  stepResult = AspTranslateIntegerResult
                     (AspAddIntegers(i, step, &i)))
             {
+                if (WorkLimitReached(engine, limitWork, &workCount))
+                {
+                    SuspendExpansion
+                        (engine, argumentList, 0, (uint32_t)i, 0);
+                    return AspRunResult_Again;
+                }
+
                 /* Create an integer value from the range. */
                 const AspDataEntry *value = AspNewInteger(engine, i);
                 if (value == 0)
@@ -74,12 +128,22 @@ AspRunResult AspExpandIterableGroupArgument
         case DataType_Tuple:
         case DataType_List:
         {
+            AspDataEntry *previousElement = 0;
+            uint8_t startIndex = 0;
             uint32_t iterationCount = 0;
+            if (resuming)
+            {
+                previousElement = AspEntry
+                    (engine, engine->resumeElementIndex);
+                startIndex = (uint8_t)engine->resumeCount;
+                iterationCount = engine->resumeIterationCount;
+            }
             for (AspSequenceResult nextResult =
-                 AspSequenceNext(engine, iterable, 0, true);
+                 AspSequenceNext(engine, iterable, previousElement, true);
                  iterationCount < engine->cycleDetectionLimit &&
                  nextResult.element != 0;
                  iterationCount++,
+                 previousElement = nextResult.element,
                  nextResult = AspSequenceNext
                     (engine, iterable, nextResult.element, true))
             {
@@ -91,10 +155,18 @@ AspRunResult AspExpandIterableGroupArgument
                     const char *fragmentData = AspDataGetStringFragmentData
                         (fragment);
 
-                    for (uint8_t fragmentIndex = 0;
+                    for (uint8_t fragmentIndex = startIndex;
                          fragmentIndex < fragmentSize;
                          fragmentIndex++)
                     {
+                        if (WorkLimitReached(engine, limitWork, &workCount))
+                        {
+                            SuspendExpansion
+                                (engine, argumentList, previousElement,
+                                 fragmentIndex, iterationCount);
+                            return AspRunResult_Again;
+                        }
+
                         /* Create a single-character string. */
                         const AspDataEntry *value = AspNewString
                             (engine, fragmentData + fragmentIndex, 1);
@@ -115,9 +187,18 @@ AspRunResult AspExpandIterableGroupArgument
                         if (appendResult.result != AspRunResult_OK)
                             return appendResult.result;
                     }
+                    startIndex = 0;
                 }
                 else
                 {
+                    if (WorkLimitReached(engine, limitWork, &workCount))
+                    {
+                        SuspendExpansion
+                            (engine, argumentList, previousElement,
+                             0, iterationCount);
+                        return AspRunResult_Again;
+                    }
+
                     /* Use the sequence item as is. */
                     AspDataEntry *value = nextResult.value;
                     AspRef(engine, value);
@@ -146,15 +227,30 @@ AspRunResult AspExpandIterableGroupArgument
         case DataType_Set:
         case DataType_Dictionary:
         {
+            AspDataEntry *previousNode = 0;
             uint32_t iterationCount = 0;
+            if (resuming)
+            {
+                previousNode = AspEntry(engine, engine->resumeElementIndex);
+                iterationCount = engine->resumeIterationCount;
+            }
             for (AspTreeResult nextResult =
-                 AspTreeNext(engine, iterable, 0, true);
+                 AspTreeNext(engine, iterable, previousNode, true);
                  iterationCount < engine->cycleDetectionLimit &&
                  nextResult.node != 0;
                  iterationCount++,
+                 previousNode = nextResult.node,
                  nextResult = AspTreeNext
                     (engine, iterable, nextResult.node, true))
             {
+                if (WorkLimitReached(engine, limitWork, &workCount))
+                {
+                    SuspendExpansion
+                        (engine, argumentList, previousNode,
+                         0, iterationCount);
+                    return AspRunResult_Again;
+                }
+
                 AspDataEntry *value = nextResult.key;
                 AspDataEntry *entryValue = nextResult.value;
 
@@ -285,7 +381,7 @@ AspRunResult AspCallFunction
         engine->callFromApp = false;
     }
 
-    AspDataEntry *ns = 0;
+    uint32_t bodyOffset = 0;
     if (!callerAgain)
     {
         if (function == 0)
@@ -298,187 +394,173 @@ AspRunResult AspCallFunction
         if (AspDataGetType(function) != DataType_Function)
             return AspRunResult_UnexpectedType;
 
-        /* Gain access to the parameter list within the function. */
-        const AspDataEntry *parameters = AspEntry
-            (engine, AspDataGetFunctionParametersIndex(function));
+        /* Gain access to the parameter list within the function, creating
+           it first if necessary. */
+        AspRunResult loadParametersResult = AspLoadAppFunctionParameters
+            (engine, function);
+        if (loadParametersResult != AspRunResult_OK)
+            return loadParametersResult;
+        const AspDataEntry *parameters = FunctionParameters
+            (engine, function);
         if (AspDataGetType(parameters) != DataType_ParameterList)
             return AspRunResult_UnexpectedType;
 
-        /* Create a local namespace for the call. */
-        ns = AspAllocEntry(engine, DataType_Namespace);
-        if (ns == 0)
-            return AspRunResult_OutOfDataMemory;
+        AspDataEntry *ns, *slots;
+        AspRunResult contextResult = NewCallContext
+            (engine, function, parameters, &ns, &slots, &bodyOffset);
+        if (contextResult != AspRunResult_OK)
+            return contextResult;
         AspRunResult loadArgumentsResult = LoadArguments
-            (engine, argumentList, parameters, ns);
+            (engine, argumentList, parameters, ns, slots);
         if (loadArgumentsResult != AspRunResult_OK)
             return loadArgumentsResult;
         AspUnref(engine, argumentList);
         if (engine->runResult != AspRunResult_OK)
             return engine->runResult;
 
-        /* Create a new frame and push it onto the stack. */
-        AspDataEntry *frame = AspAllocEntry(engine, DataType_Frame);
-        if (frame == 0)
-            return AspRunResult_OutOfDataMemory;
-        AspDataSetFrameReturnAddress
-            (frame, fromApp ? engine->instructionAddress : engine->pc);
-        AspRef(engine, engine->module);
-        AspDataSetFrameModuleIndex
-            (frame, AspIndex(engine, engine->module));
-        AspDataSetFrameLocalNamespaceIndex
-            (frame, AspIndex(engine, engine->localNamespace));
-        const AspDataEntry *newTop = AspPush(engine, frame);
-        if (newTop == 0)
-            return AspRunResult_OutOfDataMemory;
-        if (fromApp)
-        {
-            AspDataEntry *appFrame = AspAllocEntry(engine, DataType_AppFrame);
-            if (appFrame == 0)
-                return AspRunResult_OutOfDataMemory;
-            AspDataSetAppFrameFunctionIndex
-                (appFrame, AspIndex(engine, engine->appFunction));
-            AspDataSetAppFrameReturnValueDefined
-                (appFrame, engine->appFunctionReturnValue != 0);
-            AspDataSetAppFrameReturnValueIndex
-                (appFrame, AspIndex(engine, engine->appFunctionReturnValue));
-            AspDataSetAppFrameLocalNamespaceIndex
-                (appFrame, AspIndex(engine, engine->appFunctionNamespace));
-            newTop = AspPush(engine, appFrame);
-            if (newTop == 0)
-                return AspRunResult_OutOfDataMemory;
-        }
-
-        /* Switch to the new function context. */
-        if (AspDataGetFunctionIsApp(function))
-        {
-            /* Identify the application function's context, keeping access to
-               the last script caller's context as well. */
-            engine->appFunction = function;
-            engine->appFunctionNamespace = ns;
-            engine->appFunctionReturnValue = 0;
-        }
-        else
-        {
-            /* Replace the current module and global namespace with those of
-               the function. */
-            AspDataEntry *functionModule = AspValueEntry
-                (engine, AspDataGetFunctionModuleIndex(function));
-            engine->module = functionModule;
-            engine->globalNamespace = AspEntry
-                (engine, AspDataGetModuleNamespaceIndex(functionModule));
-
-            /* Replace the current local namespace with function's new
-               namespace. */
-            engine->localNamespace = ns;
-
-            engine->appFunction = 0;
-            engine->appFunctionNamespace = 0;
-            engine->appFunctionReturnValue = 0;
-        }
+        AspRunResult enterResult = EnterFunction
+            (engine, function, ns, slots, fromApp);
+        if (enterResult != AspRunResult_OK)
+            return enterResult;
     }
 
-    /* Call the function. */
-    if (callerAgain || AspDataGetFunctionIsApp(function))
-    {
-        /* Call the application function. */
-        AspDataEntry *appFunctionModule = AspValueEntry
-            (engine, AspDataGetFunctionModuleIndex(engine->appFunction));
-        int32_t appFunctionModuleSymbol = AspDataGetModuleSymbol
-            (appFunctionModule);
-        int32_t appFunctionSymbol = AspDataGetFunctionSymbol
-            (engine->appFunction);
-        engine->nextSymbol = -1;
-        engine->inApp = true;
-        AspRunResult callResult = engine->appSpec->dispatch
-            (engine,
-             appFunctionModuleSymbol, appFunctionSymbol,
-             engine->appFunctionNamespace, &engine->appFunctionReturnValue);
-        engine->inApp = false;
-        if (callResult != AspRunResult_OK &&
-            callResult != AspRunResult_Again &&
-            callResult != AspRunResult_Call)
-        {
-            if (callResult == AspRunResult_Complete)
-            {
-                #ifdef ASP_DEBUG
-                puts("Application returned AspRunResult_Complete");
-                #endif
-                callResult = AspRunResult_InvalidAppFunction;
-            }
-            return callResult;
-        }
+    return InvokeFunction(engine, function, callerAgain, bodyOffset);
+}
 
-        /* Ensure that the application did not leave a called function's return
-           value unfetched or create an argument list that will not be used. */
-        if (engine->callReturning ||
-            engine->argumentList != 0 && callResult != AspRunResult_Call)
-        {
-            #ifdef ASP_DEBUG
-            if (engine->callReturning)
-                puts("Return value not consumed");
-            else
-                puts("Unused function arguments");
-            #endif
-            return AspRunResult_InvalidAppFunction;
-        }
+AspRunResult AspCallFunctionPositional
+    (AspEngine *engine, AspDataEntry *function, uint32_t argumentCount)
+{
+    if (function == 0)
+    {
+        #ifdef ASP_DEBUG
+        puts("Unexpected null function entry");
+        #endif
+        return AspRunResult_InvalidAppFunction;
+    }
+    if (AspDataGetType(function) != DataType_Function)
+        return AspRunResult_UnexpectedType;
+    if (argumentCount > engine->stackCount)
+        return AspRunResult_StackUnderflow;
 
-        /* Cause this instruction to execute again if applicable. */
-        if (callResult != AspRunResult_OK)
-        {
-            engine->pc = engine->instructionAddress;
-            engine->again = callResult == AspRunResult_Again;
-            return AspRunResult_OK;
-        }
+    /* Gain access to the parameter list within the function, creating it
+       first if necessary. */
+    AspRunResult loadParametersResult = AspLoadAppFunctionParameters
+        (engine, function);
+    if (loadParametersResult != AspRunResult_OK)
+        return loadParametersResult;
+    const AspDataEntry *parameters = FunctionParameters(engine, function);
+    if (AspDataGetType(parameters) != DataType_ParameterList)
+        return AspRunResult_UnexpectedType;
 
-        /* We're now done with the local namespace. */
-        AspUnref(engine, engine->appFunctionNamespace);
+    AspDataEntry *ns, *slots;
+    uint32_t bodyOffset = 0;
+    AspRunResult contextResult = NewCallContext
+        (engine, function, parameters, &ns, &slots, &bodyOffset);
+    if (contextResult != AspRunResult_OK)
+        return contextResult;
+    AspRunResult bindResult = BindPositionalArguments
+        (engine, argumentCount, parameters, ns, slots);
+    if (bindResult == AspRunResult_Again)
+    {
+        /* Arguments that cannot be bound one to one, such as those
+           destined for a group parameter, take the general route through
+           an argument list. */
+        AspUnref(engine, ns != 0 ? ns : slots);
         if (engine->runResult != AspRunResult_OK)
             return engine->runResult;
+        AspDataEntry *argumentList;
+        AspRunResult popResult = PopArgumentList
+            (engine, argumentCount, &argumentList);
+        if (popResult != AspRunResult_OK)
+            return popResult;
+        return AspCallFunction(engine, function, argumentList, false);
+    }
+    if (bindResult != AspRunResult_OK)
+        return bindResult;
 
-        /* Save any return value generated by the application. */
-        AspDataEntry *returnValue = engine->appFunctionReturnValue;
+    /* The namespace or slots now hold references to the argument
+       values. */
+    for (uint32_t i = 0; i < argumentCount; i++)
+        AspPop(engine);
+    if (engine->runResult != AspRunResult_OK)
+        return engine->runResult;
 
-        /* Restore the caller's context. */
-        AspRunResult restoreFrameResult = AspReturnToCaller(engine);
-        if (restoreFrameResult != AspRunResult_OK)
-            return restoreFrameResult;
+    AspRunResult enterResult = EnterFunction
+        (engine, function, ns, slots, false);
+    if (enterResult != AspRunResult_OK)
+        return enterResult;
 
-        /* Ensure there's a return value and push it onto the stack. */
-        if (returnValue == 0)
-        {
-            returnValue = AspAllocEntry(engine, DataType_None);
-            if (returnValue == 0)
-                return AspRunResult_OutOfDataMemory;
-        }
-        const AspDataEntry *stackEntry = AspPush(engine, returnValue);
-        if (stackEntry == 0)
-            return AspRunResult_OutOfDataMemory;
-        AspUnref(engine, returnValue);
-        if (engine->runResult != AspRunResult_OK)
-            return engine->runResult;
+    return InvokeFunction(engine, function, false, bodyOffset);
+}
+
+/* Creates the local context for a call: local variable slots if the script
+   function uses them, otherwise a local namespace. Application functions in
+   the function table take their arguments from slots, one per parameter,
+   and are given a local namespace only if they store something in it. */
+static AspRunResult NewCallContext
+    (AspEngine *engine, const AspDataEntry *function,
+     const AspDataEntry *parameterList,
+     AspDataEntry **ns, AspDataEntry **slots, uint32_t *bodyOffset)
+{
+    *ns = *slots = 0;
+    *bodyOffset = 0;
+    if (UsesFunctionTable(engine, function))
+    {
+        *slots = AspNewLocalSlots
+            (engine, 0,
+             (uint8_t)AspDataGetSequenceCount(parameterList));
+        return *slots == 0 ? AspRunResult_OutOfDataMemory : AspRunResult_OK;
     }
-    else
+    if (!AspDataGetFunctionIsApp(function))
     {
-        /* Obtain the code address of the script-defined function. */
-        uint32_t codeAddress = AspDataGetFunctionCodeAddress(function);
-        AspRunResult validateResult = AspValidateCodeAddress
-            (engine, codeAddress);
-        if (validateResult != AspRunResult_OK)
-            return validateResult;
-
-        /* Transfer control to the function's code. */
-        engine->again = false;
-        engine->pc = codeAddress;
+        AspRunResult slotsResult = NewCallSlots
+            (engine, function, parameterList, slots, bodyOffset);
+        if (slotsResult != AspRunResult_OK)
+            return slotsResult;
     }
+    if (*slots == 0)
+    {
+        *ns = AspAllocEntry(engine, DataType_Namespace);
+        if (*ns == 0)
+            return AspRunResult_OutOfDataMemory;
+        AspDataSetNamespaceIsLocal(*ns, true);
+    }
+    return AspRunResult_OK;
+}
 
+/* Creates local variable slots for a call to a script function whose code
+   begins with a slot table. The function's parameters occupy the leading
+   slots, in order. */
+static AspRunResult NewCallSlots
+    (AspEngine *engine, const AspDataEntry *function,
+     const AspDataEntry *parameterList,
+     AspDataEntry **slots, uint32_t *bodyOffset)
+{
+    uint32_t codeAddress = AspDataGetFunctionCodeAddress(function);
+    uint8_t bytes[2];
+    AspRunResult loadResult = AspLoadCodeBytesAt
+        (engine, codeAddress, bytes, sizeof bytes);
+    if (loadResult != AspRunResult_OK)
+        return loadResult;
+    if (bytes[0] != OpCode_SLOTS)
+        return AspRunResult_OK;
+
+    uint8_t count = bytes[1];
+    if (AspDataGetSequenceCount(parameterList) > count)
+        return AspRunResult_InvalidInstruction;
+    *slots = AspNewLocalSlots(engine, codeAddress + 2U, count);
+    if (*slots == 0)
+        return AspRunResult_OutOfDataMemory;
+    *bodyOffset = 2U + 4U * count;
     return AspRunResult_OK;
 }
 
-/* Builds a namespace based on arguments and parameters. */
+/* Binds arguments to parameters in either a namespace or local variable
+   slots. */
 static AspRunResult LoadArguments
     (AspEngine *engine,
      const AspDataEntry *argumentList, const AspDataEntry *parameterList,
-     AspDataEntry *ns)
+     AspDataEntry *ns, AspDataEntry *slots)
 {
     AspAssert
         (engine,
@@ -490,12 +572,14 @@ static AspRunResult LoadArguments
          AspDataGetType(parameterList) == DataType_ParameterList);
     AspRunResult assertResult = AspAssert
         (engine,
-         ns != 0 &&
-         AspDataGetType(ns) == DataType_Namespace);
+         ns != 0 ?
+         AspDataGetType(ns) == DataType_Namespace :
+         slots != 0 && AspDataGetType(slots) == DataType_LocalSlots);
     if (assertResult != AspRunResult_OK)
         return assertResult;
 
     AspDataEntry *tupleGroup = 0;
+    uint32_t parameterIndex = 0, nextParameterIndex = 0;
 
     AspSequenceResult argumentResult = AspSequenceNext
         (engine, argumentList, 0, true);
@@ -529,16 +613,17 @@ static AspRunResult LoadArguments
             }
 
             parameter = parameterResult.value;
+            parameterIndex = nextParameterIndex++;
             if (AspDataGetParameterIsTupleGroup(parameter))
             {
                 tupleGroup = AspAllocEntry(engine, DataType_Tuple);
                 if (tupleGroup == 0)
                     return AspRunResult_OutOfDataMemory;
-                AspTreeResult insertResult = AspTreeTryInsertBySymbol
-                    (engine, ns, AspDataGetParameterSymbol(parameter),
-                     tupleGroup);
-                if (insertResult.result != AspRunResult_OK)
-                    return insertResult.result;
+                AspRunResult bindResult = BindParameter
+                    (engine, ns, slots, AspDataGetParameterSymbol(parameter),
+                     parameterIndex, tupleGroup);
+                if (bindResult != AspRunResult_OK)
+                    return bindResult;
                 AspUnref(engine, tupleGroup);
                 if (engine->runResult != AspRunResult_OK)
                     return engine->runResult;
@@ -556,10 +641,11 @@ static AspRunResult LoadArguments
         }
         else
         {
-            AspTreeResult insertResult = AspTreeTryInsertBySymbol
-                (engine, ns, AspDataGetParameterSymbol(parameter), value);
-            if (insertResult.result != AspRunResult_OK)
-                return insertResult.result;
+            AspRunResult bindResult = BindParameter
+                (engine, ns, slots, AspDataGetParameterSymbol(parameter),
+                 parameterIndex, value);
+            if (bindResult != AspRunResult_OK)
+                return bindResult;
         }
     }
     if (iterationCount >= engine->cycleDetectionLimit)
@@ -576,11 +662,11 @@ static AspRunResult LoadArguments
         dictionaryGroup = AspAllocEntry(engine, DataType_Dictionary);
         if (dictionaryGroup == 0)
             return AspRunResult_OutOfDataMemory;
-        AspTreeResult insertResult = AspTreeTryInsertBySymbol
-            (engine, ns, AspDataGetParameterSymbol(parameter),
-             dictionaryGroup);
-        if (insertResult.result != AspRunResult_OK)
-            return insertResult.result;
+        AspRunResult bindResult = BindParameter
+            (engine, ns, slots, AspDataGetParameterSymbol(parameter),
+             AspDataGetSequenceCount(parameterList) - 1U, dictionaryGroup);
+        if (bindResult != AspRunResult_OK)
+            return bindResult;
         AspUnref(engine, dictionaryGroup);
         if (engine->runResult != AspRunResult_OK)
             return engine->runResult;
@@ -612,10 +698,10 @@ static AspRunResult LoadArguments
             (engine, parameterList, 0, true);
         bool parameterFound = false;
         uint32_t iterationCount = 0;
-        for (;
+        for (parameterIndex = 0;
              iterationCount < engine->cycleDetectionLimit &&
              parameterResult.element != 0;
-             iterationCount++,
+             iterationCount++, parameterIndex++,
              parameterResult = AspSequenceNext
                 (engine, parameterList, parameterResult.element, true))
         {
@@ -687,11 +773,12 @@ static AspRunResult LoadArguments
         else
         {
             /* Ensure the parameter has not already been assigned. */
-            AspTreeResult findResult = AspFindSymbol
-                (engine, ns, argumentSymbol);
-            if (findResult.result != AspRunResult_OK)
-                return findResult.result;
-            if (findResult.node != 0)
+            bool isBound;
+            AspRunResult boundResult = IsParameterBound
+                (engine, ns, slots, argumentSymbol, parameterIndex, &isBound);
+            if (boundResult != AspRunResult_OK)
+                return boundResult;
+            if (isBound)
             {
                 #ifdef ASP_DEBUG
                 puts("Parameter already assigned to an argument");
@@ -699,10 +786,10 @@ static AspRunResult LoadArguments
                 return AspRunResult_MalformedFunctionCall;
             }
 
-            AspTreeResult insertResult = AspTreeTryInsertBySymbol
-                (engine, ns, argumentSymbol, value);
-            if (insertResult.result != AspRunResult_OK)
-                return insertResult.result;
+            AspRunResult bindResult = BindParameter
+                (engine, ns, slots, argumentSymbol, parameterIndex, value);
+            if (bindResult != AspRunResult_OK)
+                return bindResult;
         }
     }
     if (iterationCount >= engine->cycleDetectionLimit)
@@ -710,10 +797,11 @@ static AspRunResult LoadArguments
 
     /* Assign default values to remaining parameters. */
     iterationCount = 0;
-    for (parameterResult = AspSequenceNext(engine, parameterList, 0, true);
+    for (parameterIndex = 0,
+         parameterResult = AspSequenceNext(engine, parameterList, 0, true);
          iterationCount < engine->cycleDetectionLimit &&
          parameterResult.element != 0;
-         iterationCount++,
+         iterationCount++, parameterIndex++,
          parameterResult = AspSequenceNext
             (engine, parameterList, parameterResult.element, true))
     {
@@ -728,10 +816,11 @@ static AspRunResult LoadArguments
                 tupleGroup = AspAllocEntry(engine, DataType_Tuple);
                 if (tupleGroup == 0)
                     return AspRunResult_OutOfDataMemory;
-                AspTreeResult insertResult = AspTreeTryInsertBySymbol
-                    (engine, ns, parameterSymbol, tupleGroup);
-                if (insertResult.result != AspRunResult_OK)
-                    return insertResult.result;
+                AspRunResult bindResult = BindParameter
+                    (engine, ns, slots, parameterSymbol, parameterIndex,
+                     tupleGroup);
+                if (bindResult != AspRunResult_OK)
+                    return bindResult;
                 AspUnref(engine, tupleGroup);
                 if (engine->runResult != AspRunResult_OK)
                     return engine->runResult;
@@ -740,11 +829,13 @@ static AspRunResult LoadArguments
         else
         {
             /* Check if the parameter has been assigned a value. */
-            AspTreeResult findResult = AspFindSymbol
-                (engine, ns, parameterSymbol);
-            if (findResult.result != AspRunResult_OK)
-                return findResult.result;
-            if (findResult.node != 0)
+            bool isBound;
+            AspRunResult boundResult = IsParameterBound
+                (engine, ns, slots, parameterSymbol, parameterIndex,
+                 &isBound);
+            if (boundResult != AspRunResult_OK)
+                return boundResult;
+            if (isBound)
                 continue;
 
             if (!AspDataGetParameterHasDefault(parameter))
@@ -758,16 +849,19 @@ static AspRunResult LoadArguments
             /* Assign the default value to the parameter. */
             AspDataEntry *value = AspValueEntry
                 (engine, AspDataGetParameterDefaultIndex(parameter));
-            AspTreeResult insertResult = AspTreeTryInsertBySymbol
-                (engine, ns, parameterSymbol, value);
-            if (insertResult.result != AspRunResult_OK)
-                return insertResult.result;
+            AspRunResult bindResult = BindParameter
+                (engine, ns, slots, parameterSymbol, parameterIndex, value);
+            if (bindResult != AspRunResult_OK)
+                return bindResult;
         }
     }
     if (iterationCount >= engine->cycleDetectionLimit)
         return AspRunResult_CycleDetected;
 
-    if (AspDataGetTreeCount(ns) != AspDataGetSequenceCount(parameterList))
+    /* Slots are all bound at this point. A namespace comes up short if
+       parameter names were duplicated. */
+    if (ns != 0 &&
+        AspDataGetTreeCount(ns) != AspDataGetSequenceCount(parameterList))
     {
         #ifdef ASP_DEBUG
         puts("Not all parameters were assigned a value");
@@ -778,6 +872,37 @@ static AspRunResult LoadArguments
     return AspRunResult_OK;
 }
 
+static AspRunResult BindParameter
+    (AspEngine *engine, AspDataEntry *ns, AspDataEntry *slots,
+     int32_t symbol, uint32_t index, AspDataEntry *value)
+{
+    if (slots != 0)
+        return AspAssignLocalSlot(engine, slots, (uint8_t)index, value);
+
+    AspTreeResult insertResult = AspTreeTryInsertBySymbol
+        (engine, ns, symbol, value);
+    return insertResult.result;
+}
+
+static AspRunResult IsParameterBound
+    (AspEngine *engine, const AspDataEntry *ns, const AspDataEntry *slots,
+     int32_t symbol, uint32_t index, bool *isBound)
+{
+    *isBound = false;
+    if (slots != 0)
+    {
+        AspDataEntry *value = 0;
+        AspRunResult valueResult = AspLocalSlotValue
+            (engine, slots, (uint8_t)index, &value);
+        *isBound = value != 0;
+        return valueResult;
+    }
+
+    AspTreeResult findResult = AspFindSymbol(engine, ns, symbol);
+    *isBound = findResult.node != 0;
+    return findResult.result;
+}
+
 AspRunResult AspReturnToCaller(AspEngine *engine)
 {
     /* Access the frame on top of the stack. */
@@ -786,11 +911,17 @@ AspRunResult AspReturnToCaller(AspEngine *engine)
         return AspRunResult_StackUnderflow;
     if (AspDataGetType(frame) == DataType_AppFrame)
     {
+        /* Keep a cycle collection pass in progress informed. */
+        if (engine->cyclePhase == AspCyclePhase_Mark)
+            AspCyclePopFrame(engine, frame);
+
         /* Restore context from the application function frame. */
         engine->appFunction = AspEntry
             (engine, AspDataGetAppFrameFunctionIndex(frame));
         engine->appFunctionNamespace = AspEntry
             (engine, AspDataGetAppFrameLocalNamespaceIndex(frame));
+        engine->appFunctionSlots = AspEntry
+            (engine, AspDataGetAppFrameLocalSlotsIndex(frame));
         engine->appFunctionReturnValue =
             !AspDataGetAppFrameReturnValueDefined(frame) ? 0 :
             AspEntry(engine, AspDataGetAppFrameReturnValueIndex(frame));
@@ -813,14 +944,21 @@ AspRunResult AspReturnToCaller(AspEngine *engine)
         engine->again = false;
         engine->appFunction = 0;
         engine->appFunctionNamespace = 0;
+        engine->appFunctionSlots = 0;
         engine->appFunctionReturnValue = 0;
     }
     if (AspDataGetType(frame) != DataType_Frame)
         return AspRunResult_UnexpectedType;
 
+    /* Keep a cycle collection pass in progress informed. */
+    if (engine->cyclePhase == AspCyclePhase_Mark)
+        AspCyclePopFrame(engine, frame);
+
     /* Restore context from the standard frame. */
     engine->localNamespace = AspEntry
         (engine, AspDataGetFrameLocalNamespaceIndex(frame));
+    engine->localSlots = AspEntry
+        (engine, AspDataGetFrameLocalSlotsIndex(frame));
     engine->module = AspEntry
         (engine, AspDataGetFrameModuleIndex(frame));
     engine->globalNamespace = AspValueEntry
@@ -838,6 +976,19 @@ AspRunResult AspReturnToCaller(AspEngine *engine)
     return AspRunResult_OK;
 }
 
+AspDataEntry *AspLocalNamespace(AspEngine *engine)
+{
+    /* Functions that use slots create their local namespace on first use,
+       e.g., for variables declared global or local. */
+    if (engine->localNamespace == 0)
+    {
+        engine->localNamespace = AspAllocEntry(engine, DataType_Namespace);
+        if (engine->localNamespace != 0)
+            AspDataSetNamespaceIsLocal(engine->localNamespace, true);
+    }
+    return engine->localNamespace;
+}
+
 AspDataEntry *AspParameterValue
     (AspEngine *engine, const AspDataEntry *ns, int32_t symbol)
 {
@@ -870,3 +1021,387 @@ AspParameterResult AspGroupParameterValue
 
     return result;
 }
+
+AspRunResult AspAppArguments
+    (AspEngine *engine, unsigned count, AspDataEntry **arguments)
+{
+    AspAssert(engine, engine->inApp && engine->appFunction != 0);
+
+    /* Ensure the caller expects as many arguments as there are
+       parameters. */
+    AspDataEntry *slots = engine->appFunctionSlots;
+    unsigned slotCount =
+        slots == 0 ? 0 : AspDataGetLocalSlotsCount(slots);
+    if (count != slotCount)
+        return AspRunResult_InvalidAppFunction;
+
+    for (unsigned i = 0; i < count; i++)
+    {
+        AspRunResult result = AspLocalSlotValue
+            (engine, slots, (uint8_t)i, arguments + i);
+        if (result != AspRunResult_OK)
+            return result;
+    }
+
+    return AspRunResult_OK;
+}
+
+/* Binds positional argument values on the stack to parameters in order,
+   in either a namespace or local variable slots, applying defaults to any
+   remaining parameters. Returns AspRunResult_Again if the general method of
+   building an argument list is required instead. */
+static AspRunResult BindPositionalArguments
+    (AspEngine *engine, uint32_t argumentCount,
+     const AspDataEntry *parameterList,
+     AspDataEntry *ns, AspDataEntry *slots)
+{
+    uint32_t parameterCount = AspDataGetSequenceCount(parameterList);
+    if (argumentCount > parameterCount)
+        return AspRunResult_Again;
+
+    /* Work backwards through the parameters so that argument values can be
+       taken from the stack in order, starting at the top. */
+    const AspDataEntry *stackEntry = engine->stackTop;
+    uint32_t parameterIndex = parameterCount;
+    for (AspSequenceResult parameterResult = AspSequenceNext
+            (engine, parameterList, 0, false);
+         parameterIndex > 0 && parameterResult.element != 0;
+         parameterResult = AspSequenceNext
+            (engine, parameterList, parameterResult.element, false))
+    {
+        const AspDataEntry *parameter = parameterResult.value;
+        parameterIndex--;
+        if (AspDataGetParameterIsTupleGroup(parameter) ||
+            AspDataGetParameterIsDictionaryGroup(parameter))
+            return AspRunResult_Again;
+
+        AspDataEntry *value;
+        if (parameterIndex >= argumentCount)
+        {
+            if (!AspDataGetParameterHasDefault(parameter))
+            {
+                #ifdef ASP_DEBUG
+                puts("Missing parameter that has no default");
+                #endif
+                return AspRunResult_MalformedFunctionCall;
+            }
+            value = AspValueEntry
+                (engine, AspDataGetParameterDefaultIndex(parameter));
+        }
+        else
+        {
+            value = AspValueEntry
+                (engine, AspDataGetStackEntryValueIndex(stackEntry));
+            if (!AspIsObject(value))
+                return AspRunResult_UnexpectedType;
+            uint32_t previousIndex =
+                AspDataGetStackEntryPreviousIndex(stackEntry);
+            stackEntry = previousIndex == 0 ?
+                0 : AspEntry(engine, previousIndex);
+        }
+
+        AspRunResult bindResult = BindParameter
+            (engine, ns, slots, AspDataGetParameterSymbol(parameter),
+             parameterIndex, value);
+        if (bindResult != AspRunResult_OK)
+            return bindResult;
+    }
+
+    /* A namespace comes up short if parameter names were duplicated. */
+    if (parameterIndex != 0 ||
+        ns != 0 && AspDataGetTreeCount(ns) != parameterCount)
+    {
+        #ifdef ASP_DEBUG
+        puts("Not all parameters were assigned a value");
+        #endif
+        return AspRunResult_MalformedFunctionCall;
+    }
+
+    return AspRunResult_OK;
+}
+
+/* Moves positional argument values on the stack into a new argument
+   list, as a sequence of MKARG and BLD instructions would have done. */
+static AspRunResult PopArgumentList
+    (AspEngine *engine, uint32_t argumentCount, AspDataEntry **argumentList)
+{
+    AspDataEntry *list = AspAllocEntry(engine, DataType_ArgumentList);
+    if (list == 0)
+        return AspRunResult_OutOfDataMemory;
+
+    /* Insert each argument ahead of the previous one, the top of the stack
+       being the last. Each argument takes over its value's stack
+       reference. */
+    AspDataEntry *nextElement = 0;
+    for (uint32_t i = 0; i < argumentCount; i++)
+    {
+        AspDataEntry *value = AspTopValue(engine);
+        if (value == 0)
+            return AspRunResult_StackUnderflow;
+        if (!AspIsObject(value))
+            return AspRunResult_UnexpectedType;
+
+        AspDataEntry *argument = AspAllocEntry(engine, DataType_Argument);
+        if (argument == 0)
+            return AspRunResult_OutOfDataMemory;
+        AspDataSetArgumentValueIndex(argument, AspIndex(engine, value));
+        AspSequenceResult insertResult = AspSequenceInsert
+            (engine, list, nextElement, argument);
+        if (insertResult.result != AspRunResult_OK)
+            return insertResult.result;
+        nextElement = insertResult.element;
+
+        AspPopNoErase(engine);
+    }
+
+    *argumentList = list;
+    return AspRunResult_OK;
+}
+
+static AspRunResult EnterFunction
+    (AspEngine *engine, AspDataEntry *function,
+     AspDataEntry *ns, AspDataEntry *slots, bool fromApp)
+{
+    /* Create a new frame and push it onto the stack. */
+    AspDataEntry *frame = AspAllocEntry(engine, DataType_Frame);
+    if (frame == 0)
+        return AspRunResult_OutOfDataMemory;
+    AspDataSetFrameReturnAddress
+        (frame, fromApp ? engine->instructionAddress : engine->pc);
+    AspRef(engine, engine->module);
+    AspDataSetFrameModuleIndex
+        (frame, AspIndex(engine, engine->module));
+    AspDataSetFrameLocalNamespaceIndex
+        (frame, AspIndex(engine, engine->localNamespace));
+    AspDataSetFrameLocalSlotsIndex
+        (frame, AspIndex(engine, engine->localSlots));
+    const AspDataEntry *newTop = AspPush(engine, frame);
+    if (newTop == 0)
+        return AspRunResult_OutOfDataMemory;
+    if (fromApp)
+    {
+        AspDataEntry *appFrame = AspAllocEntry(engine, DataType_AppFrame);
+        if (appFrame == 0)
+            return AspRunResult_OutOfDataMemory;
+        AspDataSetAppFrameFunctionIndex
+            (appFrame, AspIndex(engine, engine->appFunction));
+        AspDataSetAppFrameReturnValueDefined
+            (appFrame, engine->appFunctionReturnValue != 0);
+        AspDataSetAppFrameReturnValueIndex
+            (appFrame, AspIndex(engine, engine->appFunctionReturnValue));
+        AspDataSetAppFrameLocalNamespaceIndex
+            (appFrame, AspIndex(engine, engine->appFunctionNamespace));
+        AspDataSetAppFrameLocalSlotsIndex
+            (appFrame, AspIndex(engine, engine->appFunctionSlots));
+        newTop = AspPush(engine, appFrame);
+        if (newTop == 0)
+            return AspRunResult_OutOfDataMemory;
+    }
+
+    /* Switch to the new function context. */
+    if (AspDataGetFunctionIsApp(function))
+    {
+        /* Identify the application function's context, keeping access to
+           the last script caller's context as well. */
+        engine->appFunction = function;
+        engine->appFunctionNamespace = ns;
+        engine->appFunctionSlots = slots;
+        engine->appFunctionReturnValue = 0;
+    }
+    else
+    {
+        /* Replace the current module and global namespace with those of
+           the function. */
+        AspDataEntry *functionModule = AspValueEntry
+            (engine, AspDataGetFunctionModuleIndex(function));
+        engine->module = functionModule;
+        engine->globalNamespace = AspEntry
+            (engine, AspDataGetModuleNamespaceIndex(functionModule));
+
+        /* Replace the current local namespace with function's new
+           namespace or slots. When using slots, a local namespace is
+           created only if needed. */
+        engine->localNamespace = ns;
+        engine->localSlots = slots;
+
+        engine->appFunction = 0;
+        engine->appFunctionNamespace = 0;
+        engine->appFunctionSlots = 0;
+        engine->appFunctionReturnValue = 0;
+    }
+
+    return AspRunResult_OK;
+}
+
+static AspRunResult InvokeFunction
+    (AspEngine *engine, AspDataEntry *function, bool callerAgain,
+     uint32_t bodyOffset)
+{
+    /* Call the function. */
+    if (callerAgain || AspDataGetFunctionIsApp(function))
+    {
+        /* Call the application function, either directly from the function
+           table or through the dispatch function. */
+        const AspAppSpec *appSpec = engine->appSpec;
+        AspAppFunction *appFunction = 0;
+        int32_t appFunctionModuleSymbol = 0, appFunctionSymbol = 0;
+        if (UsesFunctionTable(engine, engine->appFunction))
+        {
+            const AspDataEntry *info = AspEntry
+                (engine, AspDataGetFunctionInfoIndex(engine->appFunction));
+            uint32_t appFunctionId = AspDataGetAppFunctionInfoId(info);
+            if (appFunctionId >= appSpec->functionCount)
+                return AspRunResult_UndefinedAppFunction;
+            appFunction = appSpec->functions[appFunctionId].function;
+        }
+        else
+        {
+            AspDataEntry *appFunctionModule = AspValueEntry
+                (engine, AspDataGetFunctionModuleIndex(engine->appFunction));
+            appFunctionModuleSymbol = AspDataGetModuleSymbol
+                (appFunctionModule);
+            appFunctionSymbol = AspDataGetFunctionSymbol
+                (engine->appFunction);
+        }
+        engine->nextSymbol = -1;
+        engine->inApp = true;
+        AspRunResult callResult = appFunction != 0 ?
+            appFunction(engine, &engine->appFunctionReturnValue) :
+            appSpec->dispatch
+                (engine,
+                 appFunctionModuleSymbol, appFunctionSymbol,
+                 engine->appFunctionNamespace,
+                 &engine->appFunctionReturnValue);
+        engine->inApp = false;
+        if (callResult != AspRunResult_Wait)
+            engine->waitToken = 0;
+        if (callResult != AspRunResult_OK &&
+            callResult != AspRunResult_Again &&
+            callResult != AspRunResult_Wait &&
+            callResult != AspRunResult_Call)
+        {
+            if (callResult == AspRunResult_Complete)
+            {
+                #ifdef ASP_DEBUG
+                puts("Application returned AspRunResult_Complete");
+                #endif
+                callResult = AspRunResult_InvalidAppFunction;
+            }
+            return callResult;
+        }
+
+        /* Ensure that the application did not leave a called function's return
+           value unfetched or create an argument list that will not be used. */
+        if (engine->callReturning ||
+            engine->argumentList != 0 && callResult != AspRunResult_Call)
+        {
+            #ifdef ASP_DEBUG
+            if (engine->callReturning)
+                puts("Return value not consumed");
+            else
+                puts("Unused function arguments");
+            #endif
+            return AspRunResult_InvalidAppFunction;
+        }
+
+        /* Cause this instruction to execute again if applicable. A waiting
+           function is not called again until the application wakes the
+           engine. */
+        if (callResult != AspRunResult_OK)
+        {
+            engine->pc = engine->instructionAddress;
+            engine->again = callResult != AspRunResult_Call;
+            engine->waiting = callResult == AspRunResult_Wait;
+            return AspRunResult_OK;
+        }
+
+        /* We're now done with the local namespace and argument slots, if
+           any. */
+        if (engine->appFunctionNamespace != 0)
+            AspUnref(engine, engine->appFunctionNamespace);
+        if (engine->appFunctionSlots != 0)
+            AspUnref(engine, engine->appFunctionSlots);
+        if (engine->runResult != AspRunResult_OK)
+            return engine->runResult;
+
+        /* Save any return value generated by the application. */
+        AspDataEntry *returnValue = engine->appFunctionReturnValue;
+
+        /* Restore the caller's context. */
+        AspRunResult restoreFrameResult = AspReturnToCaller(engine);
+        if (restoreFrameResult != AspRunResult_OK)
+            return restoreFrameResult;
+
+        /* Ensure there's a return value and push it onto the stack. */
+        if (returnValue == 0)
+        {
+            returnValue = AspAllocEntry(engine, DataType_None);
+            if (returnValue == 0)
+                return AspRunResult_OutOfDataMemory;
+        }
+        const AspDataEntry *stackEntry = AspPush(engine, returnValue);
+        if (stackEntry == 0)
+            return AspRunResult_OutOfDataMemory;
+        AspUnref(engine, returnValue);
+        if (engine->runResult != AspRunResult_OK)
+            return engine->runResult;
+    }
+    else
+    {
+        /* Obtain the code address of the script-defined function. */
+        uint32_t codeAddress = AspDataGetFunctionCodeAddress(function);
+        AspRunResult validateResult = AspValidateCodeAddress
+            (engine, codeAddress);
+        if (validateResult != AspRunResult_OK)
+            return validateResult;
+
+        /* Transfer control to the function's code, skipping any slot
+           table. */
+        engine->again = false;
+        engine->pc = codeAddress + bodyOffset;
+    }
+
+    return AspRunResult_OK;
+}
+
+static bool WorkLimitReached
+    (AspEngine *engine, bool limitWork, uint32_t *workCount)
+{
+    return
+        limitWork && engine->workLimit != 0 &&
+        (*workCount)++ >= engine->workLimit;
+}
+
+static void SuspendExpansion
+    (AspEngine *engine, AspDataEntry *argumentList,
+     const AspDataEntry *previous, uint32_t count, uint32_t iterationCount)
+{
+    /* Save the progress made so that the expansion can continue where it
+       left off when the instruction is executed again. */
+    engine->resumeValue = argumentList;
+    engine->resumeElementIndex = AspIndex(engine, previous);
+    engine->resumeCount = count;
+    engine->resumeIterationCount = iterationCount;
+}
+
+static bool UsesFunctionTable
+    (const AspEngine *engine, const AspDataEntry *function)
+{
+    return
+        AspDataGetFunctionIsApp(function) &&
+        engine->appSpec->functions != 0;
+}
+
+static const AspDataEntry *FunctionParameters
+    (AspEngine *engine, const AspDataEntry *function)
+{
+    /* Application functions in the function table keep their parameters
+       in a separate info entry, leaving the symbol in place. */
+    if (!UsesFunctionTable(engine, function))
+        return AspEntry
+            (engine, AspDataGetFunctionParametersIndex(function));
+    const AspDataEntry *info = AspEntry
+        (engine, AspDataGetFunctionInfoIndex(function));
+    return AspEntry
+        (engine, AspDataGetAppFunctionInfoParametersIndex(info));
+}
@@ -12,13 +12,19 @@ extern "C" {
 #endif
 
 AspRunResult AspExpandIterableGroupArgument
-    (AspEngine *, AspDataEntry *argumentList, const AspDataEntry *iterable);
+    (AspEngine *, AspDataEntry *argumentList, const AspDataEntry *iterable,
+     bool limitWork);
 AspRunResult AspExpandDictionaryGroupArgument
     (AspEngine *, AspDataEntry *argumentList, const AspDataEntry *dictionary);
 AspRunResult AspCallFunction
     (AspEngine *, AspDataEntry *function, AspDataEntry *argumentList,
      bool fromApp);
+AspRunResult AspCallFunctionPositional
+    (AspEngine *, AspDataEntry *function, uint32_t argumentCount);
 AspRunResult AspReturnToCaller(AspEngine *);
+AspRunResult AspLoadAppFunctionParameters
+    (AspEngine *, AspDataEntry *function);
+AspDataEntry *AspLocalNamespace(AspEngine *);
 
 #ifdef __cplusplus
 }
@@ -3,6 +3,7 @@
  */
 
 #include "iterator.h"
+#include "function.h"
 #include "range.h"
 #include "sequence.h"
 #include "tree.h"
@@ -101,14 +102,12 @@ AspIteratorResult AspIteratorCreate
             /* Create an integer set to the start value. */
             if (!atEnd)
             {
-                AspDataEntry *value = AspAllocEntry
-                    (engine, DataType_Integer);
+                AspDataEntry *value = AspNewInteger(engine, initialValue);
                 if (value == 0)
                 {
                     result.result = AspRunResult_OutOfDataMemory;
                     break;
                 }
-                AspDataSetInteger(value, initialValue);
                 AspDataSetIteratorMemberNeedsCleanup(iterator, true);
                 member = value;
             }
@@ -144,7 +143,12 @@ AspIteratorResult AspIteratorCreate
             iterable =
                 iterableType == DataType_Module ?
                 AspEntry(engine, AspDataGetModuleNamespaceIndex(iterable)) :
-                engine->localNamespace;
+                AspLocalNamespace(engine);
+            if (iterable == 0)
+            {
+                result.result = AspRunResult_OutOfDataMemory;
+                break;
+            }
 
             /* Store the underlying namespace for local scope iterators so that
                it can be checked later. */
@@ -268,11 +272,9 @@ AspRunResult AspIteratorNext
             }
             else
             {
-                AspDataEntry *value = AspAllocEntry
-                    (engine, DataType_Integer);
+                AspDataEntry *value = AspNewInteger(engine, newValue);
                 if (value == 0)
                     return AspRunResult_OutOfDataMemory;
-                AspDataSetInteger(value, newValue);
                 member = value;
             }
 
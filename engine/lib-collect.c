@@ -9,6 +9,8 @@
 
 static AspRunResult FillSequence
     (AspEngine *, AspDataEntry *sequence, AspDataEntry *iterable);
+static AspRunResult AppendString
+    (AspEngine *, AspDataEntry *str, const AspDataEntry *source);
 
 /* tuple(x)
  * Convert the iterable to a tuple.
@@ -59,6 +61,62 @@ ASP_LIB_API AspRunResult AspLib_list
     return FillSequence(engine, *returnValue, iterable);
 }
 
+/* join(separator, iterable)
+ * Concatenate the strings produced by the iterable, separated by the given
+ * separator string.
+ */
+ASP_LIB_API AspRunResult AspLib_join
+    (AspEngine *engine,
+     AspDataEntry *separator, AspDataEntry *iterable,
+     AspDataEntry **returnValue)
+{
+    if (!AspIsString(separator))
+        return AspRunResult_UnexpectedType;
+
+    *returnValue = AspNewString(engine, 0, 0);
+    if (*returnValue == 0)
+        return AspRunResult_OutOfDataMemory;
+
+    AspIteratorResult iteratorResult = AspIteratorCreate
+        (engine, iterable, false);
+    if (iteratorResult.result != AspRunResult_OK)
+        return iteratorResult.result;
+    AspDataEntry *iterator = iteratorResult.value;
+
+    uint32_t iterationCount = 0;
+    for (; iterationCount < engine->cycleDetectionLimit; iterationCount++)
+    {
+        iteratorResult = AspIteratorDereference(engine, iterator);
+        if (iteratorResult.result == AspRunResult_IteratorAtEnd)
+            break;
+        if (iteratorResult.result != AspRunResult_OK)
+            return iteratorResult.result;
+        AspDataEntry *value = iteratorResult.value;
+        if (!AspIsString(value))
+            return AspRunResult_UnexpectedType;
+
+        /* Append the separator (if not first) and then the string. */
+        AspRunResult result = AspRunResult_OK;
+        if (iterationCount != 0)
+            result = AppendString(engine, *returnValue, separator);
+        if (result == AspRunResult_OK)
+            result = AppendString(engine, *returnValue, value);
+        if (result != AspRunResult_OK)
+            return result;
+        AspUnref(engine, value);
+
+        result = AspIteratorNext(engine, iterator);
+        if (result != AspRunResult_OK)
+            return result;
+    }
+    if (iterationCount >= engine->cycleDetectionLimit)
+        return AspRunResult_CycleDetected;
+
+    AspUnref(engine, iterator);
+
+    return AspRunResult_OK;
+}
+
 static AspRunResult FillSequence
     (AspEngine *engine, AspDataEntry *sequence, AspDataEntry *iterable)
 {
@@ -97,3 +155,30 @@ static AspRunResult FillSequence
 
     return AspRunResult_OK;
 }
+
+static AspRunResult AppendString
+    (AspEngine *engine, AspDataEntry *str, const AspDataEntry *source)
+{
+    /* Copy the source string a fragment at a time. */
+    uint32_t iterationCount = 0;
+    for (AspSequenceResult nextResult = AspSequenceNext
+            (engine, source, 0, true);
+         iterationCount < engine->cycleDetectionLimit &&
+         nextResult.element != 0;
+         iterationCount++,
+         nextResult = AspSequenceNext
+            (engine, source, nextResult.element, true))
+    {
+        const AspDataEntry *fragment = nextResult.value;
+        AspRunResult result = AspStringAppendBuffer
+            (engine, str,
+             AspDataGetStringFragmentData(fragment),
+             AspDataGetStringFragmentSize(fragment));
+        if (result != AspRunResult_OK)
+            return result;
+    }
+    if (iterationCount >= engine->cycleDetectionLimit)
+        return AspRunResult_CycleDetected;
+
+    return AspRunResult_OK;
+}
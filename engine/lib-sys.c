@@ -4,6 +4,7 @@
 
 #include "asp-priv.h"
 #include "tree.h"
+#include "slot.h"
 #include "data.h"
 #include <stdbool.h>
 #include <stdint.h>
@@ -33,16 +34,38 @@ ASP_LIB_API AspRunResult AspLib_exists
     if (!AspSymbolValue(symbol, &symbolValue))
         return AspRunResult_OK;
 
+    /* Check the local variable slots first, if any. A slot variable that
+       is not bound defers to the other namespaces. */
+    bool found = false;
+    if (engine->localSlots != 0)
+    {
+        uint8_t slot;
+        AspRunResult findResult = AspFindLocalSlot
+            (engine, engine->localSlots, symbolValue, &found, &slot);
+        if (findResult != AspRunResult_OK)
+            return findResult;
+        if (found)
+        {
+            AspDataEntry *value;
+            AspRunResult valueResult = AspLocalSlotValue
+                (engine, engine->localSlots, slot, &value);
+            if (valueResult != AspRunResult_OK)
+                return valueResult;
+            found = value != 0;
+        }
+    }
+
     AspDataEntry *namespaces[] =
     {
         engine->localNamespace,
         engine->globalNamespace,
         engine->systemNamespace,
     };
-    bool found = false;
     for (size_t i = namespaces[1] == namespaces[0] ? 1 : 0;
-         i < sizeof namespaces / sizeof *namespaces; i++)
+         !found && i < sizeof namespaces / sizeof *namespaces; i++)
     {
+        if (namespaces[i] == 0)
+            continue;
         AspTreeResult result = AspFindSymbol
             (engine, namespaces[i], symbolValue);
         if (result.result != AspRunResult_OK)
@@ -0,0 +1,81 @@
+/*
+ * Asp engine name lookup cache implementation.
+ *
+ * Each cache entry records the namespace node that an instruction, identified
+ * by its address, resolved a name to, starting from a given namespace. The
+ * entry for an instruction is chosen by its address and the kind of lookup
+ * alone, so a different instruction may later replace it. Entries become
+ * stale whenever a node is added to or removed from a namespace that is not
+ * a function's local namespace, which is tracked by a single version number.
+ */
+
+#include "lookup.h"
+#include "data.h"
+
+static AspDataEntry *CacheEntry(AspEngine *, bool address);
+
+void AspResetNameCache(AspEngine *engine)
+{
+    for (size_t i = 0; i < engine->nameCacheSize; i++)
+    {
+        AspDataEntry *entry = engine->nameCache + i;
+        memset(entry, 0, sizeof *entry);
+        AspDataSetType(entry, DataType_NameCacheEntry);
+    }
+    engine->namespaceVersion = 1;
+}
+
+void AspInvalidateNameCache(AspEngine *engine)
+{
+    /* Entries with a zero version are never valid. Clear all entries before
+       the version wraps around so that no stale entry becomes valid again. */
+    if (engine->namespaceVersion < AspWordMax)
+        engine->namespaceVersion++;
+    else
+        AspResetNameCache(engine);
+}
+
+AspDataEntry *AspFindCachedName
+    (AspEngine *engine, const AspDataEntry *ns, int32_t symbol, bool address)
+{
+    if (engine->nameCacheSize == 0)
+        return 0;
+
+    const AspDataEntry *entry = CacheEntry(engine, address);
+    if (AspDataGetNameCacheEntryVersion(entry) != engine->namespaceVersion ||
+        AspDataGetNameCacheEntryAddress(entry) !=
+            engine->instructionAddress ||
+        AspDataGetNameCacheEntryNamespaceIndex(entry) !=
+            AspIndex(engine, ns) ||
+        AspDataGetNameCacheEntryIsAddress(entry) != address)
+        return 0;
+
+    /* The same instruction may look up different names (e.g., when the
+       symbol comes from the stack), so check the node's symbol too. */
+    AspDataEntry *node = AspEntry
+        (engine, AspDataGetNameCacheEntryNodeIndex(entry));
+    return AspDataGetNamespaceNodeSymbol(node) == symbol ? node : 0;
+}
+
+void AspCacheName
+    (AspEngine *engine, const AspDataEntry *ns, const AspDataEntry *node,
+     bool address)
+{
+    if (engine->nameCacheSize == 0)
+        return;
+
+    AspDataEntry *entry = CacheEntry(engine, address);
+    AspDataSetNameCacheEntryAddress(entry, engine->instructionAddress);
+    AspDataSetNameCacheEntryNodeIndex(entry, AspIndex(engine, node));
+    AspDataSetNameCacheEntryVersion(entry, engine->namespaceVersion);
+    AspDataSetNameCacheEntryNamespaceIndex(entry, AspIndex(engine, ns));
+    AspDataSetNameCacheEntryIsAddress(entry, address);
+}
+
+static AspDataEntry *CacheEntry(AspEngine *engine, bool address)
+{
+    /* Instructions that update a variable look it up by both value and
+       address, so keep the two lookups in separate entries. */
+    size_t key = 2 * (size_t)engine->instructionAddress + (address ? 1 : 0);
+    return engine->nameCache + key % engine->nameCacheSize;
+}
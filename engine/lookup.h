@@ -0,0 +1,28 @@
+/*
+ * Asp engine name lookup cache definitions.
+ */
+
+#ifndef ASP_LOOKUP_H
+#define ASP_LOOKUP_H
+
+#include "asp-priv.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void AspResetNameCache(AspEngine *);
+void AspInvalidateNameCache(AspEngine *);
+AspDataEntry *AspFindCachedName
+    (AspEngine *, const AspDataEntry *ns, int32_t symbol, bool address);
+void AspCacheName
+    (AspEngine *, const AspDataEntry *ns, const AspDataEntry *node,
+     bool address);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -42,6 +42,34 @@ typedef enum OpCode
     OpCode_POP = 0x20, /* pop single entry */
     OpCode_POP1 = 0x21, /* pop N entries with 1-byte count */
 
+    /* Fused compare and jump operations. Each performs a comparison and then
+       jumps if the result is false, with an offset relative to the address
+       of the following instruction. Each group must be in the same order as
+       the corresponding comparison operations. */
+    OpCode_NEJF1 = 0x22, /* != and jump false with 1-byte offset */
+    OpCode_EQJF1 = 0x23, /* == and jump false with 1-byte offset */
+    OpCode_LTJF1 = 0x24, /* < and jump false with 1-byte offset */
+    OpCode_LEJF1 = 0x25, /* <= and jump false with 1-byte offset */
+    OpCode_GTJF1 = 0x26, /* > and jump false with 1-byte offset */
+    OpCode_GEJF1 = 0x27, /* >= and jump false with 1-byte offset */
+    OpCode_NEJF2 = 0x28, /* != and jump false with 2-byte offset */
+    OpCode_EQJF2 = 0x29, /* == and jump false with 2-byte offset */
+    OpCode_LTJF2 = 0x2A, /* < and jump false with 2-byte offset */
+    OpCode_LEJF2 = 0x2B, /* <= and jump false with 2-byte offset */
+    OpCode_GTJF2 = 0x2C, /* > and jump false with 2-byte offset */
+    OpCode_GEJF2 = 0x2D, /* >= and jump false with 2-byte offset */
+
+    /* Fused variable update operations. */
+    OpCode_SETP1 = 0x31, /* assign variable with 1-byte symbol with pop */
+    OpCode_SETP2 = 0x32, /* assign variable with 2-byte symbol with pop */
+    OpCode_SETP4 = 0x33, /* assign variable with 4-byte symbol with pop */
+    OpCode_ADDP1 = 0x35, /* add to variable with 1-byte symbol with pop */
+    OpCode_ADDP2 = 0x36, /* add to variable with 2-byte symbol with pop */
+    OpCode_ADDP4 = 0x37, /* add to variable with 4-byte symbol with pop */
+    OpCode_SUBP1 = 0x39, /* subtract from variable with 1-byte symbol, pop */
+    OpCode_SUBP2 = 0x3A, /* subtract from variable with 2-byte symbol, pop */
+    OpCode_SUBP4 = 0x3B, /* subtract from variable with 4-byte symbol, pop */
+
     /* Unary operations. */
     OpCode_LNOT = 0x40, /* logical not */
     OpCode_POS = 0x48, /* positive value */
@@ -75,6 +103,18 @@ typedef enum OpCode
     OpCode_IS = 0x69, /* is */
     OpCode_ORDER = 0x6C, /* object order */
 
+    /* Local variable slot operations. The SLOTS operand is a 1-byte slot
+       count followed by the 4-byte symbol of each slot's variable, and must
+       be the first instruction of a function that uses slots. The other
+       operands are a 1-byte index into the current function's slots. */
+    OpCode_SLOTS = 0x70, /* local slot symbol table */
+    OpCode_LDL = 0x71, /* load local's value */
+    OpCode_LDAL = 0x72, /* load local's address */
+    OpCode_SETL = 0x73, /* assign local with pop */
+    OpCode_ADDL = 0x74, /* add to local with pop */
+    OpCode_SUBL = 0x75, /* subtract from local with pop */
+    OpCode_DELL = 0x76, /* delete local */
+
     /* Load operations. */
     OpCode_LD = 0x80, /* load variable's value with symbol on the stack */
     OpCode_LD1 = 0x81, /* load variable's value with 1-byte symbol */
@@ -88,6 +128,7 @@ typedef enum OpCode
     /* Assignment and deletion operations. */
     OpCode_SET = 0x88, /* assign variable (no pop) */
     OpCode_SETP = 0x89, /* assign variable with pop */
+    OpCode_ADDSP = 0x8A, /* add and assign to address with pop */
     OpCode_ERASE = 0x8C, /* delete element or slice */
     OpCode_DEL1 = 0x8D, /* delete variable with 1-byte symbol */
     OpCode_DEL2 = 0x8E, /* delete variable with 2-byte symbol */
@@ -107,6 +148,20 @@ typedef enum OpCode
     OpCode_NITER = 0xA2, /* advance iterator to next */
     OpCode_DITER = 0xA3, /* dereference iterator */
 
+    /* Relative jump operations. Offsets are signed and relative to the
+       address of the following instruction. Each group must be in the same
+       order as the corresponding absolute jump operations. */
+    OpCode_JMPF1 = 0xA5, /* jump false with 1-byte offset */
+    OpCode_JMPT1 = 0xA6, /* jump true with 1-byte offset */
+    OpCode_JMP1 = 0xA7, /* unconditional jump with 1-byte offset */
+    OpCode_LOR1 = 0xA8, /* short-cut logical or with 1-byte offset */
+    OpCode_LAND1 = 0xA9, /* short-cut logical and with 1-byte offset */
+    OpCode_JMPF2 = 0xAA, /* jump false with 2-byte offset */
+    OpCode_JMPT2 = 0xAB, /* jump true with 2-byte offset */
+    OpCode_JMP2 = 0xAC, /* unconditional jump with 2-byte offset */
+    OpCode_LOR2 = 0xAD, /* short-cut logical or with 2-byte offset */
+    OpCode_LAND2 = 0xAE, /* short-cut logical and with 2-byte offset */
+
     /* Jump operations. */
     OpCode_NOOP = 0xB0, /* (never jump) */
     OpCode_JMPF = 0xB1, /* jump false */
@@ -118,6 +173,7 @@ typedef enum OpCode
     /* Function call/return operations. */
     OpCode_CALL = 0xB6, /* call function */
     OpCode_RET = 0xB7, /* return from function */
+    OpCode_CALL1 = 0xB8, /* call function with 1-byte positional count */
 
     /* Module operations. */
     OpCode_ADDMOD1 = 0xB9, /* add module with 1-byte symbol to engine */
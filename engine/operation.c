@@ -3,6 +3,7 @@
  */
 
 #include "operation.h"
+#include "function.h"
 #include "asp-priv.h"
 #include "opcode.h"
 #include "data.h"
@@ -31,6 +32,8 @@ static AspOperationResult PerformConcatenationBinaryOperation
 static AspOperationResult PerformRepetitionBinaryOperation
     (AspEngine *, uint8_t opCode,
      AspDataEntry *sequence, const AspDataEntry *repeatCount);
+static AspRunResult AppendSequence
+    (AspEngine *, AspDataEntry *sequence, const AspDataEntry *source);
 static AspOperationResult PerformFormatBinaryOperation
     (AspEngine *, uint8_t opCode,
      const AspDataEntry *format, const AspDataEntry *tuple);
@@ -332,6 +335,39 @@ AspOperationResult AspPerformBinaryOperation
     return result;
 }
 
+AspOperationResult AspPerformInPlaceBinaryOperation
+    (AspEngine *engine, uint8_t opCode,
+     AspDataEntry *left, const AspDataEntry *right)
+{
+    AspOperationResult result = {AspRunResult_OK, 0};
+
+    AspAssert
+        (engine, left != 0 && AspIsObject(left));
+    result.result = AspAssert
+        (engine, right != 0 && AspIsObject(right));
+    if (result.result != AspRunResult_OK)
+        return result;
+
+    /* Only concatenation of strings or lists is performed in place. For
+       anything else, leave the result value null so that the caller falls
+       back to the regular operation. The caller must hold the only
+       reference to the left operand, as the change is visible to any other
+       holder. */
+    uint8_t leftType = AspDataGetType(left);
+    if (opCode != OpCode_ADD || left == right ||
+        leftType != AspDataGetType(right) ||
+        (leftType != DataType_String && leftType != DataType_List))
+        return result;
+
+    result.result = AppendSequence(engine, left, right);
+    if (result.result != AspRunResult_OK)
+        return result;
+
+    AspRef(engine, left);
+    result.value = left;
+    return result;
+}
+
 static AspOperationResult PerformBitwiseBinaryOperation
     (AspEngine *engine, uint8_t opCode,
      const AspDataEntry *left, const AspDataEntry *right)
@@ -448,44 +484,10 @@ static AspOperationResult PerformConcatenationBinaryOperation
             if (result.value == 0)
                 break;
 
-            AspSequenceResult appendResult = {AspRunResult_OK, 0, 0};
-            const AspDataEntry *operands[] = {left, right};
-            for (unsigned i = 0; i < sizeof operands / sizeof *operands; i++)
-            {
-                AspSequenceResult nextResult = AspSequenceNext
-                    (engine, operands[i], 0, true);
-                uint32_t iterationCount = 0;
-                for (;
-                     iterationCount < engine->cycleDetectionLimit &&
-                     nextResult.element != 0;
-                     iterationCount++,
-                     nextResult = AspSequenceNext
-                        (engine, operands[i], nextResult.element, true))
-                {
-                    AspDataEntry *value = nextResult.value;
-
-                    if (leftType == DataType_String)
-                        appendResult.result = AspStringAppendBuffer
-                            (engine, result.value,
-                             AspDataGetStringFragmentData(value),
-                             AspDataGetStringFragmentSize(value));
-                    else
-                        appendResult = AspSequenceAppend
-                            (engine, result.value, value);
-                    if (appendResult.result != AspRunResult_OK)
-                    {
-                        result.result = appendResult.result;
-                        break;
-                    }
-                }
-                if (result.result != AspRunResult_OK)
-                    break;
-                if (iterationCount >= engine->cycleDetectionLimit)
-                {
-                    result.result = AspRunResult_CycleDetected;
-                    break;
-                }
-            }
+            result.result = AppendSequence(engine, result.value, left);
+            if (result.result != AspRunResult_OK)
+                break;
+            result.result = AppendSequence(engine, result.value, right);
 
             break;
         }
@@ -546,24 +548,53 @@ static AspOperationResult PerformRepetitionBinaryOperation
                 break;
             }
 
-            result.value = AspAllocEntry(engine, sequenceType);
+            /* Continue a repetition begun in an earlier step if applicable.
+               Otherwise, start with an empty sequence. */
+            int32_t i = 0;
+            AspDataEntry *element = 0;
+            uint32_t iterationCount = 0;
+            if (engine->resumeValue != 0)
+            {
+                result.value = engine->resumeValue;
+                engine->resumeValue = 0;
+                i = (int32_t)engine->resumeCount;
+                element = AspEntry(engine, engine->resumeElementIndex);
+                iterationCount = engine->resumeIterationCount;
+            }
+            else
+                result.value = AspAllocEntry(engine, sequenceType);
             if (result.value == 0)
                 break;
 
             AspSequenceResult appendResult = {AspRunResult_OK, 0, 0};
+            uint32_t workCount = 0;
             if (count != 0)
             {
-                for (int32_t i = 0; i < repeatCountValue; i++)
+                for (; i < repeatCountValue; i++, iterationCount = 0)
                 {
-                    uint32_t iterationCount = 0;
                     for (AspSequenceResult nextResult = AspSequenceNext
-                            (engine, sequence, 0, true);
+                            (engine, sequence, element, true);
                          iterationCount < engine->cycleDetectionLimit &&
                          nextResult.element != 0;
                          iterationCount++,
                          nextResult = AspSequenceNext
                             (engine, sequence, nextResult.element, true))
                     {
+                        /* Suspend the operation once the work limit has
+                           been reached, saving the progress made. */
+                        if (engine->workLimit != 0 &&
+                            workCount++ >= engine->workLimit)
+                        {
+                            engine->resumeValue = result.value;
+                            engine->resumeCount = (uint32_t)i;
+                            engine->resumeElementIndex =
+                                AspIndex(engine, element);
+                            engine->resumeIterationCount = iterationCount;
+                            result.result = AspRunResult_Again;
+                            result.value = 0;
+                            return result;
+                        }
+
                         AspDataEntry *value = nextResult.value;
 
                         if (sequenceType == DataType_String)
@@ -579,7 +610,9 @@ static AspOperationResult PerformRepetitionBinaryOperation
                             result.result = appendResult.result;
                             break;
                         }
+                        element = nextResult.element;
                     }
+                    element = 0;
                     if (result.result != AspRunResult_OK)
                         break;
                     if (iterationCount >= engine->cycleDetectionLimit)
@@ -773,7 +806,24 @@ static AspOperationResult PerformFormatBinaryOperation
 {
     AspOperationResult result = {AspRunResult_OK, 0};
 
-    result.value = AspAllocEntry(engine, DataType_String);
+    /* Continue formatting begun in an earlier step if applicable.
+       Otherwise, start with an empty string. */
+    AspSequenceResult nextValueResult = {AspRunResult_OK, 0, 0};
+    AspDataEntry *previousElement = 0;
+    uint8_t startIndex = 0;
+    uint32_t iterationCount = 0;
+    if (engine->resumeValue != 0)
+    {
+        result.value = engine->resumeValue;
+        engine->resumeValue = 0;
+        previousElement = AspEntry(engine, engine->resumeElementIndex);
+        startIndex = (uint8_t)engine->resumeCount;
+        nextValueResult.element = AspEntry
+            (engine, engine->resumeItemIndex);
+        iterationCount = engine->resumeIterationCount;
+    }
+    else
+        result.value = AspAllocEntry(engine, DataType_String);
     if (result.value == 0)
     {
         result.result = AspRunResult_OutOfDataMemory;
@@ -781,14 +831,14 @@ static AspOperationResult PerformFormatBinaryOperation
     }
 
     /* Scan format string and convert fields. */
-    AspSequenceResult nextValueResult = {AspRunResult_OK, 0, 0};
     char formatBuffer[31], *fp = 0, formattedValueBuffer[61];
-    uint32_t iterationCount = 0;
+    uint32_t workCount = 0;
     for (AspSequenceResult nextResult = AspSequenceNext
-            (engine, format, 0, true);
+            (engine, format, previousElement, true);
          iterationCount < engine->cycleDetectionLimit &&
          nextResult.element != 0;
          iterationCount++,
+         previousElement = nextResult.element,
          nextResult = AspSequenceNext
             (engine, format, nextResult.element, true))
     {
@@ -798,13 +848,30 @@ static AspOperationResult PerformFormatBinaryOperation
         const char *fragmentData =
             AspDataGetStringFragmentData(fragment);
 
-        for (uint8_t fragmentIndex = 0;
+        for (uint8_t fragmentIndex = startIndex;
              fragmentIndex < fragmentSize;
              fragmentIndex++)
         {
             char c = fragmentData[fragmentIndex];
             if (fp == 0)
             {
+                /* Suspend the operation between fields once the work limit
+                   has been reached, saving the progress made. */
+                if (engine->workLimit != 0 &&
+                    workCount++ >= engine->workLimit)
+                {
+                    engine->resumeValue = result.value;
+                    engine->resumeElementIndex =
+                        AspIndex(engine, previousElement);
+                    engine->resumeCount = fragmentIndex;
+                    engine->resumeItemIndex =
+                        AspIndex(engine, nextValueResult.element);
+                    engine->resumeIterationCount = iterationCount;
+                    result.result = AspRunResult_Again;
+                    result.value = 0;
+                    return result;
+                }
+
                 /* Process non-format character. */
                 if (c == '%')
                 {
@@ -1145,6 +1212,7 @@ static AspOperationResult PerformFormatBinaryOperation
                 fp = 0;
             }
         }
+        startIndex = 0;
     }
     if (iterationCount >= engine->cycleDetectionLimit)
     {
@@ -1413,7 +1481,12 @@ static AspOperationResult PerformMembershipOperation
                 rightType == DataType_Module ?
                 AspValueEntry
                     (engine, AspDataGetModuleNamespaceIndex(right)) :
-                engine->localNamespace;
+                AspLocalNamespace(engine);
+            if (ns == 0)
+            {
+                result.result = AspRunResult_OutOfDataMemory;
+                break;
+            }
             if (AspDataGetType(ns) != DataType_Namespace)
             {
                 result.result = AspRunResult_InternalError;
@@ -1513,3 +1586,42 @@ static AspOperationResult PerformObjectOrderOperation
 
     return result;
 }
+
+static AspRunResult AppendSequence
+    (AspEngine *engine, AspDataEntry *sequence, const AspDataEntry *source)
+{
+    bool isString = AspDataGetType(sequence) == DataType_String;
+
+    AspSequenceResult nextResult = AspSequenceNext(engine, source, 0, true);
+    uint32_t iterationCount = 0;
+    for (;
+         iterationCount < engine->cycleDetectionLimit &&
+         nextResult.element != 0;
+         iterationCount++,
+         nextResult = AspSequenceNext
+            (engine, source, nextResult.element, true))
+    {
+        AspDataEntry *value = nextResult.value;
+
+        if (isString)
+        {
+            AspRunResult appendResult = AspStringAppendBuffer
+                (engine, sequence,
+                 AspDataGetStringFragmentData(value),
+                 AspDataGetStringFragmentSize(value));
+            if (appendResult != AspRunResult_OK)
+                return appendResult;
+        }
+        else
+        {
+            AspSequenceResult appendResult = AspSequenceAppend
+                (engine, sequence, value);
+            if (appendResult.result != AspRunResult_OK)
+                return appendResult.result;
+        }
+    }
+    if (iterationCount >= engine->cycleDetectionLimit)
+        return AspRunResult_CycleDetected;
+
+    return AspRunResult_OK;
+}
@@ -4,10 +4,14 @@
 
 #include "asp.h"
 #include "data.h"
-#include "stack.h"
+#include "cycle.h"
 #include "sequence.h"
 #include "tree.h"
 
+static void Release(AspEngine *, AspDataEntry *);
+static void Destroy(AspEngine *, AspDataEntry *);
+static AspRunResult DestroyStep(AspEngine *, AspDataEntry *);
+static bool HasContents(const AspDataEntry *);
 static bool IsTerminal(const AspDataEntry *);
 
 void AspRef(AspEngine *engine, AspDataEntry *entry)
@@ -22,260 +26,375 @@ void AspUnref(AspEngine *engine, AspDataEntry *entry)
     if (engine->runResult != AspRunResult_OK)
         return;
 
-    /* Avoid recursion by using the engine's stack. */
-    const AspDataEntry *startStackTop = engine->stackTop;
-    uint32_t iterationCount = 0;
-    for (; iterationCount < engine->cycleDetectionLimit; iterationCount++)
+    Release(engine, entry);
+
+    /* Destroy queued objects, either in full or up to the configured limit.
+       Releases made while already doing so are left for the loop in
+       progress. */
+    if (engine->garbageIndex != 0 && !engine->collecting)
+        AspCollect(engine, engine->collectLimit);
+}
+
+bool AspCollect(AspEngine *engine, uint32_t limit)
+{
+    if (engine->collecting)
+        return engine->garbageIndex == 0;
+
+    /* Avoid recursion by working from the garbage queue. Each unit of work
+       frees at least one entry, so a limit of zero (no limit) still
+       ends. */
+    engine->collecting = true;
+    for (uint32_t count = 0;
+         (limit == 0 || count < limit) &&
+         engine->garbageIndex != 0 &&
+         engine->runResult == AspRunResult_OK;
+         count++)
     {
-        AspRunResult assertResult = AspAssert(engine, entry != 0);
-        if (assertResult != AspRunResult_OK)
-            return;
-        if (AspIsObject(entry))
-            AspDataSetUseCount(entry, AspDataGetUseCount(entry) - 1U);
-        if (!AspIsObject(entry) || AspDataGetUseCount(entry) == 0)
+        AspRunResult destroyResult = DestroyStep
+            (engine, AspEntry(engine, engine->garbageIndex));
+        if (destroyResult != AspRunResult_OK)
         {
-            uint8_t t = AspDataGetType(entry);
-            if (t == DataType_Boolean)
-            {
-                AspDataEntry **singleton =
-                    AspDataGetBoolean(entry) ?
-                    &engine->trueSingleton : &engine->falseSingleton;
-                *singleton = 0;
-            }
-            else if (t == DataType_Ellipsis)
-            {
-                engine->ellipsisSingleton = 0;
-            }
-            else if (t == DataType_Range)
-            {
-                if (AspDataGetRangeHasStart(entry))
-                    AspUnref(engine, AspValueEntry(engine,
-                        AspDataGetRangeStartIndex(entry)));
+            engine->runResult = destroyResult;
+            break;
+        }
+    }
+    engine->collecting = false;
 
-                if (AspDataGetRangeHasEnd(entry))
-                    AspUnref(engine, AspValueEntry(engine,
-                        AspDataGetRangeEndIndex(entry)));
+    return engine->garbageIndex == 0;
+}
 
-                if (AspDataGetRangeHasStep(entry))
-                    AspUnref(engine, AspValueEntry(engine,
-                        AspDataGetRangeStepIndex(entry)));
-            }
-            else if (t == DataType_String ||
-                     t == DataType_Tuple || t == DataType_List ||
-                     t == DataType_ParameterList || t == DataType_ArgumentList)
-            {
-                AspSequenceResult nextResult = {AspRunResult_OK, 0, 0};
-                uint32_t iterationCount = 0;
-                for (;
-                     iterationCount < engine->cycleDetectionLimit &&
-                     (nextResult = AspSequenceNext
-                        (engine, entry, 0, true)).element != 0;
-                     iterationCount++)
-                {
-                    assertResult = AspAssert
-                        (engine,
-                         AspDataGetType(nextResult.element)
-                         == DataType_Element);
-                    if (assertResult != AspRunResult_OK)
-                        break;
-
-                    bool eraseValue = IsTerminal(nextResult.value);
-                    bool eraseSuccess = AspSequenceEraseElement
-                        (engine, entry, nextResult.element, eraseValue);
-                    if (!eraseSuccess)
-                        break;
-
-                    /* Make sure not to free addresses (i.e., elements)
-                       within address sequences. */
-                    if (!eraseValue &&
-                        ((t != DataType_Tuple && t != DataType_List) ||
-                         AspIsObject(nextResult.value)))
-                        AspPushNoUse(engine, nextResult.value);
-                }
-                if (iterationCount >= engine->cycleDetectionLimit)
-                {
-                    engine->runResult = AspRunResult_CycleDetected;
-                    break;
-                }
-            }
-            else if (t == DataType_Set || t == DataType_Dictionary ||
-                     t == DataType_Namespace)
-            {
-                AspTreeResult nextResult = {AspRunResult_OK, 0, 0, 0, false};
-                uint32_t iterationCount = 0;
-                for (;
-                     iterationCount < engine->cycleDetectionLimit &&
-                     (nextResult =
-                        AspTreeNext(engine, entry, 0, true)).node != 0;
-                     iterationCount++)
-                {
-                    bool eraseKey =
-                        nextResult.key != 0 && IsTerminal(nextResult.key);
-                    bool eraseValue =
-                        nextResult.value != 0 &&
-                        IsTerminal(nextResult.value) &&
-                        AspIsObject(nextResult.value);
-                    AspRunResult eraseResult = AspTreeEraseNode
-                        (engine, entry, nextResult.node,
-                         eraseKey, eraseValue);
-                    if (eraseResult != AspRunResult_OK)
-                        break;
-
-                    bool pushKey = nextResult.key != 0 && !eraseKey;
-                    if (pushKey)
-                        AspPushNoUse(engine, nextResult.key);
-                    if (nextResult.value != 0 && !eraseValue &&
-                        AspIsObject(nextResult.value))
-                    {
-                        if (pushKey)
-                        {
-                            AspDataEntry *topEntry = engine->stackTop;
-                            AspDataSetStackEntryHasValue2(topEntry, true);
-                            AspDataSetStackEntryValue2Index
-                                (topEntry, AspIndex(engine, nextResult.value));
-                        }
-                        else
-                            AspPushNoUse(engine, nextResult.value);
-                    }
-                }
-                if (iterationCount >= engine->cycleDetectionLimit)
-                {
-                    engine->runResult = AspRunResult_CycleDetected;
-                    break;
-                }
-            }
-            else if (t == DataType_ForwardIterator ||
-                     t == DataType_ReverseIterator)
-            {
-                const AspDataEntry *iterable = AspValueEntry
-                    (engine, AspDataGetIteratorIterableIndex(entry));
-                AspPushNoUse(engine, iterable);
+AspRunResult AspReleaseMember
+    (AspEngine *engine, AspDataEntry *collection, bool *released)
+{
+    /* Release one member of a collection, if any remain. */
+    *released = false;
+    uint8_t t = AspDataGetType(collection);
+    if (t == DataType_String ||
+        t == DataType_Tuple || t == DataType_List ||
+        t == DataType_ParameterList || t == DataType_ArgumentList)
+    {
+        AspSequenceResult nextResult = AspSequenceNext
+            (engine, collection, 0, true);
+        if (nextResult.element == 0)
+            return AspRunResult_OK;
 
-                AspDataEntry *member = AspEntry
-                    (engine, AspDataGetIteratorMemberIndex(entry));
-                if (member != 0 && AspDataGetIteratorMemberNeedsCleanup(entry))
-                {
-                    if (IsTerminal(member))
-                        AspUnref(engine, member);
-                    else
-                        AspPushNoUse(engine, member);
-                }
-            }
-            else if (t == DataType_Function)
-            {
-                const AspDataEntry *module = AspValueEntry
-                    (engine, AspDataGetFunctionModuleIndex(entry));
-                AspPushNoUse(engine, module);
+        AspRunResult assertResult = AspAssert
+            (engine,
+             AspDataGetType(nextResult.element) == DataType_Element);
+        if (assertResult != AspRunResult_OK)
+            return assertResult;
 
-                const AspDataEntry *parameters = AspValueEntry
-                    (engine, AspDataGetFunctionParametersIndex(entry));
-                AspPushNoUse(engine, parameters);
-            }
-            else if (t == DataType_Module)
-            {
-                const AspDataEntry *ns = AspValueEntry
-                    (engine, AspDataGetModuleNamespaceIndex(entry));
-                AspPushNoUse(engine, ns);
-            }
-            else if (t == DataType_AppIntegerObject)
-            {
-                void (*destructor)(AspEngine *, int16_t, int32_t) =
-                    AspDataGetAppIntegerObjectDestructor(entry);
-                AspDataEntry *info = AspAppObjectInfoEntry(engine, entry);
-                if (destructor != 0 && info != 0)
-                {
-                    destructor
-                        (engine,
-                         AspDataGetAppObjectType(info),
-                         AspDataGetAppIntegerObjectValue(info));
-                }
-                if (info != entry)
-                    AspUnref(engine, info);
-            }
-            else if (t == DataType_AppPointerObject)
-            {
-                void (*destructor)(AspEngine *, int16_t, void *) =
-                    AspDataGetAppPointerObjectDestructor(entry);
-                AspDataEntry *info = AspAppObjectInfoEntry(engine, entry);
-                if (destructor != 0 && info != 0)
-                {
-                    destructor
-                        (engine,
-                         AspDataGetAppObjectType(info),
-                         AspDataGetAppPointerObjectValue(info));
-                }
-                if (info != entry)
-                    AspUnref(engine, info);
-            }
-            else if (t == DataType_Frame)
-            {
-                const AspDataEntry *module = AspValueEntry
-                    (engine, AspDataGetFrameModuleIndex(entry));
-                AspPushNoUse(engine, module);
-            }
-            else if (t == DataType_KeyValuePair)
-            {
-                AspDataEntry *key = AspValueEntry
-                    (engine, AspDataGetKeyValuePairKeyIndex(entry));
-                if (IsTerminal(key))
-                    AspUnref(engine, key);
-                else
-                    AspPushNoUse(engine, key);
+        bool eraseValue = IsTerminal(nextResult.value);
+        bool eraseSuccess = AspSequenceEraseElement
+            (engine, collection, nextResult.element, eraseValue);
+        if (!eraseSuccess)
+            return AspRunResult_InternalError;
 
-                AspDataEntry *value = AspValueEntry
-                    (engine, AspDataGetKeyValuePairValueIndex(entry));
-                if (IsTerminal(value))
-                    AspUnref(engine, value);
-                else
-                    AspPushNoUse(engine, value);
-            }
-            else if (t == DataType_Parameter)
+        /* Make sure not to free addresses (i.e., elements) within
+           address sequences. */
+        if (!eraseValue &&
+            ((t != DataType_Tuple && t != DataType_List) ||
+             AspIsObject(nextResult.value)))
+            Release(engine, nextResult.value);
+        *released = true;
+    }
+    else if (t == DataType_Set || t == DataType_Dictionary ||
+             t == DataType_Namespace)
+    {
+        AspTreeResult nextResult = AspTreeNext(engine, collection, 0, true);
+        if (nextResult.result != AspRunResult_OK)
+            return nextResult.result;
+        if (nextResult.node == 0)
+            return AspRunResult_OK;
+
+        bool eraseKey =
+            nextResult.key != 0 && IsTerminal(nextResult.key);
+        bool eraseValue =
+            nextResult.value != 0 &&
+            IsTerminal(nextResult.value) &&
+            AspIsObject(nextResult.value);
+        AspRunResult eraseResult = AspTreeEraseNode
+            (engine, collection, nextResult.node, eraseKey, eraseValue);
+        if (eraseResult != AspRunResult_OK)
+            return eraseResult;
+
+        if (nextResult.value != 0 && !eraseValue &&
+            AspIsObject(nextResult.value))
+            Release(engine, nextResult.value);
+        if (nextResult.key != 0 && !eraseKey)
+            Release(engine, nextResult.key);
+        *released = true;
+    }
+    else if (t == DataType_LocalSlots)
+    {
+        /* Release one slot value or free one emptied block, so that the
+           block tree is gone when nothing remains to be released. */
+        AspDataEntry *parent = 0;
+        unsigned parentIndex = 0;
+        AspDataEntry *block = AspEntry
+            (engine, AspDataGetLocalSlotsRootIndex(collection));
+        while (block != 0)
+        {
+            unsigned i = 0;
+            while (i < 4 && !AspDataGetSlotBlockIsBound(block, i))
+                i++;
+            if (i == 4)
             {
-                if (AspDataGetParameterHasDefault(entry))
+                if (parent == 0)
+                    AspDataSetLocalSlotsRootIndex(collection, 0);
+                else
                 {
-                    AspDataEntry *defaultValue = AspValueEntry
-                        (engine, AspDataGetParameterDefaultIndex(entry));
-                    if (IsTerminal(defaultValue))
-                        AspUnref(engine, defaultValue);
-                    else
-                        AspPushNoUse(engine, defaultValue);
+                    AspDataSetSlotBlockIndex(parent, parentIndex, 0);
+                    AspDataSetSlotBlockIsBound(parent, parentIndex, false);
                 }
+                AspFree(engine, AspIndex(engine, block));
+                *released = true;
+                break;
             }
-            else if (t == DataType_Argument)
+
+            AspDataEntry *child = AspValueEntry
+                (engine, AspDataGetSlotBlockIndex(block, i));
+            if (AspDataGetType(child) != DataType_SlotBlock)
             {
-                AspDataEntry *value = AspValueEntry
-                    (engine, AspDataGetArgumentValueIndex(entry));
-                if (IsTerminal(value))
-                    AspUnref(engine, value);
-                else
-                    AspPushNoUse(engine, value);
+                AspDataSetSlotBlockIndex(block, i, 0);
+                AspDataSetSlotBlockIsBound(block, i, false);
+                Release(engine, child);
+                *released = true;
+                break;
             }
 
-            /* Free the entry. */
-            if (t != DataType_Free)
-                AspFree(engine, AspIndex(engine, entry));
+            parent = block;
+            parentIndex = i;
+            block = child;
         }
+    }
 
-        /* Check if there's more to do. */
-        if (engine->stackTop == startStackTop ||
-            engine->runResult != AspRunResult_OK)
-            break;
+    return engine->runResult;
+}
+
+static void Release(AspEngine *engine, AspDataEntry *entry)
+{
+    AspRunResult assertResult = AspAssert(engine, entry != 0);
+    if (assertResult != AspRunResult_OK)
+        return;
+
+    /* Let a cycle collection pass in progress know that a reference to the
+       entry has been dropped. */
+    if (engine->cyclePhase == AspCyclePhase_Mark)
+        AspCycleShade(engine, entry);
 
-        /* Fetch the next item from the stack. */
-        entry = AspTopValue2(engine);
-        if (entry != 0)
+    if (AspIsObject(entry))
+    {
+        uint32_t useCount = AspDataGetUseCount(entry) - 1U;
+        AspDataSetUseCount(entry, useCount);
+        if (useCount != 0)
+            return;
+    }
+
+    if (!HasContents(entry))
+    {
+        Destroy(engine, entry);
+        return;
+    }
+
+    /* Queue the entry for its contents to be released later. */
+    if (engine->cyclePhase != AspCyclePhase_Idle)
+        AspCycleShade(engine, entry);
+    AspDataSetGarbageNext(entry, engine->garbageIndex);
+    engine->garbageIndex = AspIndex(engine, entry);
+}
+
+static void Destroy(AspEngine *engine, AspDataEntry *entry)
+{
+    uint8_t t = AspDataGetType(entry);
+    if (t == DataType_Boolean)
+    {
+        AspDataEntry **singleton =
+            AspDataGetBoolean(entry) ?
+            &engine->trueSingleton : &engine->falseSingleton;
+        *singleton = 0;
+    }
+    else if (t == DataType_Ellipsis)
+    {
+        engine->ellipsisSingleton = 0;
+    }
+    else if (t == DataType_Range)
+    {
+        /* Range components are terminal, so releasing them here does not
+           lead to further destruction. */
+        if (AspDataGetRangeHasStart(entry))
+            Release(engine, AspValueEntry(engine,
+                AspDataGetRangeStartIndex(entry)));
+
+        if (AspDataGetRangeHasEnd(entry))
+            Release(engine, AspValueEntry(engine,
+                AspDataGetRangeEndIndex(entry)));
+
+        if (AspDataGetRangeHasStep(entry))
+            Release(engine, AspValueEntry(engine,
+                AspDataGetRangeStepIndex(entry)));
+    }
+    else if (t == DataType_AppIntegerObject)
+    {
+        void (*destructor)(AspEngine *, int16_t, int32_t) =
+            AspDataGetAppIntegerObjectDestructor(entry);
+        AspDataEntry *info = AspAppObjectInfoEntry(engine, entry);
+        if (destructor != 0 && info != 0)
         {
-            AspDataSetStackEntryHasValue2(engine->stackTop, false);
-            AspDataSetStackEntryValue2Index(engine->stackTop, 0);
+            destructor
+                (engine,
+                 AspDataGetAppObjectType(info),
+                 AspDataGetAppIntegerObjectValue(info));
         }
-        else
+        if (info != entry)
+            Release(engine, info);
+    }
+    else if (t == DataType_AppPointerObject)
+    {
+        void (*destructor)(AspEngine *, int16_t, void *) =
+            AspDataGetAppPointerObjectDestructor(entry);
+        AspDataEntry *info = AspAppObjectInfoEntry(engine, entry);
+        if (destructor != 0 && info != 0)
         {
-            entry = AspTopValue(engine);
-            AspPopNoErase(engine);
+            destructor
+                (engine,
+                 AspDataGetAppObjectType(info),
+                 AspDataGetAppPointerObjectValue(info));
         }
+        if (info != entry)
+            Release(engine, info);
     }
-    if (iterationCount >= engine->cycleDetectionLimit)
-        engine->runResult = AspRunResult_CycleDetected;
+
+    /* Free the entry. */
+    if (t != DataType_Free)
+        AspFree(engine, AspIndex(engine, entry));
+}
+
+static AspRunResult DestroyStep(AspEngine *engine, AspDataEntry *entry)
+{
+    AspRunResult assertResult = AspAssert(engine, entry != 0);
+    if (assertResult != AspRunResult_OK)
+        return assertResult;
+
+    /* Release one member of a collection, leaving the collection queued
+       until it is empty. Other entries are destroyed in one step, after
+       being removed from the queue so that anything they release can be
+       queued in turn. */
+    bool released;
+    AspRunResult releaseResult = AspReleaseMember(engine, entry, &released);
+    if (releaseResult != AspRunResult_OK || released)
+        return releaseResult;
+
+    /* Remove the entry from the queue. */
+    assertResult = AspAssert
+        (engine, AspIndex(engine, entry) == engine->garbageIndex);
+    if (assertResult != AspRunResult_OK)
+        return assertResult;
+    engine->garbageIndex = AspDataGetGarbageNext(entry);
+
+    uint8_t t = AspDataGetType(entry);
+    if (t == DataType_ForwardIterator || t == DataType_ReverseIterator)
+    {
+        Release
+            (engine, AspValueEntry
+                (engine, AspDataGetIteratorIterableIndex(entry)));
+
+        AspDataEntry *member = AspEntry
+            (engine, AspDataGetIteratorMemberIndex(entry));
+        if (member != 0 && AspDataGetIteratorMemberNeedsCleanup(entry))
+            Release(engine, member);
+    }
+    else if (t == DataType_Function)
+    {
+        Release
+            (engine, AspValueEntry
+                (engine, AspDataGetFunctionModuleIndex(entry)));
+        if (!AspDataGetFunctionIsPending(entry))
+            Release
+                (engine, AspValueEntry
+                    (engine, AspDataGetFunctionParametersIndex(entry)));
+    }
+    else if (t == DataType_AppFunctionInfo)
+    {
+        if (!AspDataGetAppFunctionInfoIsPending(entry))
+            Release
+                (engine, AspEntry
+                    (engine,
+                     AspDataGetAppFunctionInfoParametersIndex(entry)));
+    }
+    else if (t == DataType_Module)
+    {
+        Release
+            (engine, AspValueEntry
+                (engine, AspDataGetModuleNamespaceIndex(entry)));
+    }
+    else if (t == DataType_Frame)
+    {
+        Release
+            (engine, AspValueEntry
+                (engine, AspDataGetFrameModuleIndex(entry)));
+    }
+    else if (t == DataType_KeyValuePair)
+    {
+        Release
+            (engine, AspValueEntry
+                (engine, AspDataGetKeyValuePairKeyIndex(entry)));
+        Release
+            (engine, AspValueEntry
+                (engine, AspDataGetKeyValuePairValueIndex(entry)));
+    }
+    else if (t == DataType_Parameter)
+    {
+        if (AspDataGetParameterHasDefault(entry))
+            Release
+                (engine, AspValueEntry
+                    (engine, AspDataGetParameterDefaultIndex(entry)));
+    }
+    else if (t == DataType_Argument)
+    {
+        Release
+            (engine, AspValueEntry
+                (engine, AspDataGetArgumentValueIndex(entry)));
+    }
+
+    /* Free the entry. */
+    AspFree(engine, AspIndex(engine, entry));
+    return engine->runResult;
+}
+
+static bool HasContents(const AspDataEntry *entry)
+{
+    /* Note that for each of these types, the field used to link the
+       garbage queue is either the use count or otherwise unused once the
+       entry is queued. */
+    static uint8_t contentTypes[] =
+    {
+        DataType_String,
+        DataType_Tuple,
+        DataType_List,
+        DataType_ParameterList,
+        DataType_ArgumentList,
+        DataType_Set,
+        DataType_Dictionary,
+        DataType_Namespace,
+        DataType_ForwardIterator,
+        DataType_ReverseIterator,
+        DataType_Function,
+        DataType_AppFunctionInfo,
+        DataType_Module,
+        DataType_Frame,
+        DataType_KeyValuePair,
+        DataType_Parameter,
+        DataType_Argument,
+        DataType_LocalSlots,
+    };
+
+    uint8_t t = AspDataGetType(entry);
+    for (unsigned i = 0; i < sizeof contentTypes / sizeof *contentTypes; i++)
+        if (t == contentTypes[i])
+            return true;
+
+    return false;
 }
 
 static bool IsTerminal(const AspDataEntry *entry)
@@ -293,6 +412,7 @@ static bool IsTerminal(const AspDataEntry *entry)
         DataType_AppIntegerObject,
         DataType_AppPointerObject,
         DataType_StringFragment,
+        DataType_SlotAddress,
     };
 
     uint8_t t = AspDataGetType(entry);
@@ -4,6 +4,7 @@
 
 #include "sequence.h"
 #include "data.h"
+#include "cycle.h"
 
 static bool IsSequenceType(DataType);
 static bool IsElementType(DataType);
@@ -157,6 +158,10 @@ bool AspSequenceEraseElement
     if (result != AspRunResult_OK)
         return false;
 
+    /* Keep a cycle collection pass in progress informed. */
+    if (engine->cyclePhase == AspCyclePhase_Mark)
+        AspCycleEraseMember(engine, sequence, element);
+
     /* Update links in adjacent elements. */
     uint32_t prevIndex = AspDataGetElementPreviousIndex(element);
     uint32_t nextIndex = AspDataGetElementNextIndex(element);
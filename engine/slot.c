@@ -0,0 +1,194 @@
+/*
+ * Asp engine local variable slot implementation.
+ *
+ * Slots hold the local variables of a script function whose symbols were
+ * resolved by the compiler. The values are kept in a tree of four-way blocks
+ * whose depth depends on the slot count, so that any slot is reached in at
+ * most four steps. Blocks are allocated only as slots are assigned.
+ */
+
+#include "slot.h"
+#include "code.h"
+#include "asp.h"
+#include "data.h"
+
+static unsigned SlotDepth(uint32_t count);
+static AspRunResult FindSlot
+    (AspEngine *, const AspDataEntry *slots, uint8_t slot, bool create,
+     AspDataEntry **block, unsigned *index);
+
+AspDataEntry *AspNewLocalSlots
+    (AspEngine *engine, uint32_t symbolsAddress, uint8_t count)
+{
+    AspDataEntry *slots = AspAllocEntry(engine, DataType_LocalSlots);
+    if (slots == 0)
+        return 0;
+    AspDataEntry *root = AspAllocEntry(engine, DataType_SlotBlock);
+    if (root == 0)
+        return 0;
+    AspDataSetLocalSlotsRootIndex(slots, AspIndex(engine, root));
+    AspDataSetLocalSlotsSymbolsAddress(slots, symbolsAddress);
+    AspDataSetLocalSlotsCount(slots, count);
+    return slots;
+}
+
+AspRunResult AspLocalSlotValue
+    (AspEngine *engine, const AspDataEntry *slots, uint8_t slot,
+     AspDataEntry **value)
+{
+    AspDataEntry *block;
+    unsigned index;
+    AspRunResult findResult = FindSlot
+        (engine, slots, slot, false, &block, &index);
+    if (findResult != AspRunResult_OK)
+        return findResult;
+
+    *value =
+        block == 0 || !AspDataGetSlotBlockIsBound(block, index) ? 0 :
+        AspValueEntry(engine, AspDataGetSlotBlockIndex(block, index));
+    return AspRunResult_OK;
+}
+
+AspRunResult AspAssignLocalSlot
+    (AspEngine *engine, AspDataEntry *slots, uint8_t slot,
+     AspDataEntry *value)
+{
+    AspDataEntry *block;
+    unsigned index;
+    AspRunResult findResult = FindSlot
+        (engine, slots, slot, true, &block, &index);
+    if (findResult != AspRunResult_OK)
+        return findResult;
+
+    AspDataEntry *oldValue =
+        AspDataGetSlotBlockIsBound(block, index) ?
+        AspValueEntry(engine, AspDataGetSlotBlockIndex(block, index)) : 0;
+    AspRef(engine, value);
+    AspDataSetSlotBlockIndex(block, index, AspIndex(engine, value));
+    AspDataSetSlotBlockIsBound(block, index, true);
+    if (oldValue != 0)
+        AspUnref(engine, oldValue);
+    return engine->runResult;
+}
+
+AspRunResult AspUnbindLocalSlot
+    (AspEngine *engine, AspDataEntry *slots, uint8_t slot, bool *wasBound)
+{
+    AspDataEntry *block;
+    unsigned index;
+    AspRunResult findResult = FindSlot
+        (engine, slots, slot, false, &block, &index);
+    if (findResult != AspRunResult_OK)
+        return findResult;
+
+    *wasBound = block != 0 && AspDataGetSlotBlockIsBound(block, index);
+    if (!*wasBound)
+        return AspRunResult_OK;
+
+    AspDataEntry *oldValue = AspValueEntry
+        (engine, AspDataGetSlotBlockIndex(block, index));
+    AspDataSetSlotBlockIndex(block, index, 0);
+    AspDataSetSlotBlockIsBound(block, index, false);
+    AspUnref(engine, oldValue);
+    return engine->runResult;
+}
+
+AspRunResult AspLocalSlotSymbol
+    (AspEngine *engine, const AspDataEntry *slots, uint8_t slot,
+     int32_t *symbol)
+{
+    if (slot >= AspDataGetLocalSlotsCount(slots))
+        return AspRunResult_ValueOutOfRange;
+
+    /* Read the symbol from the function's slot table in the code. */
+    uint8_t bytes[4];
+    AspRunResult loadResult = AspLoadCodeBytesAt
+        (engine, AspDataGetLocalSlotsSymbolsAddress(slots) + 4U * slot,
+         bytes, sizeof bytes);
+    if (loadResult != AspRunResult_OK)
+        return loadResult;
+    uint32_t value = 0;
+    for (unsigned i = 0; i < sizeof bytes; i++)
+        value = value << 8 | bytes[i];
+    *symbol = *(int32_t *)&value;
+    return AspRunResult_OK;
+}
+
+AspRunResult AspFindLocalSlot
+    (AspEngine *engine, const AspDataEntry *slots, int32_t symbol,
+     bool *found, uint8_t *slot)
+{
+    *found = false;
+    uint32_t count = AspDataGetLocalSlotsCount(slots);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        int32_t slotSymbol;
+        AspRunResult symbolResult = AspLocalSlotSymbol
+            (engine, slots, (uint8_t)i, &slotSymbol);
+        if (symbolResult != AspRunResult_OK)
+            return symbolResult;
+        if (slotSymbol == symbol)
+        {
+            *found = true;
+            *slot = (uint8_t)i;
+            break;
+        }
+    }
+
+    return AspRunResult_OK;
+}
+
+static unsigned SlotDepth(uint32_t count)
+{
+    unsigned depth = 1;
+    while (depth < 4 && count > 1U << 2 * depth)
+        depth++;
+    return depth;
+}
+
+/* Locates the leaf block and index of the given slot. If the leaf block does
+   not exist, it is created if requested, otherwise a null block results. */
+static AspRunResult FindSlot
+    (AspEngine *engine, const AspDataEntry *slots, uint8_t slot, bool create,
+     AspDataEntry **block, unsigned *index)
+{
+    AspRunResult assertResult = AspAssert
+        (engine,
+         slots != 0 && AspDataGetType(slots) == DataType_LocalSlots);
+    if (assertResult != AspRunResult_OK)
+        return assertResult;
+    uint32_t count = AspDataGetLocalSlotsCount(slots);
+    if (slot >= count)
+        return AspRunResult_ValueOutOfRange;
+
+    /* Descend through any interior blocks to the leaf block. */
+    AspDataEntry *currentBlock = AspEntry
+        (engine, AspDataGetLocalSlotsRootIndex(slots));
+    for (unsigned level = SlotDepth(count) - 1; level > 0; level--)
+    {
+        unsigned childIndex = (unsigned)slot >> 2 * level & 3U;
+        if (AspDataGetSlotBlockIsBound(currentBlock, childIndex))
+        {
+            currentBlock = AspEntry
+                (engine, AspDataGetSlotBlockIndex(currentBlock, childIndex));
+            continue;
+        }
+
+        if (!create)
+        {
+            currentBlock = 0;
+            break;
+        }
+        AspDataEntry *child = AspAllocEntry(engine, DataType_SlotBlock);
+        if (child == 0)
+            return AspRunResult_OutOfDataMemory;
+        AspDataSetSlotBlockIndex
+            (currentBlock, childIndex, AspIndex(engine, child));
+        AspDataSetSlotBlockIsBound(currentBlock, childIndex, true);
+        currentBlock = child;
+    }
+
+    *block = currentBlock;
+    *index = (unsigned)slot & 3U;
+    return AspRunResult_OK;
+}
@@ -0,0 +1,35 @@
+/*
+ * Asp engine local variable slot definitions.
+ */
+
+#ifndef ASP_SLOT_H
+#define ASP_SLOT_H
+
+#include "asp-priv.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+AspDataEntry *AspNewLocalSlots
+    (AspEngine *, uint32_t symbolsAddress, uint8_t count);
+AspRunResult AspLocalSlotValue
+    (AspEngine *, const AspDataEntry *slots, uint8_t slot,
+     AspDataEntry **value);
+AspRunResult AspAssignLocalSlot
+    (AspEngine *, AspDataEntry *slots, uint8_t slot, AspDataEntry *value);
+AspRunResult AspUnbindLocalSlot
+    (AspEngine *, AspDataEntry *slots, uint8_t slot, bool *wasBound);
+AspRunResult AspLocalSlotSymbol
+    (AspEngine *, const AspDataEntry *slots, uint8_t slot, int32_t *symbol);
+AspRunResult AspFindLocalSlot
+    (AspEngine *, const AspDataEntry *slots, int32_t symbol,
+     bool *found, uint8_t *slot);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,507 @@
+/*
+ * Asp engine snapshot and clone implementation.
+ *
+ * A snapshot is an image of the run state of an engine: the data entries
+ * in use, the fixed regions that follow them, and the engine fields that
+ * refer to them. Since data entries refer to each other by index, and the
+ * engine's own references are saved as indices too, the image does not
+ * depend on where the data area is located. It can be restored into the
+ * same engine or into another one configured the same way and loaded with
+ * the same executable, which allows an application to run a script's
+ * initialization once and then start from the resulting state as many
+ * times as needed.
+ *
+ * The image consists of a header followed by the data entries below the
+ * high-water index, then the stack, name cache and constant cache regions,
+ * and finally the used part of the cycle collection mark map if a pass is
+ * in progress. The header identifies the executable by its version, app
+ * spec check value, code size and code check value, so snapshots can only
+ * be taken of engines whose code is resident, not paged.
+ *
+ * A clone is a copy of an engine made directly into another data area,
+ * without an intermediate image. It shares the code and pre-decoded
+ * instructions of its source, which are only ever read while running, so
+ * any number of clones may run in parallel from the same starting state.
+ *
+ * Application objects are saved and cloned as they are, so the values they
+ * hold and their destructors must remain valid for every copy.
+ */
+
+#include "asp-priv.h"
+#include "data.h"
+#include <string.h>
+
+typedef struct SnapshotHeader
+{
+    /* Identification. */
+    uint8_t signature[4];
+    uint8_t version[4];
+    uint32_t checkValue;
+    size_t codeSize;
+    uint32_t codeCheckValue;
+
+    /* Configuration, which must match that of the restoring engine. */
+    size_t entrySize, dataEndIndex;
+    size_t stackDepth, nameCacheSize;
+    int32_t integerCacheMin;
+    size_t integerCacheSize, stringCacheSize;
+    size_t cycleMarkWordCount;
+
+    /* Run state. Entry references are held as indices. */
+    AspEngineState state;
+    uint32_t pc;
+    size_t freeCount, lowFreeCount;
+    uint32_t freeListIndex, highWaterIndex;
+    uint32_t ellipsisSingleton, falseSingleton, trueSingleton;
+    uint32_t stackTop;
+    unsigned stackCount;
+    uint32_t namespaceVersion;
+    uint32_t garbageIndex;
+    uint32_t resumeValue, resumeElementIndex, resumeItemIndex;
+    uint32_t resumeCount, resumeIterationCount;
+    size_t cycleTriggerCount;
+    AspCyclePhase cyclePhase;
+    uint32_t cycleIndex;
+    uint32_t cycleScanEntry, cycleScanMember;
+    uint32_t cycleStack[AspCycleStackCount];
+    unsigned cycleStackCount;
+    uint32_t modules, systemModule, module;
+    uint32_t systemNamespace, globalNamespace, localNamespace;
+    uint32_t localSlots;
+    bool again, callFromApp, callReturning;
+    uint32_t argumentList;
+    uint32_t appFunction, appFunctionNamespace, appFunctionReturnValue;
+    uint32_t appFunctionSlots;
+    int32_t nextSymbol;
+} SnapshotHeader;
+
+static size_t RegionEntryCount(const AspEngine *);
+static bool ValidHeader(const AspEngine *, const SnapshotHeader *);
+static bool ValidEntry
+    (const AspEngine *, const SnapshotHeader *, uint32_t index,
+     bool optional);
+static size_t MarkWordCount(const AspEngine *, AspCyclePhase, uint32_t);
+static uint32_t SaveEntry(const AspEngine *, const AspDataEntry *);
+static AspDataEntry *LoadEntry(AspEngine *, uint32_t);
+static AspDataEntry *Relocate
+    (AspEngine *, const AspEngine *source, const AspDataEntry *);
+
+static const uint8_t Signature[4] = {'A', 's', 'p', 'S'};
+static const uint32_t NullIndex = UINT32_MAX;
+
+size_t AspSnapshotSize(const AspEngine *engine)
+{
+    return
+        sizeof(SnapshotHeader) +
+        (engine->highWaterIndex + RegionEntryCount(engine)) *
+            sizeof(AspDataEntry) +
+        2 * MarkWordCount
+            (engine, engine->cyclePhase, engine->highWaterIndex) *
+            sizeof(uint32_t);
+}
+
+AspRunResult AspSnapshot
+    (const AspEngine *engine, void *buffer, size_t bufferSize)
+{
+    /* Snapshots may only be taken between instructions of a program that
+       has not yet run into an error, is not waiting to be woken, and whose
+       code is resident so that it can be identified. */
+    if (engine->inApp || engine->waiting ||
+        engine->runResult != AspRunResult_OK ||
+        (engine->state != AspEngineState_Ready &&
+         engine->state != AspEngineState_Running) ||
+        engine->cachedCodePageCount != 0)
+        return AspRunResult_InvalidState;
+    if (bufferSize < AspSnapshotSize(engine))
+        return AspRunResult_ValueOutOfRange;
+
+    SnapshotHeader header;
+    memset(&header, 0, sizeof header);
+    memcpy(header.signature, Signature, sizeof header.signature);
+    memcpy(header.version, engine->version, sizeof header.version);
+    header.checkValue = engine->appSpec->checkValue;
+    header.codeSize = engine->codeEndIndex;
+    header.codeCheckValue = engine->codeCheckValue;
+    header.entrySize = sizeof(AspDataEntry);
+    header.dataEndIndex = engine->dataEndIndex;
+    header.stackDepth = engine->stackDepth;
+    header.nameCacheSize = engine->nameCacheSize;
+    header.integerCacheMin = engine->integerCacheMin;
+    header.integerCacheSize = engine->integerCacheSize;
+    header.stringCacheSize = engine->stringCacheSize;
+    header.cycleMarkWordCount = engine->cycleMarkWordCount;
+
+    header.state = engine->state;
+    header.pc = engine->pc;
+    header.freeCount = engine->freeCount;
+    header.lowFreeCount = engine->lowFreeCount;
+    header.freeListIndex = engine->freeListIndex;
+    header.highWaterIndex = engine->highWaterIndex;
+    header.ellipsisSingleton = SaveEntry(engine, engine->ellipsisSingleton);
+    header.falseSingleton = SaveEntry(engine, engine->falseSingleton);
+    header.trueSingleton = SaveEntry(engine, engine->trueSingleton);
+    header.stackTop = SaveEntry(engine, engine->stackTop);
+    header.stackCount = engine->stackCount;
+    header.namespaceVersion = engine->namespaceVersion;
+    header.garbageIndex = engine->garbageIndex;
+    header.resumeValue = SaveEntry(engine, engine->resumeValue);
+    header.resumeElementIndex = engine->resumeElementIndex;
+    header.resumeItemIndex = engine->resumeItemIndex;
+    header.resumeCount = engine->resumeCount;
+    header.resumeIterationCount = engine->resumeIterationCount;
+    header.cycleTriggerCount = engine->cycleTriggerCount;
+    header.cyclePhase = engine->cyclePhase;
+    header.cycleIndex = engine->cycleIndex;
+    header.cycleScanEntry = SaveEntry(engine, engine->cycleScanEntry);
+    header.cycleScanMember = SaveEntry(engine, engine->cycleScanMember);
+    memcpy
+        (header.cycleStack, engine->cycleStack, sizeof header.cycleStack);
+    header.cycleStackCount = engine->cycleStackCount;
+    header.modules = SaveEntry(engine, engine->modules);
+    header.systemModule = SaveEntry(engine, engine->systemModule);
+    header.module = SaveEntry(engine, engine->module);
+    header.systemNamespace = SaveEntry(engine, engine->systemNamespace);
+    header.globalNamespace = SaveEntry(engine, engine->globalNamespace);
+    header.localNamespace = SaveEntry(engine, engine->localNamespace);
+    header.localSlots = SaveEntry(engine, engine->localSlots);
+    header.again = engine->again;
+    header.callFromApp = engine->callFromApp;
+    header.callReturning = engine->callReturning;
+    header.argumentList = SaveEntry(engine, engine->argumentList);
+    header.appFunction = SaveEntry(engine, engine->appFunction);
+    header.appFunctionNamespace = SaveEntry
+        (engine, engine->appFunctionNamespace);
+    header.appFunctionReturnValue = SaveEntry
+        (engine, engine->appFunctionReturnValue);
+    header.appFunctionSlots = SaveEntry(engine, engine->appFunctionSlots);
+    header.nextSymbol = engine->nextSymbol;
+
+    uint8_t *image = (uint8_t *)buffer;
+    memcpy(image, &header, sizeof header);
+    image += sizeof header;
+    size_t dataSize = engine->highWaterIndex * sizeof(AspDataEntry);
+    memcpy(image, engine->data, dataSize);
+    image += dataSize;
+    size_t regionSize = RegionEntryCount(engine) * sizeof(AspDataEntry);
+    memcpy(image, engine->data + engine->dataEndIndex, regionSize);
+    image += regionSize;
+    size_t markSize = MarkWordCount
+        (engine, engine->cyclePhase, engine->highWaterIndex) *
+        sizeof(uint32_t);
+    if (markSize != 0)
+    {
+        memcpy(image, engine->cycleMarks, markSize);
+        image += markSize;
+        memcpy
+            (image, engine->cycleMarks + engine->cycleMarkWordCount,
+             markSize);
+    }
+
+    return AspRunResult_OK;
+}
+
+AspRunResult AspRestore
+    (AspEngine *engine, const void *buffer, size_t bufferSize)
+{
+    /* The executable must already be loaded and resident. */
+    if (engine->inApp ||
+        (engine->state != AspEngineState_Ready &&
+         engine->state != AspEngineState_Running &&
+         engine->state != AspEngineState_RunError &&
+         engine->state != AspEngineState_Ended) ||
+        engine->cachedCodePageCount != 0)
+        return AspRunResult_InvalidState;
+
+    SnapshotHeader header;
+    if (bufferSize < sizeof header)
+        return AspRunResult_ValueOutOfRange;
+    const uint8_t *image = (const uint8_t *)buffer;
+    memcpy(&header, image, sizeof header);
+    image += sizeof header;
+    if (memcmp(header.signature, Signature, sizeof header.signature) != 0 ||
+        header.highWaterIndex > header.dataEndIndex)
+        return AspRunResult_ValueOutOfRange;
+
+    /* Ensure the image was taken with the same executable and with the
+       data area laid out the same way. */
+    if (memcmp(header.version, engine->version, sizeof header.version) != 0 ||
+        header.checkValue != engine->appSpec->checkValue ||
+        header.codeSize != engine->codeEndIndex ||
+        header.codeCheckValue != engine->codeCheckValue)
+        return AspRunResult_InvalidContext;
+    if (header.entrySize != sizeof(AspDataEntry) ||
+        header.dataEndIndex != engine->dataEndIndex ||
+        header.stackDepth != engine->stackDepth ||
+        header.nameCacheSize != engine->nameCacheSize ||
+        header.integerCacheMin != engine->integerCacheMin ||
+        header.integerCacheSize != engine->integerCacheSize ||
+        header.stringCacheSize != engine->stringCacheSize ||
+        header.cycleMarkWordCount != engine->cycleMarkWordCount)
+        return AspRunResult_InitializationError;
+
+    /* Ensure the run state refers only to code and entries within the
+       restored image before anything is overwritten. */
+    if (!ValidHeader(engine, &header))
+        return AspRunResult_ValueOutOfRange;
+
+    size_t dataSize = header.highWaterIndex * sizeof(AspDataEntry);
+    size_t regionSize = RegionEntryCount(engine) * sizeof(AspDataEntry);
+    size_t markSize = MarkWordCount
+        (engine, header.cyclePhase, header.highWaterIndex) *
+        sizeof(uint32_t);
+    if (bufferSize < sizeof header + dataSize + regionSize + 2 * markSize)
+        return AspRunResult_ValueOutOfRange;
+
+    memcpy(engine->data, image, dataSize);
+    image += dataSize;
+    memcpy(engine->data + engine->dataEndIndex, image, regionSize);
+    image += regionSize;
+    if (markSize != 0)
+    {
+        memcpy(engine->cycleMarks, image, markSize);
+        image += markSize;
+        memcpy
+            (engine->cycleMarks + engine->cycleMarkWordCount, image,
+             markSize);
+    }
+
+    engine->state = header.state;
+    engine->runResult = AspRunResult_OK;
+    engine->pc = engine->instructionAddress = header.pc;
+    engine->decodedInstruction = 0;
+    engine->nextDecodedInstruction = engine->decodedCode;
+    engine->decodedOperandIndex = 0;
+    engine->freeCount = header.freeCount;
+    engine->lowFreeCount = header.lowFreeCount;
+    engine->freeListIndex = header.freeListIndex;
+    engine->highWaterIndex = header.highWaterIndex;
+    engine->noneSingleton = engine->data;
+    engine->ellipsisSingleton = LoadEntry(engine, header.ellipsisSingleton);
+    engine->falseSingleton = LoadEntry(engine, header.falseSingleton);
+    engine->trueSingleton = LoadEntry(engine, header.trueSingleton);
+    engine->stackTop = LoadEntry(engine, header.stackTop);
+    engine->stackCount = header.stackCount;
+    engine->traversalPairCount = 0;
+    engine->namespaceVersion = header.namespaceVersion;
+    engine->garbageIndex = header.garbageIndex;
+    engine->collecting = false;
+    engine->resumeValue = LoadEntry(engine, header.resumeValue);
+    engine->resumeElementIndex = header.resumeElementIndex;
+    engine->resumeItemIndex = header.resumeItemIndex;
+    engine->resumeCount = header.resumeCount;
+    engine->resumeIterationCount = header.resumeIterationCount;
+    engine->cycleTriggerCount = header.cycleTriggerCount;
+    engine->cyclePhase = header.cyclePhase;
+    engine->cycleIndex = header.cycleIndex;
+    engine->cycleScanEntry = LoadEntry(engine, header.cycleScanEntry);
+    engine->cycleScanMember = LoadEntry(engine, header.cycleScanMember);
+    memcpy
+        (engine->cycleStack, header.cycleStack, sizeof engine->cycleStack);
+    engine->cycleStackCount = header.cycleStackCount;
+    engine->modules = LoadEntry(engine, header.modules);
+    engine->systemModule = LoadEntry(engine, header.systemModule);
+    engine->module = LoadEntry(engine, header.module);
+    engine->systemNamespace = LoadEntry(engine, header.systemNamespace);
+    engine->globalNamespace = LoadEntry(engine, header.globalNamespace);
+    engine->localNamespace = LoadEntry(engine, header.localNamespace);
+    engine->localSlots = LoadEntry(engine, header.localSlots);
+    engine->again = header.again;
+    engine->callFromApp = header.callFromApp;
+    engine->callReturning = header.callReturning;
+    engine->waiting = false;
+    engine->waitToken = 0;
+    engine->argumentList = LoadEntry(engine, header.argumentList);
+    engine->appFunction = LoadEntry(engine, header.appFunction);
+    engine->appFunctionNamespace = LoadEntry
+        (engine, header.appFunctionNamespace);
+    engine->appFunctionReturnValue = LoadEntry
+        (engine, header.appFunctionReturnValue);
+    engine->appFunctionSlots = LoadEntry(engine, header.appFunctionSlots);
+    engine->nextSymbol = header.nextSymbol;
+
+    return AspRunResult_OK;
+}
+
+AspRunResult AspClone
+    (AspEngine *engine, const AspEngine *source,
+     void *data, size_t dataSize, void *context)
+{
+    /* The code must have been sealed in place by AspSealCode so that it
+       lies outside the source engine, where a later reset of the source
+       cannot disturb the clones that share it. */
+    if (source->inApp || source->waiting ||
+        source->runResult != AspRunResult_OK ||
+        (source->state != AspEngineState_Ready &&
+         source->state != AspEngineState_Running) ||
+        source->cachedCodePageCount != 0 ||
+        source->code == source->codeArea)
+        return AspRunResult_InvalidState;
+
+    /* Entries refer to each other by index, and some refer to entries in
+       the fixed regions, so the clone's data area is laid out exactly like
+       that of its source. */
+    if (engine == source || data == 0 || dataSize < source->maxDataSize)
+        return AspRunResult_InitializationError;
+
+    *engine = *source;
+    engine->context = context;
+    engine->codeArea = 0;
+    engine->maxCodeSize = 0;
+    engine->data = (AspDataEntry *)data;
+    engine->noneSingleton = engine->data;
+    engine->ellipsisSingleton = Relocate
+        (engine, source, source->ellipsisSingleton);
+    engine->falseSingleton = Relocate
+        (engine, source, source->falseSingleton);
+    engine->trueSingleton = Relocate(engine, source, source->trueSingleton);
+    engine->stackTop = Relocate(engine, source, source->stackTop);
+    engine->stackBase = Relocate(engine, source, source->stackBase);
+    engine->nameCache = Relocate(engine, source, source->nameCache);
+    engine->integerCache = Relocate(engine, source, source->integerCache);
+    engine->stringCache = Relocate(engine, source, source->stringCache);
+    engine->resumeValue = Relocate(engine, source, source->resumeValue);
+    engine->cycleMarks = source->cycleMarks == 0 ? 0 :
+        (uint32_t *)((uint8_t *)data +
+            ((const uint8_t *)source->cycleMarks -
+             (const uint8_t *)source->data));
+    engine->cycleScanEntry = Relocate
+        (engine, source, source->cycleScanEntry);
+    engine->cycleScanMember = Relocate
+        (engine, source, source->cycleScanMember);
+    engine->modules = Relocate(engine, source, source->modules);
+    engine->systemModule = Relocate(engine, source, source->systemModule);
+    engine->module = Relocate(engine, source, source->module);
+    engine->systemNamespace = Relocate
+        (engine, source, source->systemNamespace);
+    engine->globalNamespace = Relocate
+        (engine, source, source->globalNamespace);
+    engine->localNamespace = Relocate
+        (engine, source, source->localNamespace);
+    engine->localSlots = Relocate(engine, source, source->localSlots);
+    engine->argumentList = Relocate(engine, source, source->argumentList);
+    engine->appFunction = Relocate(engine, source, source->appFunction);
+    engine->appFunctionNamespace = Relocate
+        (engine, source, source->appFunctionNamespace);
+    engine->appFunctionReturnValue = Relocate
+        (engine, source, source->appFunctionReturnValue);
+    engine->appFunctionSlots = Relocate
+        (engine, source, source->appFunctionSlots);
+
+    memcpy
+        (engine->data, source->data,
+         source->highWaterIndex * sizeof(AspDataEntry));
+    memcpy
+        (engine->data + engine->dataEndIndex,
+         source->data + source->dataEndIndex,
+         RegionEntryCount(source) * sizeof(AspDataEntry));
+    size_t markSize = MarkWordCount
+        (source, source->cyclePhase, source->highWaterIndex) *
+        sizeof(uint32_t);
+    if (markSize != 0)
+    {
+        memcpy(engine->cycleMarks, source->cycleMarks, markSize);
+        memcpy
+            (engine->cycleMarks + engine->cycleMarkWordCount,
+             source->cycleMarks + source->cycleMarkWordCount, markSize);
+    }
+
+    return AspRunResult_OK;
+}
+
+static size_t RegionEntryCount(const AspEngine *engine)
+{
+    return
+        engine->stackDepth + engine->nameCacheSize +
+        engine->integerCacheSize + engine->stringCacheSize;
+}
+
+static bool ValidHeader
+    (const AspEngine *engine, const SnapshotHeader *header)
+{
+    if (header->state != AspEngineState_Ready &&
+        header->state != AspEngineState_Running ||
+        header->pc > engine->codeEndIndex ||
+        header->freeCount > header->dataEndIndex ||
+        header->lowFreeCount > header->freeCount ||
+        header->freeListIndex >= header->highWaterIndex &&
+        header->freeListIndex != 0 ||
+        header->garbageIndex >= header->highWaterIndex &&
+        header->garbageIndex != 0 ||
+        header->cyclePhase != AspCyclePhase_Idle &&
+        header->cyclePhase != AspCyclePhase_Mark &&
+        header->cyclePhase != AspCyclePhase_Count &&
+        header->cyclePhase != AspCyclePhase_Clear ||
+        header->cycleStackCount > AspCycleStackCount)
+        return false;
+
+    /* The modules and the system and global namespaces always exist.
+       Other entry references, including those to singletons, which are
+       created on first use, and to the local namespace of a function that
+       uses slots, which is created only if needed, are present only in some
+       states. */
+    const uint32_t requiredEntries[] =
+    {
+        header->modules, header->systemModule, header->module,
+        header->systemNamespace, header->globalNamespace,
+    };
+    for (unsigned i = 0;
+         i < sizeof requiredEntries / sizeof *requiredEntries; i++)
+        if (!ValidEntry(engine, header, requiredEntries[i], false))
+            return false;
+    const uint32_t optionalEntries[] =
+    {
+        header->ellipsisSingleton, header->falseSingleton,
+        header->trueSingleton,
+        header->stackTop, header->localNamespace, header->localSlots,
+        header->resumeValue,
+        header->cycleScanEntry, header->cycleScanMember,
+        header->argumentList, header->appFunction,
+        header->appFunctionNamespace, header->appFunctionReturnValue,
+        header->appFunctionSlots,
+    };
+    for (unsigned i = 0;
+         i < sizeof optionalEntries / sizeof *optionalEntries; i++)
+        if (!ValidEntry(engine, header, optionalEntries[i], true))
+            return false;
+
+    return true;
+}
+
+static bool ValidEntry
+    (const AspEngine *engine, const SnapshotHeader *header, uint32_t index,
+     bool optional)
+{
+    /* References may be to used data entries or to entries of the fixed
+       regions that follow the data area. */
+    if (index == NullIndex)
+        return optional;
+    return
+        index < header->highWaterIndex ||
+        index >= header->dataEndIndex &&
+        index - header->dataEndIndex < RegionEntryCount(engine);
+}
+
+static size_t MarkWordCount
+    (const AspEngine *engine, AspCyclePhase phase, uint32_t highWaterIndex)
+{
+    /* Marks are only meaningful while a pass is in progress, and then only
+       for entries that have been used. */
+    return engine->cycleMarks == 0 || phase == AspCyclePhase_Idle ?
+        0 : (highWaterIndex + 31U) / 32U;
+}
+
+static uint32_t SaveEntry(const AspEngine *engine, const AspDataEntry *entry)
+{
+    return entry == 0 ? NullIndex : AspIndex(engine, entry);
+}
+
+static AspDataEntry *LoadEntry(AspEngine *engine, uint32_t index)
+{
+    return index == NullIndex ? 0 : engine->data + index;
+}
+
+static AspDataEntry *Relocate
+    (AspEngine *engine, const AspEngine *source, const AspDataEntry *entry)
+{
+    return entry == 0 ? 0 : engine->data + (entry - source->data);
+}
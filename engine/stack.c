@@ -27,9 +27,27 @@ static AspDataEntry *Push(AspEngine *engine, AspDataEntry *value, bool use)
     if (assertResult != AspRunResult_OK)
         return 0;
 
-    AspDataEntry *newTopEntry = AspAllocEntry(engine, DataType_StackEntry);
-    if (newTopEntry == 0)
-        return 0;
+    AspDataEntry *newTopEntry;
+    if (engine->stackBase != 0)
+    {
+        /* Use the next entry of the fixed stack region. Its type is set
+           when the region is initialized, so only the flags need
+           clearing. */
+        if (engine->stackCount >= engine->stackDepth)
+        {
+            engine->runResult = AspRunResult_StackOverflow;
+            return 0;
+        }
+        newTopEntry = engine->stackBase + engine->stackCount;
+        AspDataSetStackEntryHasValue2(newTopEntry, false);
+        AspDataSetStackEntryFlag(newTopEntry, false);
+    }
+    else
+    {
+        newTopEntry = AspAllocEntry(engine, DataType_StackEntry);
+        if (newTopEntry == 0)
+            return 0;
+    }
     AspDataSetStackEntryPreviousIndex(newTopEntry,
         engine->stackTop == 0 ? 0 : AspIndex(engine, engine->stackTop));
     AspDataSetStackEntryValueIndex(newTopEntry, AspIndex(engine, value));
@@ -91,6 +109,35 @@ bool AspPopNoErase(AspEngine *engine)
     return Pop(engine, false);
 }
 
+bool AspPushPair
+    (AspEngine *engine, const AspDataEntry *left, const AspDataEntry *right)
+{
+    /* The worklist is of fixed size so that traversals never allocate.
+       Nesting that is too deep to fit is reported by the caller. */
+    if (engine->traversalPairCount >= AspTraversalPairCount)
+        return false;
+
+    AspTraversalPair *pair =
+        engine->traversalPairs + engine->traversalPairCount++;
+    pair->leftIndex = AspIndex(engine, left);
+    pair->rightIndex = AspIndex(engine, right);
+    return true;
+}
+
+bool AspPopPair
+    (AspEngine *engine, const AspDataEntry **left, const AspDataEntry **right)
+{
+    AspRunResult assertResult = AspAssert
+        (engine, engine->traversalPairCount > 0);
+    if (assertResult != AspRunResult_OK)
+        return false;
+    const AspTraversalPair *pair =
+        engine->traversalPairs + --engine->traversalPairCount;
+    *left = AspValueEntry(engine, pair->leftIndex);
+    *right = AspValueEntry(engine, pair->rightIndex);
+    return true;
+}
+
 static bool Pop(AspEngine *engine, bool eraseValue)
 {
     if (engine->stackTop == 0)
@@ -106,10 +153,17 @@ static bool Pop(AspEngine *engine, bool eraseValue)
     if (eraseValue && AspIsObject(value))
         AspUnref(engine, value);
 
+    engine->stackCount--;
+    if (engine->stackBase != 0)
+    {
+        engine->stackTop = engine->stackCount == 0 ?
+            0 : engine->stackBase + engine->stackCount - 1;
+        return true;
+    }
+
     uint32_t prevIndex = AspDataGetStackEntryPreviousIndex(engine->stackTop);
     AspUnref(engine, engine->stackTop);
     engine->stackTop = prevIndex == 0 ? 0 : AspEntry(engine, prevIndex);
-    engine->stackCount--;
 
     return true;
 }
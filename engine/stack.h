@@ -18,6 +18,10 @@ AspDataEntry *AspTopValue(AspEngine *);
 AspDataEntry *AspTopValue2(AspEngine *);
 bool AspPop(AspEngine *);
 bool AspPopNoErase(AspEngine *);
+bool AspPushPair
+    (AspEngine *, const AspDataEntry *left, const AspDataEntry *right);
+bool AspPopPair
+    (AspEngine *, const AspDataEntry **left, const AspDataEntry **right);
 
 #ifdef __cplusplus
 }
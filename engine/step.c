@@ -13,8 +13,12 @@
 #include "iterator.h"
 #include "assign.h"
 #include "function.h"
+#include "slot.h"
 #include "operation.h"
 #include "symbols.h"
+#include "lookup.h"
+#include "constant.h"
+#include "cycle.h"
 #include <string.h>
 #include <stdint.h>
 
@@ -24,7 +28,43 @@
 #include <ctype.h>
 #endif
 
-static AspRunResult Step(AspEngine *);
+/* Threaded dispatch relies on the labels as values extension supported by
+   GCC and compatible compilers. Other compilers use the portable switch. */
+#if defined ASP_THREADED_DISPATCH && !defined __GNUC__
+#undef ASP_THREADED_DISPATCH
+#endif
+
+/* Instruction dispatch. With the portable switch statement, each call to Step
+   executes a single instruction. With threaded dispatch, each instruction
+   handler fetches the next instruction and jumps directly to its handler,
+   so Step continues executing instructions until the step count limit is
+   reached or the caller needs to intervene. */
+#ifdef ASP_THREADED_DISPATCH
+#define OP_CASE(name) op_##name: case OpCode_##name
+#define OP_DEFAULT op_INVALID: default
+#define DISPATCH_NEXT \
+    if (*stepCount >= stepCountLimit || \
+        engine->runResult != AspRunResult_OK || engine->again) \
+        break; \
+    else \
+    { \
+        opCodeResult = FetchInstruction(engine, stepCount, &opCode); \
+        if (opCodeResult != AspRunResult_OK) \
+            return opCodeResult; \
+        operandSize = 0; \
+        goto *dispatchTable[opCode]; \
+    }
+#else
+#define OP_CASE(name) case OpCode_##name
+#define OP_DEFAULT default
+#define DISPATCH_NEXT break
+#endif
+
+static AspRunResult Step
+    (AspEngine *, uint32_t stepCountLimit, uint32_t *stepCount);
+static AspRunResult FetchInstruction
+    (AspEngine *, uint32_t *stepCount, uint8_t *opCode);
+static void ExecuteAgain(AspEngine *);
 static AspRunResult LoadUnsignedWordOperand
     (AspEngine *engine, unsigned operandSize, uint32_t *operand);
 static AspRunResult LoadSignedWordOperand
@@ -35,6 +75,16 @@ static AspRunResult LoadSignedOperand
     (AspEngine *, unsigned operandSize, int32_t *operand);
 static AspRunResult LoadFloatOperand
     (AspEngine *, double *operand);
+static AspRunResult LoadCodeAddressOperand
+    (AspEngine *, unsigned operandSize, uint32_t *codeAddress);
+static AspRunResult LoadVariable
+    (AspEngine *, int32_t symbol, AspDataEntry **value);
+static AspRunResult LoadVariableAddress
+    (AspEngine *, int32_t symbol, AspDataEntry **node);
+static AspRunResult LoadSlotOperand
+    (AspEngine *, uint8_t *slot);
+static AspRunResult LoadSlotVariable
+    (AspEngine *, uint8_t slot, AspDataEntry **value);
 
 #ifdef ASP_DEBUG
 typedef struct
@@ -55,6 +105,8 @@ AspRunResult AspStep(AspEngine *engine)
         engine->state = AspEngineState_Running;
     if (engine->state != AspEngineState_Running)
         return AspRunResult_InvalidState;
+    if (engine->waiting)
+        return AspRunResult_Wait;
 
     if (engine->runResult == AspRunResult_OK)
     {
@@ -62,7 +114,8 @@ AspRunResult AspStep(AspEngine *engine)
            run result can be set via a return value (normal) or directly by
            the code (some low-level routines). Direct updates take
            precedence as they indicate a sort of failed assertion. */
-        AspRunResult stepResult = Step(engine);
+        uint32_t stepCount = 0;
+        AspRunResult stepResult = Step(engine, 1, &stepCount);
         if (engine->runResult == AspRunResult_OK)
             engine->runResult = stepResult;
         if (engine->runResult != AspRunResult_OK &&
@@ -73,33 +126,297 @@ AspRunResult AspStep(AspEngine *engine)
         }
     }
 
-    return engine->runResult;
+    return
+        engine->runResult == AspRunResult_OK && engine->waiting ?
+        AspRunResult_Wait : engine->runResult;
 }
 
-static AspRunResult Step(AspEngine *engine)
+AspRunResult AspRun(AspEngine *engine, uint32_t stepCountLimit)
 {
-    #ifdef ASP_DEBUG
-    fprintf
-        (engine->traceFile, "@0x%07zX: ",
-         AspProgramCounter(engine));
+    return AspRunFor(engine, stepCountLimit, 0);
+}
+
+AspRunResult AspRunFor
+    (AspEngine *engine, uint32_t stepCountLimit, uint32_t *stepCount)
+{
+    if (stepCount != 0)
+        *stepCount = 0;
+    if (engine->inApp)
+        return AspRunResult_InvalidState;
+    if (engine->state == AspEngineState_Ready)
+        engine->state = AspEngineState_Running;
+    if (engine->state != AspEngineState_Running)
+        return AspRunResult_InvalidState;
+    if (engine->waiting)
+        return AspRunResult_Wait;
+
+    /* Execute instructions until the step count limit is reached, an error
+       occurs, the program ends, or an application function requests to be
+       called again (e.g., to wait for something). In the latter case, control
+       is returned to the application so it can service the request before
+       resuming. The same precedence rules as for AspStep apply to the run
+       result. Note that depending on the dispatch method, each call to Step
+       may execute one or more instructions. */
+    uint32_t count = 0;
+    while (count < stepCountLimit && engine->runResult == AspRunResult_OK)
+    {
+        AspRunResult stepResult = Step(engine, stepCountLimit, &count);
+        if (engine->runResult == AspRunResult_OK)
+            engine->runResult = stepResult;
+        if (engine->again)
+            break;
+    }
+    if (engine->runResult != AspRunResult_OK &&
+        engine->state != AspEngineState_Ended)
+    {
+        engine->pc = engine->instructionAddress;
+        engine->state = AspEngineState_RunError;
+    }
+
+    if (stepCount != 0)
+        *stepCount = count;
+    return
+        engine->runResult == AspRunResult_OK && engine->waiting ?
+        AspRunResult_Wait : engine->runResult;
+}
+
+AspRunResult AspWake(AspEngine *engine, void *token, AspRunResult result)
+{
+    if (engine->inApp || !engine->waiting ||
+        engine->state != AspEngineState_Running)
+        return AspRunResult_InvalidState;
+    if (token != engine->waitToken)
+        return AspRunResult_InvalidContext;
+    if (result == AspRunResult_Complete ||
+        result == AspRunResult_Wait ||
+        result == AspRunResult_Again ||
+        result == AspRunResult_Call)
+        return AspRunResult_ValueOutOfRange;
+
+    engine->waiting = false;
+    engine->waitToken = 0;
+
+    /* On success, the waiting application function is called again the
+       next time the engine is stepped, allowing it to complete. Otherwise,
+       the function call fails with the given result. */
+    if (result != AspRunResult_OK)
+    {
+        engine->again = false;
+        engine->runResult = result;
+        engine->pc = engine->instructionAddress;
+        engine->state = AspEngineState_RunError;
+    }
+
+    return AspRunResult_OK;
+}
+
+#ifdef ASP_THREADED_DISPATCH
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+#ifdef __clang__
+#pragma clang diagnostic ignored "-Winitializer-overrides"
+#endif
+#endif
+
+static AspRunResult Step
+    (AspEngine *engine, uint32_t stepCountLimit, uint32_t *stepCount)
+{
+    #ifdef ASP_THREADED_DISPATCH
+    static const void *const dispatchTable[256] =
+    {
+        [0 ... 255] = &&op_INVALID,
+        [OpCode_PUSHN] = &&op_PUSHN,
+        [OpCode_PUSHE] = &&op_PUSHE,
+        [OpCode_PUSHF] = &&op_PUSHF,
+        [OpCode_PUSHT] = &&op_PUSHT,
+        [OpCode_PUSHI4] = &&op_PUSHI4,
+        [OpCode_PUSHI2] = &&op_PUSHI2,
+        [OpCode_PUSHI1] = &&op_PUSHI1,
+        [OpCode_PUSHI0] = &&op_PUSHI0,
+        [OpCode_PUSHD] = &&op_PUSHD,
+        [OpCode_PUSHY4] = &&op_PUSHY4,
+        [OpCode_PUSHY2] = &&op_PUSHY2,
+        [OpCode_PUSHY1] = &&op_PUSHY1,
+        [OpCode_PUSHS4] = &&op_PUSHS4,
+        [OpCode_PUSHS2] = &&op_PUSHS2,
+        [OpCode_PUSHS1] = &&op_PUSHS1,
+        [OpCode_PUSHS0] = &&op_PUSHS0,
+        [OpCode_PUSHTU] = &&op_PUSHTU,
+        [OpCode_PUSHLI] = &&op_PUSHLI,
+        [OpCode_PUSHSE] = &&op_PUSHSE,
+        [OpCode_PUSHDI] = &&op_PUSHDI,
+        [OpCode_PUSHAL] = &&op_PUSHAL,
+        [OpCode_PUSHPL] = &&op_PUSHPL,
+        [OpCode_PUSHCA] = &&op_PUSHCA,
+        [OpCode_PUSHM4] = &&op_PUSHM4,
+        [OpCode_PUSHM2] = &&op_PUSHM2,
+        [OpCode_PUSHM1] = &&op_PUSHM1,
+        [OpCode_POP1] = &&op_POP1,
+        [OpCode_POP] = &&op_POP,
+        [OpCode_LNOT] = &&op_LNOT,
+        [OpCode_POS] = &&op_POS,
+        [OpCode_NEG] = &&op_NEG,
+        [OpCode_NOT] = &&op_NOT,
+        [OpCode_OR] = &&op_OR,
+        [OpCode_XOR] = &&op_XOR,
+        [OpCode_AND] = &&op_AND,
+        [OpCode_LSH] = &&op_LSH,
+        [OpCode_RSH] = &&op_RSH,
+        [OpCode_ADD] = &&op_ADD,
+        [OpCode_SUB] = &&op_SUB,
+        [OpCode_MUL] = &&op_MUL,
+        [OpCode_DIV] = &&op_DIV,
+        [OpCode_FDIV] = &&op_FDIV,
+        [OpCode_MOD] = &&op_MOD,
+        [OpCode_POW] = &&op_POW,
+        [OpCode_NE] = &&op_NE,
+        [OpCode_EQ] = &&op_EQ,
+        [OpCode_LT] = &&op_LT,
+        [OpCode_LE] = &&op_LE,
+        [OpCode_GT] = &&op_GT,
+        [OpCode_GE] = &&op_GE,
+        [OpCode_NIN] = &&op_NIN,
+        [OpCode_IN] = &&op_IN,
+        [OpCode_NIS] = &&op_NIS,
+        [OpCode_IS] = &&op_IS,
+        [OpCode_ORDER] = &&op_ORDER,
+        [OpCode_SLOTS] = &&op_SLOTS,
+        [OpCode_LDL] = &&op_LDL,
+        [OpCode_LDAL] = &&op_LDAL,
+        [OpCode_SETL] = &&op_SETL,
+        [OpCode_ADDL] = &&op_ADDL,
+        [OpCode_SUBL] = &&op_SUBL,
+        [OpCode_DELL] = &&op_DELL,
+        [OpCode_LD4] = &&op_LD4,
+        [OpCode_LD2] = &&op_LD2,
+        [OpCode_LD1] = &&op_LD1,
+        [OpCode_LD] = &&op_LD,
+        [OpCode_LDA4] = &&op_LDA4,
+        [OpCode_LDA2] = &&op_LDA2,
+        [OpCode_LDA1] = &&op_LDA1,
+        [OpCode_LDA] = &&op_LDA,
+        [OpCode_SET] = &&op_SET,
+        [OpCode_SETP] = &&op_SETP,
+        [OpCode_ADDSP] = &&op_ADDSP,
+        [OpCode_SETP4] = &&op_SETP4,
+        [OpCode_SETP2] = &&op_SETP2,
+        [OpCode_SETP1] = &&op_SETP1,
+        [OpCode_ADDP4] = &&op_ADDP4,
+        [OpCode_SUBP4] = &&op_SUBP4,
+        [OpCode_ADDP2] = &&op_ADDP2,
+        [OpCode_SUBP2] = &&op_SUBP2,
+        [OpCode_ADDP1] = &&op_ADDP1,
+        [OpCode_SUBP1] = &&op_SUBP1,
+        [OpCode_ERASE] = &&op_ERASE,
+        [OpCode_DEL4] = &&op_DEL4,
+        [OpCode_DEL2] = &&op_DEL2,
+        [OpCode_DEL1] = &&op_DEL1,
+        [OpCode_GLOB4] = &&op_GLOB4,
+        [OpCode_GLOB2] = &&op_GLOB2,
+        [OpCode_GLOB1] = &&op_GLOB1,
+        [OpCode_LOC4] = &&op_LOC4,
+        [OpCode_LOC2] = &&op_LOC2,
+        [OpCode_LOC1] = &&op_LOC1,
+        [OpCode_SITER] = &&op_SITER,
+        [OpCode_TITER] = &&op_TITER,
+        [OpCode_NITER] = &&op_NITER,
+        [OpCode_DITER] = &&op_DITER,
+        [OpCode_NOOP] = &&op_NOOP,
+        [OpCode_JMPF] = &&op_JMPF,
+        [OpCode_JMPT] = &&op_JMPT,
+        [OpCode_JMP] = &&op_JMP,
+        [OpCode_LOR] = &&op_LOR,
+        [OpCode_LAND] = &&op_LAND,
+        [OpCode_JMPF2] = &&op_JMPF2,
+        [OpCode_JMPT2] = &&op_JMPT2,
+        [OpCode_JMP2] = &&op_JMP2,
+        [OpCode_LOR2] = &&op_LOR2,
+        [OpCode_LAND2] = &&op_LAND2,
+        [OpCode_JMPF1] = &&op_JMPF1,
+        [OpCode_JMPT1] = &&op_JMPT1,
+        [OpCode_JMP1] = &&op_JMP1,
+        [OpCode_LOR1] = &&op_LOR1,
+        [OpCode_LAND1] = &&op_LAND1,
+        [OpCode_NEJF2] = &&op_NEJF2,
+        [OpCode_EQJF2] = &&op_EQJF2,
+        [OpCode_LTJF2] = &&op_LTJF2,
+        [OpCode_LEJF2] = &&op_LEJF2,
+        [OpCode_GTJF2] = &&op_GTJF2,
+        [OpCode_GEJF2] = &&op_GEJF2,
+        [OpCode_NEJF1] = &&op_NEJF1,
+        [OpCode_EQJF1] = &&op_EQJF1,
+        [OpCode_LTJF1] = &&op_LTJF1,
+        [OpCode_LEJF1] = &&op_LEJF1,
+        [OpCode_GTJF1] = &&op_GTJF1,
+        [OpCode_GEJF1] = &&op_GEJF1,
+        [OpCode_CALL] = &&op_CALL,
+        [OpCode_CALL1] = &&op_CALL1,
+        [OpCode_RET] = &&op_RET,
+        [OpCode_ADDMOD4] = &&op_ADDMOD4,
+        [OpCode_ADDMOD2] = &&op_ADDMOD2,
+        [OpCode_ADDMOD1] = &&op_ADDMOD1,
+        [OpCode_XMOD] = &&op_XMOD,
+        [OpCode_LDMOD4] = &&op_LDMOD4,
+        [OpCode_LDMOD2] = &&op_LDMOD2,
+        [OpCode_LDMOD1] = &&op_LDMOD1,
+        [OpCode_MKARG] = &&op_MKARG,
+        [OpCode_MKIGARG] = &&op_MKIGARG,
+        [OpCode_MKDGARG] = &&op_MKDGARG,
+        [OpCode_MKNARG4] = &&op_MKNARG4,
+        [OpCode_MKNARG2] = &&op_MKNARG2,
+        [OpCode_MKNARG1] = &&op_MKNARG1,
+        [OpCode_MKPAR4] = &&op_MKPAR4,
+        [OpCode_MKTGPAR4] = &&op_MKTGPAR4,
+        [OpCode_MKDGPAR4] = &&op_MKDGPAR4,
+        [OpCode_MKPAR2] = &&op_MKPAR2,
+        [OpCode_MKTGPAR2] = &&op_MKTGPAR2,
+        [OpCode_MKDGPAR2] = &&op_MKDGPAR2,
+        [OpCode_MKPAR1] = &&op_MKPAR1,
+        [OpCode_MKTGPAR1] = &&op_MKTGPAR1,
+        [OpCode_MKDGPAR1] = &&op_MKDGPAR1,
+        [OpCode_MKDPAR4] = &&op_MKDPAR4,
+        [OpCode_MKDPAR2] = &&op_MKDPAR2,
+        [OpCode_MKDPAR1] = &&op_MKDPAR1,
+        [OpCode_MKFUN] = &&op_MKFUN,
+        [OpCode_MKKVP] = &&op_MKKVP,
+        [OpCode_MKR0] = &&op_MKR0,
+        [OpCode_MKRS] = &&op_MKRS,
+        [OpCode_MKRE] = &&op_MKRE,
+        [OpCode_MKRSE] = &&op_MKRSE,
+        [OpCode_MKRT] = &&op_MKRT,
+        [OpCode_MKRST] = &&op_MKRST,
+        [OpCode_MKRET] = &&op_MKRET,
+        [OpCode_MKR] = &&op_MKR,
+        [OpCode_INS] = &&op_INS,
+        [OpCode_INSP] = &&op_INSP,
+        [OpCode_BLD] = &&op_BLD,
+        [OpCode_IDX] = &&op_IDX,
+        [OpCode_IDXA] = &&op_IDXA,
+        [OpCode_MEM4] = &&op_MEM4,
+        [OpCode_MEMA4] = &&op_MEMA4,
+        [OpCode_MEM2] = &&op_MEM2,
+        [OpCode_MEMA2] = &&op_MEMA2,
+        [OpCode_MEM1] = &&op_MEM1,
+        [OpCode_MEMA1] = &&op_MEMA1,
+        [OpCode_MEM] = &&op_MEM,
+        [OpCode_MEMA] = &&op_MEMA,
+        [OpCode_ABORT] = &&op_ABORT,
+        [OpCode_END] = &&op_END,
+    };
     #endif
 
-    engine->instructionAddress = engine->pc;
     uint8_t opCode;
-    AspRunResult opCodeResult = AspLoadCodeBytes(engine, &opCode, 1);
+    AspRunResult opCodeResult = FetchInstruction(engine, stepCount, &opCode);
     if (opCodeResult != AspRunResult_OK)
         return opCodeResult;
-    #ifdef ASP_DEBUG
-    fprintf(engine->traceFile, "0x%02X ", opCode);
-    #endif
 
     unsigned operandSize = 0;
     switch (opCode)
     {
-        default:
+        OP_DEFAULT:
             return AspRunResult_InvalidInstruction;
 
-        case OpCode_PUSHN:
+        OP_CASE(PUSHN):
         {
             #ifdef ASP_DEBUG
             fputs("PUSHN\n", engine->traceFile);
@@ -110,10 +427,10 @@ static AspRunResult Step(AspEngine *engine)
             if (stackEntry == 0)
                 return AspRunResult_OutOfDataMemory;
 
-            break;
+            DISPATCH_NEXT;
         }
 
-        case OpCode_PUSHE:
+        OP_CASE(PUSHE):
         {
             #ifdef ASP_DEBUG
             fputs("PUSHE\n", engine->traceFile);
@@ -128,11 +445,11 @@ static AspRunResult Step(AspEngine *engine)
                 return AspRunResult_OutOfDataMemory;
             AspUnref(engine, valueEntry);
 
-            break;
+            DISPATCH_NEXT;
         }
 
-        case OpCode_PUSHF:
-        case OpCode_PUSHT:
+        OP_CASE(PUSHF):
+        OP_CASE(PUSHT):
         {
             #ifdef ASP_DEBUG
             fprintf
@@ -150,16 +467,16 @@ static AspRunResult Step(AspEngine *engine)
                 return AspRunResult_OutOfDataMemory;
             AspUnref(engine, valueEntry);
 
-            break;
+            DISPATCH_NEXT;
         }
 
-        case OpCode_PUSHI4:
+        OP_CASE(PUSHI4):
             operandSize += 2;
-        case OpCode_PUSHI2:
+        OP_CASE(PUSHI2):
             operandSize++;
-        case OpCode_PUSHI1:
+        OP_CASE(PUSHI1):
             operandSize++;
-        case OpCode_PUSHI0:
+        OP_CASE(PUSHI0):
         {
             #ifdef ASP_DEBUG
             fputs("PUSHI ", engine->traceFile);
@@ -189,10 +506,10 @@ static AspRunResult Step(AspEngine *engine)
                 return AspRunResult_OutOfDataMemory;
             AspUnref(engine, valueEntry);
 
-            break;
+            DISPATCH_NEXT;
         }
 
-        case OpCode_PUSHD:
+        OP_CASE(PUSHD):
         {
             #ifdef ASP_DEBUG
             fputs("PUSHD ", engine->traceFile);
@@ -222,14 +539,14 @@ static AspRunResult Step(AspEngine *engine)
                 return AspRunResult_OutOfDataMemory;
             AspUnref(engine, valueEntry);
 
-            break;
+            DISPATCH_NEXT;
         }
 
-        case OpCode_PUSHY4:
+        OP_CASE(PUSHY4):
             operandSize += 2;
-        case OpCode_PUSHY2:
+        OP_CASE(PUSHY2):
             operandSize++;
-        case OpCode_PUSHY1:
+        OP_CASE(PUSHY1):
             operandSize++;
         {
             #ifdef ASP_DEBUG
@@ -260,16 +577,16 @@ static AspRunResult Step(AspEngine *engine)
                 return AspRunResult_OutOfDataMemory;
             AspUnref(engine, valueEntry);
 
-            break;
+            DISPATCH_NEXT;
         }
 
-        case OpCode_PUSHS4:
+        OP_CASE(PUSHS4):
             operandSize += 2;
-        case OpCode_PUSHS2:
+        OP_CASE(PUSHS2):
             operandSize++;
-        case OpCode_PUSHS1:
+        OP_CASE(PUSHS1):
             operandSize++;
-        case OpCode_PUSHS0:
+        OP_CASE(PUSHS0):
         {
             #ifdef ASP_DEBUG
             fputs("PUSHS ", engine->traceFile);
@@ -290,54 +607,120 @@ static AspRunResult Step(AspEngine *engine)
             fprintf(engine->traceFile, "%d, ", size);
             #endif
 
+            /* Reuse the string previously created by this instruction if
+               it is still cached, skipping over its bytes. The bytes were
+               validated when the string was first created. */
+            AspDataEntry *stringEntry = AspFindCachedString(engine);
+            if (stringEntry != 0)
+            {
+                if (engine->decodedInstruction == 0)
+                    engine->pc += size;
+
+                #ifdef ASP_DEBUG
+                fputc('\'', engine->traceFile);
+                AspSequenceResult nextResult = AspSequenceNext
+                    (engine, stringEntry, 0, true);
+                for (; nextResult.element != 0;
+                     nextResult = AspSequenceNext
+                        (engine, stringEntry, nextResult.element, true))
+                {
+                    const AspDataEntry *fragment = nextResult.value;
+                    uint8_t fragmentSize =
+                        AspDataGetStringFragmentSize(fragment);
+                    const char *fragmentData =
+                        AspDataGetStringFragmentData(fragment);
+                    for (uint8_t i = 0; i < fragmentSize; i++)
+                    {
+                        char c = fragmentData[i];
+                        if (c == '\'')
+                            fputc('\\', engine->traceFile);
+                        fputc(isprint(c) ? c : '.', engine->traceFile);
+                    }
+                }
+                fputs("'\n", engine->traceFile);
+                #endif
+
+                const AspDataEntry *stackEntry = AspPush
+                    (engine, stringEntry);
+                if (stackEntry == 0)
+                    return AspRunResult_OutOfDataMemory;
+
+                DISPATCH_NEXT;
+            }
+
             /* Validate the bytes of the string. */
             #ifdef ASP_DEBUG
             fputc('\'', engine->traceFile);
             #endif
-            AspDataEntry *stringEntry = AspNewString(engine, 0, 0);
+            stringEntry = AspNewString(engine, 0, 0);
             if (stringEntry == 0)
                 return AspRunResult_OutOfDataMemory;
-            for (uint32_t i = 0; i < size; i++)
+            if (engine->decodedInstruction != 0)
             {
-                char c;
-                AspRunResult byteResult = AspLoadCodeBytes
-                    (engine, (uint8_t *)&c, 1);
-                if (byteResult != AspRunResult_OK)
-                {
-                    #ifdef ASP_DEBUG
-                    fputc('\n', engine->traceFile);
-                    #endif
-                    return byteResult;
-                }
+                /* The decoder has already verified that the string lies
+                   within the code, so append it all at once. */
+                const char *s = (const char *)engine->code +
+                    engine->instructionAddress + 1 + operandSize;
                 AspRunResult appendResult = AspStringAppendBuffer
-                    (engine, stringEntry, &c, 1);
+                    (engine, stringEntry, s, size);
                 if (appendResult != AspRunResult_OK)
                     return appendResult;
 
                 #ifdef ASP_DEBUG
-                if (c == '\'')
-                    fputc('\\', engine->traceFile);
-                fputc(isprint(c) ? c : '.', engine->traceFile);
+                for (uint32_t i = 0; i < size; i++)
+                {
+                    char c = s[i];
+                    if (c == '\'')
+                        fputc('\\', engine->traceFile);
+                    fputc(isprint(c) ? c : '.', engine->traceFile);
+                }
                 #endif
             }
+            else
+            {
+                for (uint32_t i = 0; i < size; i++)
+                {
+                    char c;
+                    AspRunResult byteResult = AspLoadCodeBytes
+                        (engine, (uint8_t *)&c, 1);
+                    if (byteResult != AspRunResult_OK)
+                    {
+                        #ifdef ASP_DEBUG
+                        fputc('\n', engine->traceFile);
+                        #endif
+                        return byteResult;
+                    }
+                    AspRunResult appendResult = AspStringAppendBuffer
+                        (engine, stringEntry, &c, 1);
+                    if (appendResult != AspRunResult_OK)
+                        return appendResult;
+
+                    #ifdef ASP_DEBUG
+                    if (c == '\'')
+                        fputc('\\', engine->traceFile);
+                    fputc(isprint(c) ? c : '.', engine->traceFile);
+                    #endif
+                }
+            }
             #ifdef ASP_DEBUG
             fputs("'\n", engine->traceFile);
             #endif
+            AspCacheString(engine, stringEntry);
 
             const AspDataEntry *stackEntry = AspPush(engine, stringEntry);
             if (stackEntry == 0)
                 return AspRunResult_OutOfDataMemory;
             AspUnref(engine, stringEntry);
 
-            break;
+            DISPATCH_NEXT;
         }
 
-        case OpCode_PUSHTU:
-        case OpCode_PUSHLI:
-        case OpCode_PUSHSE:
-        case OpCode_PUSHDI:
-        case OpCode_PUSHAL:
-        case OpCode_PUSHPL:
+        OP_CASE(PUSHTU):
+        OP_CASE(PUSHLI):
+        OP_CASE(PUSHSE):
+        OP_CASE(PUSHDI):
+        OP_CASE(PUSHAL):
+        OP_CASE(PUSHPL):
         {
             #ifdef ASP_DEBUG
             const char *suffix = 0;
@@ -405,10 +788,10 @@ static AspRunResult Step(AspEngine *engine)
             if (AspIsObject(valueEntry))
                 AspUnref(engine, valueEntry);
 
-            break;
+            DISPATCH_NEXT;
         }
 
-        case OpCode_PUSHCA:
+        OP_CASE(PUSHCA):
         {
             #ifdef ASP_DEBUG
             fputs("PUSHCA ", engine->traceFile);
@@ -442,14 +825,14 @@ static AspRunResult Step(AspEngine *engine)
             if (stackEntry == 0)
                 return AspRunResult_OutOfDataMemory;
 
-            break;
+            DISPATCH_NEXT;
         }
 
-        case OpCode_PUSHM4:
+        OP_CASE(PUSHM4):
             operandSize += 2;
-        case OpCode_PUSHM2:
+        OP_CASE(PUSHM2):
             operandSize++;
-        case OpCode_PUSHM1:
+        OP_CASE(PUSHM1):
             operandSize++;
         {
             #ifdef ASP_DEBUG
@@ -487,12 +870,12 @@ static AspRunResult Step(AspEngine *engine)
             if (stackEntry == 0)
                 return AspRunResult_OutOfDataMemory;
 
-            break;
+            DISPATCH_NEXT;
         }
 
-        case OpCode_POP1:
+        OP_CASE(POP1):
             operandSize++;
-        case OpCode_POP:
+        OP_CASE(POP):
         {
             #ifdef ASP_DEBUG
             fputs("POP", engine->traceFile);
@@ -529,13 +912,13 @@ static AspRunResult Step(AspEngine *engine)
                 AspPop(engine);
             }
 
-            break;
+            DISPATCH_NEXT;
         }
 
-        case OpCode_LNOT:
-        case OpCode_POS:
-        case OpCode_NEG:
-        case OpCode_NOT:
+        OP_CASE(LNOT):
+        OP_CASE(POS):
+        OP_CASE(NEG):
+        OP_CASE(NOT):
         {
             #ifdef ASP_DEBUG
             const static OpInfo ops[] =
@@ -573,32 +956,32 @@ static AspRunResult Step(AspEngine *engine)
                 return engine->runResult;
             AspUnref(engine, operand);
 
-            break;
+            DISPATCH_NEXT;
         }
 
-        case OpCode_OR:
-        case OpCode_XOR:
-        case OpCode_AND:
-        case OpCode_LSH:
-        case OpCode_RSH:
-        case OpCode_ADD:
-        case OpCode_SUB:
-        case OpCode_MUL:
-        case OpCode_DIV:
-        case OpCode_FDIV:
-        case OpCode_MOD:
-        case OpCode_POW:
-        case OpCode_NE:
-        case OpCode_EQ:
-        case OpCode_LT:
-        case OpCode_LE:
-        case OpCode_GT:
-        case OpCode_GE:
-        case OpCode_NIN:
-        case OpCode_IN:
-        case OpCode_NIS:
-        case OpCode_IS:
-        case OpCode_ORDER:
+        OP_CASE(OR):
+        OP_CASE(XOR):
+        OP_CASE(AND):
+        OP_CASE(LSH):
+        OP_CASE(RSH):
+        OP_CASE(ADD):
+        OP_CASE(SUB):
+        OP_CASE(MUL):
+        OP_CASE(DIV):
+        OP_CASE(FDIV):
+        OP_CASE(MOD):
+        OP_CASE(POW):
+        OP_CASE(NE):
+        OP_CASE(EQ):
+        OP_CASE(LT):
+        OP_CASE(LE):
+        OP_CASE(GT):
+        OP_CASE(GE):
+        OP_CASE(NIN):
+        OP_CASE(IN):
+        OP_CASE(NIS):
+        OP_CASE(IS):
+        OP_CASE(ORDER):
         {
             #ifdef ASP_DEBUG
             const static OpInfo ops[] =
@@ -648,9 +1031,30 @@ static AspRunResult Step(AspEngine *engine)
             AspRef(engine, left);
             AspPop(engine);
 
-            /* Perform the operation. */
-            AspOperationResult operationResult = AspPerformBinaryOperation
-                (engine, opCode, left, right);
+            /* Perform the operation. If the left value is a temporary that
+               nothing else references (e.g., the partial result of a chain
+               of concatenations), try updating it in place first. */
+            AspOperationResult operationResult = {AspRunResult_OK, 0};
+            if (opCode == OpCode_ADD && AspDataGetUseCount(left) == 1)
+                operationResult = AspPerformInPlaceBinaryOperation
+                    (engine, opCode, left, right);
+            if (operationResult.result == AspRunResult_OK &&
+                operationResult.value == 0)
+                operationResult = AspPerformBinaryOperation
+                    (engine, opCode, left, right);
+            if (operationResult.result == AspRunResult_Again)
+            {
+                /* Put the operands back for when the instruction is
+                   executed again to continue the operation. */
+                if (AspPush(engine, left) == 0 ||
+                    AspPush(engine, right) == 0)
+                    return AspRunResult_OutOfDataMemory;
+                AspUnref(engine, left);
+                AspUnref(engine, right);
+                ExecuteAgain(engine);
+                DISPATCH_NEXT;
+            }
+            engine->again = false;
             if (operationResult.result != AspRunResult_OK)
                 return operationResult.result;
 
@@ -667,16 +1071,16 @@ static AspRunResult Step(AspEngine *engine)
                 return engine->runResult;
             AspUnref(engine, right);
 
-            break;
+            DISPATCH_NEXT;
         }
 
-        case OpCode_LD4:
+        OP_CASE(LD4):
             operandSize += 2;
-        case OpCode_LD2:
+        OP_CASE(LD2):
             operandSize++;
-        case OpCode_LD1:
+        OP_CASE(LD1):
             operandSize++;
-        case OpCode_LD:
+        OP_CASE(LD):
         {
             #ifdef ASP_DEBUG
             fputs("LD ", engine->traceFile);
@@ -714,52 +1118,26 @@ static AspRunResult Step(AspEngine *engine)
             fputc('\n', engine->traceFile);
             #endif
 
-            /* Look up the variable, trying first the local namespace, and
-               then failing that, the global and system namespaces in turn.
-               Note that a local variable can also defer to the global
-               namespace via a global override. */
-            AspTreeResult findResult = AspFindSymbol
-                (engine, engine->localNamespace, variableSymbol);
-            if (findResult.result != AspRunResult_OK)
-                return findResult.result;
-            if ((findResult.node == 0 ||
-                 AspDataGetNamespaceNodeIsGlobal(findResult.node)) &&
-                engine->globalNamespace != engine->localNamespace)
-            {
-                findResult = AspFindSymbol
-                    (engine, engine->globalNamespace, variableSymbol);
-                if (findResult.result != AspRunResult_OK)
-                    return findResult.result;
-            }
-            if (findResult.node == 0)
-            {
-                findResult = AspFindSymbol
-                    (engine, engine->systemNamespace, variableSymbol);
-                if (findResult.result != AspRunResult_OK)
-                    return findResult.result;
-            }
-            if (findResult.node == 0)
-                return AspRunResult_NameNotFound;
-
-            /* Push variable's value. */
-            AspDataEntry *object = AspValueEntry
-                (engine, AspDataGetTreeNodeValueIndex(findResult.node));
-            if (!AspIsObject(object))
-                return AspRunResult_UnexpectedType;
+            /* Look up the variable and push its value. */
+            AspDataEntry *object;
+            AspRunResult loadResult = LoadVariable
+                (engine, variableSymbol, &object);
+            if (loadResult != AspRunResult_OK)
+                return loadResult;
             const AspDataEntry *stackEntry = AspPush(engine, object);
             if (stackEntry == 0)
                 return AspRunResult_OutOfDataMemory;
 
-            break;
+            DISPATCH_NEXT;
         }
 
-        case OpCode_LDA4:
+        OP_CASE(LDA4):
             operandSize += 2;
-        case OpCode_LDA2:
+        OP_CASE(LDA2):
             operandSize++;
-        case OpCode_LDA1:
+        OP_CASE(LDA1):
             operandSize++;
-        case OpCode_LDA:
+        OP_CASE(LDA):
         {
 
             #ifdef ASP_DEBUG
@@ -799,69 +1177,548 @@ static AspRunResult Step(AspEngine *engine)
             #endif
 
             /* Look up the variable, creating it if it doesn't exist. */
-            AspTreeResult insertResult = AspTreeTryInsertBySymbol
-                (engine, engine->localNamespace,
-                 variableSymbol, engine->noneSingleton);
-            if (insertResult.result != AspRunResult_OK)
-                return insertResult.result;
-            const AspDataEntry *node = insertResult.node;
-
-            /* Set the scope usage for the newly created variable. */
-            if (AspDataGetNamespaceNodeIsGlobal(node) &&
-                engine->localNamespace != engine->globalNamespace)
-            {
-                /* Use global scope because of global override. */
-                insertResult = AspTreeTryInsertBySymbol
-                    (engine, engine->globalNamespace,
-                     variableSymbol, engine->noneSingleton);
-                if (insertResult.result != AspRunResult_OK)
-                    return insertResult.result;
-            }
+            AspDataEntry *node;
+            AspRunResult loadResult = LoadVariableAddress
+                (engine, variableSymbol, &node);
+            if (loadResult != AspRunResult_OK)
+                return loadResult;
 
             /* Push the variable's tree node to serve as an address. */
-            const AspDataEntry *stackEntry = AspPush
-                (engine, insertResult.node);
+            const AspDataEntry *stackEntry = AspPush(engine, node);
             if (stackEntry == 0)
                 return AspRunResult_OutOfDataMemory;
 
-            break;
+            DISPATCH_NEXT;
+        }
+
+        OP_CASE(SET):
+        OP_CASE(SETP):
+        {
+            #ifdef ASP_DEBUG
+            fprintf
+                (engine->traceFile, "SET%s\n",
+                 opCode == OpCode_SETP ? "P" : "");
+            #endif
+
+            /* Obtain destination from the stack. */
+            AspDataEntry *address = AspTopValue(engine);
+            if (address == 0)
+                return AspRunResult_StackUnderflow;
+            if (AspIsObject(address))
+                AspRef(engine, address);
+            AspPop(engine);
+
+            /* Access value entry on the top of the stack. */
+            AspDataEntry *newValue = AspTopValue(engine);
+            if (newValue == 0)
+                return AspRunResult_StackUnderflow;
+
+            AspRunResult assignResult =
+                AspDataGetType(address) == DataType_Tuple ||
+                AspDataGetType(address) == DataType_List ?
+                AspAssignSequence(engine, address, newValue) :
+                AspAssignSimple(engine, address, newValue);
+            if (assignResult != AspRunResult_OK)
+                return assignResult;
+
+            /* Free a local slot address, which is not an object. */
+            if (AspDataGetType(address) == DataType_SlotAddress)
+            {
+                AspUnref(engine, address);
+                if (engine->runResult != AspRunResult_OK)
+                    return engine->runResult;
+            }
+
+            if (opCode == OpCode_SETP)
+                AspPop(engine);
+            DISPATCH_NEXT;
         }
 
-        case OpCode_SET:
-        case OpCode_SETP:
+        OP_CASE(ADDSP):
         {
             #ifdef ASP_DEBUG
-            fprintf
-                (engine->traceFile, "SET%s\n",
-                 opCode == OpCode_SETP ? "P" : "");
+            fputs("ADDSP\n", engine->traceFile);
+            #endif
+
+            /* Obtain destination from the stack. */
+            AspDataEntry *address = AspTopValue(engine);
+            if (address == 0)
+                return AspRunResult_StackUnderflow;
+            if (AspIsObject(address))
+                AspRef(engine, address);
+            AspPop(engine);
+
+            /* Access the right value from the stack. */
+            AspDataEntry *right = AspTopValue(engine);
+            if (right == 0)
+                return AspRunResult_StackUnderflow;
+            if (!AspIsObject(right))
+                return AspRunResult_UnexpectedType;
+            AspRef(engine, right);
+            AspPop(engine);
+
+            /* Fetch the left value, which was loaded from the destination,
+               from the stack. */
+            AspDataEntry *left = AspTopValue(engine);
+            if (left == 0)
+                return AspRunResult_StackUnderflow;
+            if (!AspIsObject(left))
+                return AspRunResult_UnexpectedType;
+            AspRef(engine, left);
+            AspPop(engine);
+
+            /* If the destination still holds the left value and nothing
+               else refers to it, try updating the value in place. */
+            uint8_t addressType = AspDataGetType(address);
+            bool sequenceAddress =
+                addressType == DataType_Tuple ||
+                addressType == DataType_List;
+            AspOperationResult operationResult = {AspRunResult_OK, 0};
+            if (!sequenceAddress && AspDataGetUseCount(left) == 2)
+            {
+                const AspDataEntry *value;
+                if (addressType == DataType_SlotAddress)
+                {
+                    AspRunResult valueResult = AspLocalSlotValue
+                        (engine,
+                         AspEntry
+                            (engine,
+                             AspDataGetSlotAddressSlotsIndex(address)),
+                         (uint8_t)AspDataGetSlotAddressSlot(address),
+                         (AspDataEntry **)&value);
+                    if (valueResult != AspRunResult_OK)
+                        return valueResult;
+                }
+                else
+                    value = AspValueEntry
+                        (engine,
+                         addressType == DataType_Element ?
+                         AspDataGetElementValueIndex(address) :
+                         AspDataGetTreeNodeValueIndex(address));
+                if (value == left)
+                    operationResult = AspPerformInPlaceBinaryOperation
+                        (engine, OpCode_ADD, left, right);
+            }
+
+            /* Otherwise, perform the regular operation. */
+            if (operationResult.result == AspRunResult_OK &&
+                operationResult.value == 0)
+                operationResult = AspPerformBinaryOperation
+                    (engine, OpCode_ADD, left, right);
+            if (operationResult.result != AspRunResult_OK)
+                return operationResult.result;
+
+            /* Assign the result. */
+            AspRunResult assignResult = sequenceAddress ?
+                AspAssignSequence(engine, address, operationResult.value) :
+                AspAssignSimple(engine, address, operationResult.value);
+            if (assignResult != AspRunResult_OK)
+                return assignResult;
+            if (addressType == DataType_SlotAddress)
+            {
+                AspUnref(engine, address);
+                if (engine->runResult != AspRunResult_OK)
+                    return engine->runResult;
+            }
+            AspUnref(engine, operationResult.value);
+            if (engine->runResult != AspRunResult_OK)
+                return engine->runResult;
+            AspUnref(engine, left);
+            if (engine->runResult != AspRunResult_OK)
+                return engine->runResult;
+            AspUnref(engine, right);
+
+            DISPATCH_NEXT;
+        }
+
+        OP_CASE(SETP4):
+            operandSize += 2;
+        OP_CASE(SETP2):
+            operandSize++;
+        OP_CASE(SETP1):
+            operandSize++;
+        {
+            #ifdef ASP_DEBUG
+            fputs("SETP ", engine->traceFile);
+            #endif
+
+            /* Fetch the variable's symbol from the operand. */
+            int32_t variableSymbol;
+            AspRunResult operandLoadResult = LoadSignedWordOperand
+                (engine, operandSize, &variableSymbol);
+            if (operandLoadResult != AspRunResult_OK)
+            {
+                #ifdef ASP_DEBUG
+                fputs("?\n", engine->traceFile);
+                #endif
+                return operandLoadResult;
+            }
+            #ifdef ASP_DEBUG
+            fprintf(engine->traceFile, "%d\n", variableSymbol);
+            #endif
+
+            /* Look up the variable, creating it if it doesn't exist. */
+            AspDataEntry *node;
+            AspRunResult loadResult = LoadVariableAddress
+                (engine, variableSymbol, &node);
+            if (loadResult != AspRunResult_OK)
+                return loadResult;
+
+            /* Assign the value on top of the stack to the variable. */
+            AspDataEntry *newValue = AspTopValue(engine);
+            if (newValue == 0)
+                return AspRunResult_StackUnderflow;
+            AspRunResult assignResult = AspAssignSimple
+                (engine, node, newValue);
+            if (assignResult != AspRunResult_OK)
+                return assignResult;
+            AspPop(engine);
+
+            DISPATCH_NEXT;
+        }
+
+        OP_CASE(ADDP4):
+        OP_CASE(SUBP4):
+            operandSize += 2;
+        OP_CASE(ADDP2):
+        OP_CASE(SUBP2):
+            operandSize++;
+        OP_CASE(ADDP1):
+        OP_CASE(SUBP1):
+            operandSize++;
+        {
+            bool subtract =
+                opCode == OpCode_SUBP1 ||
+                opCode == OpCode_SUBP2 ||
+                opCode == OpCode_SUBP4;
+
+            #ifdef ASP_DEBUG
+            fprintf
+                (engine->traceFile, "%sP ", subtract ? "SUB" : "ADD");
+            #endif
+
+            /* Fetch the variable's symbol from the operand. */
+            int32_t variableSymbol;
+            AspRunResult operandLoadResult = LoadSignedWordOperand
+                (engine, operandSize, &variableSymbol);
+            if (operandLoadResult != AspRunResult_OK)
+            {
+                #ifdef ASP_DEBUG
+                fputs("?\n", engine->traceFile);
+                #endif
+                return operandLoadResult;
+            }
+            #ifdef ASP_DEBUG
+            fprintf(engine->traceFile, "%d\n", variableSymbol);
+            #endif
+
+            /* Access the right value on top of the stack. */
+            AspDataEntry *right = AspTopValue(engine);
+            if (right == 0)
+                return AspRunResult_StackUnderflow;
+            if (!AspIsObject(right))
+                return AspRunResult_UnexpectedType;
+
+            /* Use the variable's current value as the left value. */
+            AspDataEntry *left;
+            AspRunResult loadResult = LoadVariable
+                (engine, variableSymbol, &left);
+            if (loadResult != AspRunResult_OK)
+                return loadResult;
+
+            /* If the variable holds the only reference to its value, and
+               it is also the variable being assigned (i.e., not a global
+               that is about to be shadowed by a new local), try updating
+               the value in place. */
+            AspOperationResult operationResult = {AspRunResult_OK, 0};
+            AspDataEntry *node = 0;
+            if (!subtract && AspDataGetUseCount(left) == 1)
+            {
+                loadResult = LoadVariableAddress
+                    (engine, variableSymbol, &node);
+                if (loadResult != AspRunResult_OK)
+                    return loadResult;
+                if (AspDataGetTreeNodeValueIndex(node) ==
+                    AspIndex(engine, left))
+                    operationResult = AspPerformInPlaceBinaryOperation
+                        (engine, OpCode_ADD, left, right);
+            }
+            AspRef(engine, left);
+
+            /* Otherwise, perform the regular operation. */
+            if (operationResult.result == AspRunResult_OK &&
+                operationResult.value == 0)
+                operationResult = AspPerformBinaryOperation
+                    (engine, subtract ? OpCode_SUB : OpCode_ADD, left, right);
+            if (operationResult.result != AspRunResult_OK)
+                return operationResult.result;
+            AspUnref(engine, left);
+            if (engine->runResult != AspRunResult_OK)
+                return engine->runResult;
+
+            /* Assign the result to the variable, creating it in the local
+               namespace if applicable, just as for a separate assignment. */
+            if (node == 0)
+            {
+                loadResult = LoadVariableAddress
+                    (engine, variableSymbol, &node);
+                if (loadResult != AspRunResult_OK)
+                    return loadResult;
+            }
+            AspRunResult assignResult = AspAssignSimple
+                (engine, node, operationResult.value);
+            if (assignResult != AspRunResult_OK)
+                return assignResult;
+            AspUnref(engine, operationResult.value);
+            if (engine->runResult != AspRunResult_OK)
+                return engine->runResult;
+            AspPop(engine);
+
+            DISPATCH_NEXT;
+        }
+
+        OP_CASE(SLOTS):
+        {
+            #ifdef ASP_DEBUG
+            fputs("SLOTS ", engine->traceFile);
+            #endif
+
+            /* Fetch the slot count from the operand. */
+            uint32_t count;
+            AspRunResult operandLoadResult = LoadUnsignedOperand
+                (engine, 1, &count);
+            if (operandLoadResult != AspRunResult_OK)
+            {
+                #ifdef ASP_DEBUG
+                fputs("?\n", engine->traceFile);
+                #endif
+                return operandLoadResult;
+            }
+            #ifdef ASP_DEBUG
+            fprintf(engine->traceFile, "%u\n", count);
+            #endif
+
+            /* The slot table is processed when the function is called, which
+               then skips over it. Skip it here as well if it is reached in
+               any other way. */
+            if (engine->decodedInstruction == 0)
+                engine->pc += 4U * count;
+
+            DISPATCH_NEXT;
+        }
+
+        OP_CASE(LDL):
+        {
+            #ifdef ASP_DEBUG
+            fputs("LDL ", engine->traceFile);
+            #endif
+
+            /* Fetch the local variable's slot from the operand. */
+            uint8_t slot;
+            AspRunResult operandLoadResult = LoadSlotOperand(engine, &slot);
+            if (operandLoadResult != AspRunResult_OK)
+            {
+                #ifdef ASP_DEBUG
+                fputs("?\n", engine->traceFile);
+                #endif
+                return operandLoadResult;
+            }
+            #ifdef ASP_DEBUG
+            fprintf(engine->traceFile, "%u\n", slot);
+            #endif
+
+            /* Look up the variable and push its value. */
+            AspDataEntry *object;
+            AspRunResult loadResult = LoadSlotVariable
+                (engine, slot, &object);
+            if (loadResult != AspRunResult_OK)
+                return loadResult;
+            const AspDataEntry *stackEntry = AspPush(engine, object);
+            if (stackEntry == 0)
+                return AspRunResult_OutOfDataMemory;
+
+            DISPATCH_NEXT;
+        }
+
+        OP_CASE(LDAL):
+        {
+            #ifdef ASP_DEBUG
+            fputs("LDAL ", engine->traceFile);
+            #endif
+
+            /* Fetch the local variable's slot from the operand. */
+            uint8_t slot;
+            AspRunResult operandLoadResult = LoadSlotOperand(engine, &slot);
+            if (operandLoadResult != AspRunResult_OK)
+            {
+                #ifdef ASP_DEBUG
+                fputs("?\n", engine->traceFile);
+                #endif
+                return operandLoadResult;
+            }
+            #ifdef ASP_DEBUG
+            fprintf(engine->traceFile, "%u\n", slot);
+            #endif
+
+            /* Push a slot address. It is freed once assigned through. */
+            AspDataEntry *address = AspAllocEntry
+                (engine, DataType_SlotAddress);
+            if (address == 0)
+                return AspRunResult_OutOfDataMemory;
+            AspDataSetSlotAddressSlotsIndex
+                (address, AspIndex(engine, engine->localSlots));
+            AspDataSetSlotAddressSlot(address, slot);
+            const AspDataEntry *stackEntry = AspPush(engine, address);
+            if (stackEntry == 0)
+                return AspRunResult_OutOfDataMemory;
+
+            DISPATCH_NEXT;
+        }
+
+        OP_CASE(SETL):
+        {
+            #ifdef ASP_DEBUG
+            fputs("SETL ", engine->traceFile);
+            #endif
+
+            /* Fetch the local variable's slot from the operand. */
+            uint8_t slot;
+            AspRunResult operandLoadResult = LoadSlotOperand(engine, &slot);
+            if (operandLoadResult != AspRunResult_OK)
+            {
+                #ifdef ASP_DEBUG
+                fputs("?\n", engine->traceFile);
+                #endif
+                return operandLoadResult;
+            }
+            #ifdef ASP_DEBUG
+            fprintf(engine->traceFile, "%u\n", slot);
+            #endif
+
+            /* Assign the value on top of the stack to the variable. */
+            AspDataEntry *newValue = AspTopValue(engine);
+            if (newValue == 0)
+                return AspRunResult_StackUnderflow;
+            AspRunResult assignResult = AspAssignLocalSlot
+                (engine, engine->localSlots, slot, newValue);
+            if (assignResult != AspRunResult_OK)
+                return assignResult;
+            AspPop(engine);
+
+            DISPATCH_NEXT;
+        }
+
+        OP_CASE(ADDL):
+        OP_CASE(SUBL):
+        {
+            bool subtract = opCode == OpCode_SUBL;
+
+            #ifdef ASP_DEBUG
+            fprintf
+                (engine->traceFile, "%sL ", subtract ? "SUB" : "ADD");
+            #endif
+
+            /* Fetch the local variable's slot from the operand. */
+            uint8_t slot;
+            AspRunResult operandLoadResult = LoadSlotOperand(engine, &slot);
+            if (operandLoadResult != AspRunResult_OK)
+            {
+                #ifdef ASP_DEBUG
+                fputs("?\n", engine->traceFile);
+                #endif
+                return operandLoadResult;
+            }
+            #ifdef ASP_DEBUG
+            fprintf(engine->traceFile, "%u\n", slot);
+            #endif
+
+            /* Access the right value on top of the stack. */
+            AspDataEntry *right = AspTopValue(engine);
+            if (right == 0)
+                return AspRunResult_StackUnderflow;
+            if (!AspIsObject(right))
+                return AspRunResult_UnexpectedType;
+
+            /* Use the variable's current value as the left value. */
+            AspDataEntry *left;
+            AspRunResult loadResult = LoadSlotVariable(engine, slot, &left);
+            if (loadResult != AspRunResult_OK)
+                return loadResult;
+
+            /* If the slot itself holds the only reference to the value
+               (i.e., it is not a global read through an unbound slot), try
+               updating the value in place. */
+            AspOperationResult operationResult = {AspRunResult_OK, 0};
+            if (!subtract && AspDataGetUseCount(left) == 1)
+            {
+                AspDataEntry *slotValue;
+                loadResult = AspLocalSlotValue
+                    (engine, engine->localSlots, slot, &slotValue);
+                if (loadResult != AspRunResult_OK)
+                    return loadResult;
+                if (slotValue == left)
+                    operationResult = AspPerformInPlaceBinaryOperation
+                        (engine, OpCode_ADD, left, right);
+            }
+            AspRef(engine, left);
+
+            /* Otherwise, perform the regular operation. */
+            if (operationResult.result == AspRunResult_OK &&
+                operationResult.value == 0)
+                operationResult = AspPerformBinaryOperation
+                    (engine, subtract ? OpCode_SUB : OpCode_ADD, left, right);
+            if (operationResult.result != AspRunResult_OK)
+                return operationResult.result;
+            AspUnref(engine, left);
+            if (engine->runResult != AspRunResult_OK)
+                return engine->runResult;
+
+            /* Assign the result to the variable. */
+            AspRunResult assignResult = AspAssignLocalSlot
+                (engine, engine->localSlots, slot, operationResult.value);
+            if (assignResult != AspRunResult_OK)
+                return assignResult;
+            AspUnref(engine, operationResult.value);
+            if (engine->runResult != AspRunResult_OK)
+                return engine->runResult;
+            AspPop(engine);
+
+            DISPATCH_NEXT;
+        }
+
+        OP_CASE(DELL):
+        {
+            #ifdef ASP_DEBUG
+            fputs("DELL ", engine->traceFile);
+            #endif
+
+            /* Fetch the local variable's slot from the operand. */
+            uint8_t slot;
+            AspRunResult operandLoadResult = LoadSlotOperand(engine, &slot);
+            if (operandLoadResult != AspRunResult_OK)
+            {
+                #ifdef ASP_DEBUG
+                fputs("?\n", engine->traceFile);
+                #endif
+                return operandLoadResult;
+            }
+            #ifdef ASP_DEBUG
+            fprintf(engine->traceFile, "%u\n", slot);
             #endif
 
-            /* Obtain destination from the stack. */
-            AspDataEntry *address = AspTopValue(engine);
-            if (address == 0)
-                return AspRunResult_StackUnderflow;
-            if (AspIsObject(address))
-                AspRef(engine, address);
-            AspPop(engine);
-
-            /* Access value entry on the top of the stack. */
-            AspDataEntry *newValue = AspTopValue(engine);
-            if (newValue == 0)
-                return AspRunResult_StackUnderflow;
+            /* Unbind the variable, ensuring it was bound. */
+            bool wasBound;
+            AspRunResult unbindResult = AspUnbindLocalSlot
+                (engine, engine->localSlots, slot, &wasBound);
+            if (unbindResult != AspRunResult_OK)
+                return unbindResult;
+            if (!wasBound)
+                return AspRunResult_NameNotFound;
 
-            AspRunResult assignResult =
-                AspDataGetType(address) == DataType_Tuple ||
-                AspDataGetType(address) == DataType_List ?
-                AspAssignSequence(engine, address, newValue) :
-                AspAssignSimple(engine, address, newValue);
-            if (assignResult != AspRunResult_OK)
-                return assignResult;
-            if (opCode == OpCode_SETP)
-                AspPop(engine);
-            break;
+            DISPATCH_NEXT;
         }
 
-        case OpCode_ERASE:
+        OP_CASE(ERASE):
         {
             #ifdef ASP_DEBUG
             fputs("ERASE\n", engine->traceFile);
@@ -1037,14 +1894,14 @@ static AspRunResult Step(AspEngine *engine)
                 return engine->runResult;
             AspUnref(engine, container);
 
-            break;
+            DISPATCH_NEXT;
         }
 
-        case OpCode_DEL4:
+        OP_CASE(DEL4):
             operandSize += 2;
-        case OpCode_DEL2:
+        OP_CASE(DEL2):
             operandSize++;
-        case OpCode_DEL1:
+        OP_CASE(DEL1):
             operandSize++;
         {
             #ifdef ASP_DEBUG
@@ -1066,10 +1923,11 @@ static AspRunResult Step(AspEngine *engine)
             fprintf(engine->traceFile, "%d\n", variableSymbol);
             #endif
 
-            /* Look up the variable in the local namespace. */
+            /* Look up the variable in the local namespace, if any. */
             AspDataEntry *ns = engine->localNamespace;
-            AspTreeResult findResult = AspFindSymbol
-                (engine, ns, variableSymbol);
+            AspTreeResult findResult = {AspRunResult_OK, 0, 0, 0, false};
+            if (ns != 0)
+                findResult = AspFindSymbol(engine, ns, variableSymbol);
             if (findResult.result != AspRunResult_OK)
                 return findResult.result;
             const AspDataEntry *node = findResult.node;
@@ -1096,14 +1954,14 @@ static AspRunResult Step(AspEngine *engine)
             if (eraseResult != AspRunResult_OK)
                 return eraseResult;
 
-            break;
+            DISPATCH_NEXT;
         }
 
-        case OpCode_GLOB4:
+        OP_CASE(GLOB4):
             operandSize += 2;
-        case OpCode_GLOB2:
+        OP_CASE(GLOB2):
             operandSize++;
-        case OpCode_GLOB1:
+        OP_CASE(GLOB1):
             operandSize++;
         {
             #ifdef ASP_DEBUG
@@ -1130,8 +1988,11 @@ static AspRunResult Step(AspEngine *engine)
                 return AspRunResult_InvalidContext;
 
             /* Look up the variable in the local namespace. */
+            AspDataEntry *ns = AspLocalNamespace(engine);
+            if (ns == 0)
+                return AspRunResult_OutOfDataMemory;
             AspTreeResult findResult = AspFindSymbol
-                (engine, engine->localNamespace, variableSymbol);
+                (engine, ns, variableSymbol);
             if (findResult.result != AspRunResult_OK)
                 return findResult.result;
             AspDataEntry *node = findResult.node;
@@ -1146,8 +2007,7 @@ static AspRunResult Step(AspEngine *engine)
                 /* Create a temporary local variable as a reference to the
                    global namespace. */
                 AspTreeResult insertResult = AspTreeTryInsertBySymbol
-                    (engine, engine->localNamespace,
-                     variableSymbol, engine->noneSingleton);
+                    (engine, ns, variableSymbol, engine->noneSingleton);
                 if (insertResult.result != AspRunResult_OK)
                     return insertResult.result;
                 node = insertResult.node;
@@ -1157,14 +2017,14 @@ static AspRunResult Step(AspEngine *engine)
             /* Mark the variable with a global override. */
             AspDataSetNamespaceNodeIsGlobal(node, true);
 
-            break;
+            DISPATCH_NEXT;
         }
 
-        case OpCode_LOC4:
+        OP_CASE(LOC4):
             operandSize += 2;
-        case OpCode_LOC2:
+        OP_CASE(LOC2):
             operandSize++;
-        case OpCode_LOC1:
+        OP_CASE(LOC1):
             operandSize++;
         {
             #ifdef ASP_DEBUG
@@ -1191,8 +2051,11 @@ static AspRunResult Step(AspEngine *engine)
                 return AspRunResult_InvalidContext;
 
             /* Look up the variable in the local namespace. */
+            AspDataEntry *ns = AspLocalNamespace(engine);
+            if (ns == 0)
+                return AspRunResult_OutOfDataMemory;
             AspTreeResult findResult = AspFindSymbol
-                (engine, engine->localNamespace, variableSymbol);
+                (engine, ns, variableSymbol);
             if (findResult.result != AspRunResult_OK)
                 return findResult.result;
             AspDataEntry *node = findResult.node;
@@ -1208,17 +2071,17 @@ static AspRunResult Step(AspEngine *engine)
             if (AspDataGetNamespaceNodeIsNotLocal(node))
             {
                 AspRunResult eraseResult = AspTreeEraseNode
-                    (engine, engine->localNamespace, node, true, true);
+                    (engine, ns, node, true, true);
                 if (eraseResult != AspRunResult_OK)
                     return eraseResult;
             }
             else
                 AspDataSetNamespaceNodeIsGlobal(node, false);
 
-            break;
+            DISPATCH_NEXT;
         }
 
-        case OpCode_SITER:
+        OP_CASE(SITER):
         {
             #ifdef ASP_DEBUG
             fputs("SITER\n", engine->traceFile);
@@ -1242,10 +2105,10 @@ static AspRunResult Step(AspEngine *engine)
                 (engine->stackTop, AspIndex(engine, iteratorResult.value));
             AspUnref(engine, iterable);
 
-            break;
+            DISPATCH_NEXT;
         }
 
-        case OpCode_TITER:
+        OP_CASE(TITER):
         {
             #ifdef ASP_DEBUG
             fputs("TITER\n", engine->traceFile);
@@ -1268,10 +2131,10 @@ static AspRunResult Step(AspEngine *engine)
                 return AspRunResult_OutOfDataMemory;
             AspUnref(engine, testResult);
 
-            break;
+            DISPATCH_NEXT;
         }
 
-        case OpCode_NITER:
+        OP_CASE(NITER):
         {
             #ifdef ASP_DEBUG
             fputs("NITER\n", engine->traceFile);
@@ -1290,10 +2153,10 @@ static AspRunResult Step(AspEngine *engine)
             if (iteratorResult != AspRunResult_OK)
                 return iteratorResult;
 
-            break;
+            DISPATCH_NEXT;
         }
 
-        case OpCode_DITER:
+        OP_CASE(DITER):
         {
             #ifdef ASP_DEBUG
             fputs("DITER\n", engine->traceFile);
@@ -1319,22 +2182,39 @@ static AspRunResult Step(AspEngine *engine)
             if (AspIsObject(iteratorResult.value))
                 AspUnref(engine, iteratorResult.value);
 
-            break;
+            DISPATCH_NEXT;
         }
 
-        case OpCode_NOOP:
+        OP_CASE(NOOP):
             #ifdef ASP_DEBUG
             fputs("NOOP\n", engine->traceFile);
             #endif
 
-            break;
+            DISPATCH_NEXT;
 
-        case OpCode_JMPF:
-        case OpCode_JMPT:
-        case OpCode_JMP:
-        case OpCode_LOR:
-        case OpCode_LAND:
+        OP_CASE(JMPF2):
+        OP_CASE(JMPT2):
+        OP_CASE(JMP2):
+        OP_CASE(LOR2):
+        OP_CASE(LAND2):
+            operandSize++;
+        OP_CASE(JMPF1):
+        OP_CASE(JMPT1):
+        OP_CASE(JMP1):
+        OP_CASE(LOR1):
+        OP_CASE(LAND1):
+            operandSize++;
+        OP_CASE(JMPF):
+        OP_CASE(JMPT):
+        OP_CASE(JMP):
+        OP_CASE(LOR):
+        OP_CASE(LAND):
         {
+            /* Map relative jumps to their absolute counterparts. */
+            if (operandSize != 0)
+                opCode = (uint8_t)(OpCode_JMPF + opCode -
+                    (operandSize == 1 ? OpCode_JMPF1 : OpCode_JMPF2));
+
             #ifdef ASP_DEBUG
             fprintf
                 (engine->traceFile, "%s ",
@@ -1344,10 +2224,11 @@ static AspRunResult Step(AspEngine *engine)
                  opCode == OpCode_LAND ? "LAND" : "JMP");
             #endif
 
-            /* Fetch the code address from the operand. */
+            /* Fetch the code address from the operand. Relative offsets
+               are applied to the address of the following instruction. */
             uint32_t codeAddress = 0;
-            AspRunResult operandLoadResult = LoadUnsignedWordOperand
-                (engine, 4, &codeAddress);
+            AspRunResult operandLoadResult = LoadCodeAddressOperand
+                (engine, operandSize, &codeAddress);
             if (operandLoadResult != AspRunResult_OK)
             {
                 #ifdef ASP_DEBUG
@@ -1383,21 +2264,141 @@ static AspRunResult Step(AspEngine *engine)
 
             /* Transfer control to the code address if applicable. */
             if (condition == (opCode != OpCode_JMPF && opCode != OpCode_LAND))
+            {
                 engine->pc = codeAddress;
+                if (engine->decodedInstruction != 0)
+                    engine->nextDecodedInstruction = engine->decodedCode +
+                        engine->decodedInstruction->operand.u[1];
+            }
 
-            break;
+            DISPATCH_NEXT;
+        }
+
+        OP_CASE(NEJF2):
+        OP_CASE(EQJF2):
+        OP_CASE(LTJF2):
+        OP_CASE(LEJF2):
+        OP_CASE(GTJF2):
+        OP_CASE(GEJF2):
+            operandSize++;
+        OP_CASE(NEJF1):
+        OP_CASE(EQJF1):
+        OP_CASE(LTJF1):
+        OP_CASE(LEJF1):
+        OP_CASE(GTJF1):
+        OP_CASE(GEJF1):
+            operandSize++;
+        {
+            uint8_t compareOpCode = (uint8_t)(OpCode_NE + opCode -
+                (operandSize == 1 ? OpCode_NEJF1 : OpCode_NEJF2));
+
+            #ifdef ASP_DEBUG
+            static const char *const names[] =
+                {"NE", "EQ", "LT", "LE", "GT", "GE"};
+            fprintf
+                (engine->traceFile, "%sJF ",
+                 names[compareOpCode - OpCode_NE]);
+            #endif
+
+            /* Fetch the code address from the operand. */
+            uint32_t codeAddress = 0;
+            AspRunResult operandLoadResult = LoadCodeAddressOperand
+                (engine, operandSize, &codeAddress);
+            if (operandLoadResult != AspRunResult_OK)
+            {
+                #ifdef ASP_DEBUG
+                fputs("?\n", engine->traceFile);
+                #endif
+                return operandLoadResult;
+            }
+            #ifdef ASP_DEBUG
+            fprintf(engine->traceFile, "@0x%07X\n", codeAddress);
+            #endif
+            AspRunResult validateResult = AspValidateCodeAddress
+                (engine, codeAddress);
+            if (validateResult != AspRunResult_OK)
+                return validateResult;
+
+            /* Access the right value from the stack. */
+            AspDataEntry *right = AspTopValue(engine);
+            if (right == 0)
+                return AspRunResult_StackUnderflow;
+            if (!AspIsObject(right))
+                return AspRunResult_UnexpectedType;
+            AspRef(engine, right);
+            AspPop(engine);
+
+            /* Fetch the left value from the stack. */
+            AspDataEntry *left = AspTopValue(engine);
+            if (left == 0)
+                return AspRunResult_StackUnderflow;
+            if (!AspIsObject(left))
+                return AspRunResult_UnexpectedType;
+            AspRef(engine, left);
+            AspPop(engine);
+
+            /* Perform the comparison. */
+            AspOperationResult operationResult = AspPerformBinaryOperation
+                (engine, compareOpCode, left, right);
+            if (operationResult.result != AspRunResult_OK)
+                return operationResult.result;
+            bool condition = AspIsTrue(engine, operationResult.value);
+            AspUnref(engine, operationResult.value);
+            if (engine->runResult != AspRunResult_OK)
+                return engine->runResult;
+            AspUnref(engine, left);
+            if (engine->runResult != AspRunResult_OK)
+                return engine->runResult;
+            AspUnref(engine, right);
+            if (engine->runResult != AspRunResult_OK)
+                return engine->runResult;
+
+            /* Transfer control to the code address if the comparison
+               failed. */
+            if (!condition)
+            {
+                engine->pc = codeAddress;
+                if (engine->decodedInstruction != 0)
+                    engine->nextDecodedInstruction = engine->decodedCode +
+                        engine->decodedInstruction->operand.u[1];
+            }
+
+            DISPATCH_NEXT;
         }
 
-        case OpCode_CALL:
+        OP_CASE(CALL1):
+            operandSize++;
+        OP_CASE(CALL):
         {
             #ifdef ASP_DEBUG
             fputs("CALL", engine->traceFile);
+            #endif
+
+            uint32_t argumentCount = 0;
+            if (operandSize > 0)
+            {
+                /* Fetch the positional argument count from the operand. */
+                AspRunResult operandLoadResult = LoadUnsignedOperand
+                    (engine, operandSize, &argumentCount);
+                if (operandLoadResult != AspRunResult_OK)
+                {
+                    #ifdef ASP_DEBUG
+                    fputs(" ?\n", engine->traceFile);
+                    #endif
+                    return operandLoadResult;
+                }
+                #ifdef ASP_DEBUG
+                fprintf(engine->traceFile, " %u", argumentCount);
+                #endif
+            }
+            #ifdef ASP_DEBUG
             if (engine->again)
                 fputs("; again", engine->traceFile);
             fputc('\n', engine->traceFile);
             #endif
 
             AspDataEntry *function = 0, *arguments = 0;
+            bool positional = false;
             if (!engine->again)
             {
                 /* Pop the function off the stack. */
@@ -1409,27 +2410,36 @@ static AspRunResult Step(AspEngine *engine)
                 AspRef(engine, function);
                 AspPop(engine);
 
-                /* Pop argument list off the stack. */
-                arguments = AspTopValue(engine);
-                if (arguments == 0)
-                    return AspRunResult_StackUnderflow;
-                if (AspDataGetType(arguments) != DataType_ArgumentList)
-                    return AspRunResult_UnexpectedType;
-                AspPop(engine);
+                /* Positional argument values remain on the stack to be
+                   bound directly to parameters. A call made by the
+                   application always supplies an argument list, though. */
+                positional = operandSize > 0 && !engine->callFromApp;
+                if (!positional)
+                {
+                    /* Pop argument list off the stack. */
+                    arguments = AspTopValue(engine);
+                    if (arguments == 0)
+                        return AspRunResult_StackUnderflow;
+                    if (AspDataGetType(arguments) != DataType_ArgumentList)
+                        return AspRunResult_UnexpectedType;
+                    AspPop(engine);
+                }
             }
 
-            AspRunResult callResult = AspCallFunction
-                (engine, function, arguments, engine->callFromApp);
+            AspRunResult callResult = positional ?
+                AspCallFunctionPositional(engine, function, argumentCount) :
+                AspCallFunction
+                    (engine, function, arguments, engine->callFromApp);
             if (callResult != AspRunResult_OK)
                 return callResult;
 
             if (function != 0)
                 AspUnref(engine, function);
 
-            break;
+            DISPATCH_NEXT;
         }
 
-        case OpCode_RET:
+        OP_CASE(RET):
         {
             #ifdef ASP_DEBUG
             fputs("RET\n", engine->traceFile);
@@ -1448,10 +2458,19 @@ static AspRunResult Step(AspEngine *engine)
             AspRef(engine, returnValue);
             AspPop(engine);
 
-            /* Discard the function's local namespace. */
-            AspUnref(engine, engine->localNamespace);
-            if (engine->runResult != AspRunResult_OK)
-                return engine->runResult;
+            /* Discard the function's local namespace and slots. */
+            if (engine->localNamespace != 0)
+            {
+                AspUnref(engine, engine->localNamespace);
+                if (engine->runResult != AspRunResult_OK)
+                    return engine->runResult;
+            }
+            if (engine->localSlots != 0)
+            {
+                AspUnref(engine, engine->localSlots);
+                if (engine->runResult != AspRunResult_OK)
+                    return engine->runResult;
+            }
 
             /* Restore the caller's context. */
             AspRunResult restoreFrameResult = AspReturnToCaller(engine);
@@ -1465,14 +2484,14 @@ static AspRunResult Step(AspEngine *engine)
             if (engine->runResult != AspRunResult_OK)
                 return engine->runResult;
 
-            break;
+            DISPATCH_NEXT;
         }
 
-        case OpCode_ADDMOD4:
+        OP_CASE(ADDMOD4):
             operandSize += 2;
-        case OpCode_ADDMOD2:
+        OP_CASE(ADDMOD2):
             operandSize++;
-        case OpCode_ADDMOD1:
+        OP_CASE(ADDMOD1):
             operandSize++;
         {
             #ifdef ASP_DEBUG
@@ -1542,10 +2561,10 @@ static AspRunResult Step(AspEngine *engine)
             if (addResult.inserted)
                 AspUnref(engine, module);
 
-            break;
+            DISPATCH_NEXT;
         }
 
-        case OpCode_XMOD:
+        OP_CASE(XMOD):
         {
             #ifdef ASP_DEBUG
             fputs("XMOD\n", engine->traceFile);
@@ -1558,9 +2577,15 @@ static AspRunResult Step(AspEngine *engine)
             if (AspDataGetType(frame) != DataType_Frame)
                 return AspRunResult_UnexpectedType;
 
+            /* Keep a cycle collection pass in progress informed. */
+            if (engine->cyclePhase == AspCyclePhase_Mark)
+                AspCyclePopFrame(engine, frame);
+
             /* Restore the loader's namespaces and module. */
             engine->localNamespace = AspEntry
                 (engine, AspDataGetFrameLocalNamespaceIndex(frame));
+            engine->localSlots = AspEntry
+                (engine, AspDataGetFrameLocalSlotsIndex(frame));
 
             /* Restore the caller's global namespace and module. */
             AspDataEntry *module = AspEntry
@@ -1581,14 +2606,14 @@ static AspRunResult Step(AspEngine *engine)
             /* Return control to the caller. */
             engine->pc = returnAddress;
 
-            break;
+            DISPATCH_NEXT;
         }
 
-        case OpCode_LDMOD4:
+        OP_CASE(LDMOD4):
             operandSize += 2;
-        case OpCode_LDMOD2:
+        OP_CASE(LDMOD2):
             operandSize++;
-        case OpCode_LDMOD1:
+        OP_CASE(LDMOD1):
             operandSize++;
         {
             #ifdef ASP_DEBUG
@@ -1623,7 +2648,7 @@ static AspRunResult Step(AspEngine *engine)
 
             /* Run the module on first load. */
             if (AspDataGetModuleIsLoaded(module))
-                break;
+                DISPATCH_NEXT;
             AspDataSetModuleIsLoaded(module, true);
 
             /* Set the system __main__ variable to the first loaded module. */
@@ -1644,6 +2669,8 @@ static AspRunResult Step(AspEngine *engine)
                 (frame, AspIndex(engine, engine->module));
             AspDataSetFrameLocalNamespaceIndex
                 (frame, AspIndex(engine, engine->localNamespace));
+            AspDataSetFrameLocalSlotsIndex
+                (frame, AspIndex(engine, engine->localSlots));
             const AspDataEntry *newTop = AspPush(engine, frame);
             if (newTop == 0)
                 return AspRunResult_OutOfDataMemory;
@@ -1654,16 +2681,17 @@ static AspRunResult Step(AspEngine *engine)
             engine->globalNamespace = AspValueEntry
                 (engine, AspDataGetModuleNamespaceIndex(module));
             engine->localNamespace = engine->globalNamespace;
+            engine->localSlots = 0;
 
             /* Transfer control to the module's code. */
             engine->pc = AspDataGetModuleCodeAddress(module);
 
-            break;
+            DISPATCH_NEXT;
         }
 
-        case OpCode_MKARG:
-        case OpCode_MKIGARG:
-        case OpCode_MKDGARG:
+        OP_CASE(MKARG):
+        OP_CASE(MKIGARG):
+        OP_CASE(MKDGARG):
         {
             bool isIterableGroup = opCode == OpCode_MKIGARG;
             bool isDictionaryGroup = opCode == OpCode_MKDGARG;
@@ -1701,14 +2729,14 @@ static AspRunResult Step(AspEngine *engine)
             AspDataSetStackEntryValueIndex
                 (engine->stackTop, AspIndex(engine, argument));
 
-            break;
+            DISPATCH_NEXT;
         }
 
-        case OpCode_MKNARG4:
+        OP_CASE(MKNARG4):
             operandSize += 2;
-        case OpCode_MKNARG2:
+        OP_CASE(MKNARG2):
             operandSize++;
-        case OpCode_MKNARG1:
+        OP_CASE(MKNARG1):
             operandSize++;
         {
             #ifdef ASP_DEBUG
@@ -1747,20 +2775,20 @@ static AspRunResult Step(AspEngine *engine)
             AspDataSetStackEntryValueIndex
                 (engine->stackTop, AspIndex(engine, argument));
 
-            break;
+            DISPATCH_NEXT;
         }
 
-        case OpCode_MKPAR4:
-        case OpCode_MKTGPAR4:
-        case OpCode_MKDGPAR4:
+        OP_CASE(MKPAR4):
+        OP_CASE(MKTGPAR4):
+        OP_CASE(MKDGPAR4):
             operandSize += 2;
-        case OpCode_MKPAR2:
-        case OpCode_MKTGPAR2:
-        case OpCode_MKDGPAR2:
+        OP_CASE(MKPAR2):
+        OP_CASE(MKTGPAR2):
+        OP_CASE(MKDGPAR2):
             operandSize++;
-        case OpCode_MKPAR1:
-        case OpCode_MKTGPAR1:
-        case OpCode_MKDGPAR1:
+        OP_CASE(MKPAR1):
+        OP_CASE(MKTGPAR1):
+        OP_CASE(MKDGPAR1):
             operandSize++;
         {
             bool isTupleGroup =
@@ -1807,14 +2835,14 @@ static AspRunResult Step(AspEngine *engine)
             if (stackEntry == 0)
                 return AspRunResult_OutOfDataMemory;
 
-            break;
+            DISPATCH_NEXT;
         }
 
-        case OpCode_MKDPAR4:
+        OP_CASE(MKDPAR4):
             operandSize += 2;
-        case OpCode_MKDPAR2:
+        OP_CASE(MKDPAR2):
             operandSize++;
-        case OpCode_MKDPAR1:
+        OP_CASE(MKDPAR1):
             operandSize++;
         {
             #ifdef ASP_DEBUG
@@ -1856,10 +2884,10 @@ static AspRunResult Step(AspEngine *engine)
             AspDataSetStackEntryValueIndex
                 (engine->stackTop, AspIndex(engine, parameter));
 
-            break;
+            DISPATCH_NEXT;
         }
 
-        case OpCode_MKFUN:
+        OP_CASE(MKFUN):
         {
             #ifdef ASP_DEBUG
             fputs("MKFUN @", engine->traceFile);
@@ -1916,10 +2944,10 @@ static AspRunResult Step(AspEngine *engine)
             AspDataSetStackEntryValueIndex
                 (engine->stackTop, AspIndex(engine, function));
 
-            break;
+            DISPATCH_NEXT;
         }
 
-        case OpCode_MKKVP:
+        OP_CASE(MKKVP):
         {
             #ifdef ASP_DEBUG
             fputs("MKKVP\n", engine->traceFile);
@@ -1955,17 +2983,17 @@ static AspRunResult Step(AspEngine *engine)
             AspDataSetStackEntryValueIndex
                 (engine->stackTop, AspIndex(engine, keyValuePairEntry));
 
-            break;
+            DISPATCH_NEXT;
         }
 
-        case OpCode_MKR0:
-        case OpCode_MKRS:
-        case OpCode_MKRE:
-        case OpCode_MKRSE:
-        case OpCode_MKRT:
-        case OpCode_MKRST:
-        case OpCode_MKRET:
-        case OpCode_MKR:
+        OP_CASE(MKR0):
+        OP_CASE(MKRS):
+        OP_CASE(MKRE):
+        OP_CASE(MKRSE):
+        OP_CASE(MKRT):
+        OP_CASE(MKRST):
+        OP_CASE(MKRET):
+        OP_CASE(MKR):
         {
             bool hasStart =
                 opCode == OpCode_MKRS ||
@@ -2109,12 +3137,12 @@ static AspRunResult Step(AspEngine *engine)
                 return AspRunResult_OutOfDataMemory;
             AspUnref(engine, range);
 
-            break;
+            DISPATCH_NEXT;
         }
 
-        case OpCode_INS:
-        case OpCode_INSP:
-        case OpCode_BLD:
+        OP_CASE(INS):
+        OP_CASE(INSP):
+        OP_CASE(BLD):
         {
             #ifdef ASP_DEBUG
             fprintf
@@ -2150,6 +3178,7 @@ static AspRunResult Step(AspEngine *engine)
                     if (!AspIsObject(item) &&
                         itemType != DataType_DictionaryNode &&
                         itemType != DataType_NamespaceNode &&
+                        itemType != DataType_SlotAddress &&
                         itemType != DataType_Element)
                         return AspRunResult_UnexpectedType;
                     break;
@@ -2175,6 +3204,7 @@ static AspRunResult Step(AspEngine *engine)
                         if (!AspIsObject(item) &&
                             itemType != DataType_DictionaryNode &&
                             itemType != DataType_NamespaceNode &&
+                            itemType != DataType_SlotAddress &&
                             itemType != DataType_Element)
                             return AspRunResult_UnexpectedType;
                         break;
@@ -2228,10 +3258,22 @@ static AspRunResult Step(AspEngine *engine)
                             (engine, AspDataGetArgumentValueIndex(item));
 
                         AspRunResult expandResult =
-                            (AspDataGetArgumentIsIterableGroup(item) ?
-                             AspExpandIterableGroupArgument :
-                             AspExpandDictionaryGroupArgument)
-                            (engine, container, iterable);
+                            AspDataGetArgumentIsIterableGroup(item) ?
+                            AspExpandIterableGroupArgument
+                                (engine, container, iterable, true) :
+                            AspExpandDictionaryGroupArgument
+                                (engine, container, iterable);
+                        engine->again = false;
+                        if (expandResult == AspRunResult_Again)
+                        {
+                            /* Put the item back for when the instruction
+                               is executed again to continue the
+                               expansion. */
+                            if (AspPush(engine, item) == 0)
+                                return AspRunResult_OutOfDataMemory;
+                            ExecuteAgain(engine);
+                            break;
+                        }
                         if (expandResult != AspRunResult_OK)
                             return expandResult;
 
@@ -2346,11 +3388,11 @@ static AspRunResult Step(AspEngine *engine)
             if (opCode == OpCode_INSP)
                 AspPop(engine);
 
-            break;
+            DISPATCH_NEXT;
         }
 
-        case OpCode_IDX:
-        case OpCode_IDXA:
+        OP_CASE(IDX):
+        OP_CASE(IDXA):
         {
             #ifdef ASP_DEBUG
             fprintf
@@ -2734,20 +3776,20 @@ static AspRunResult Step(AspEngine *engine)
                 return engine->runResult;
             AspUnref(engine, container);
 
-            break;
+            DISPATCH_NEXT;
         }
 
-        case OpCode_MEM4:
-        case OpCode_MEMA4:
+        OP_CASE(MEM4):
+        OP_CASE(MEMA4):
             operandSize += 2;
-        case OpCode_MEM2:
-        case OpCode_MEMA2:
+        OP_CASE(MEM2):
+        OP_CASE(MEMA2):
             operandSize++;
-        case OpCode_MEM1:
-        case OpCode_MEMA1:
+        OP_CASE(MEM1):
+        OP_CASE(MEMA1):
             operandSize++;
-        case OpCode_MEM:
-        case OpCode_MEMA:
+        OP_CASE(MEM):
+        OP_CASE(MEMA):
         {
             bool isAddressInstruction =
                 opCode == OpCode_MEMA ||
@@ -2808,36 +3850,48 @@ static AspRunResult Step(AspEngine *engine)
                 return AspRunResult_UnexpectedType;
 
             /* Look up the variable in the module's namespace, creating
-               it for an address lookup if it doesn't exist. */
-            AspTreeResult memberResult =
-                isAddressInstruction ?
-                AspTreeTryInsertBySymbol
-                    (engine, moduleNamespace,
-                     variableSymbol, engine->noneSingleton) :
-                AspFindSymbol
-                    (engine, moduleNamespace, variableSymbol);
-            if (memberResult.result != AspRunResult_OK)
-                return memberResult.result;
-            if (memberResult.value == 0)
-                return AspRunResult_NameNotFound;
+               it for an address lookup if it doesn't exist. Use the name
+               cache if possible. */
+            AspDataEntry *memberNode = AspFindCachedName
+                (engine, moduleNamespace, variableSymbol,
+                 isAddressInstruction);
+            if (memberNode == 0)
+            {
+                AspTreeResult memberResult =
+                    isAddressInstruction ?
+                    AspTreeTryInsertBySymbol
+                        (engine, moduleNamespace,
+                         variableSymbol, engine->noneSingleton) :
+                    AspFindSymbol
+                        (engine, moduleNamespace, variableSymbol);
+                if (memberResult.result != AspRunResult_OK)
+                    return memberResult.result;
+                if (memberResult.value == 0)
+                    return AspRunResult_NameNotFound;
+                memberNode = memberResult.node;
+                AspCacheName
+                    (engine, moduleNamespace, memberNode,
+                     isAddressInstruction);
+            }
 
             /* Push variable's value or address as applicable. */
             const AspDataEntry *stackEntry = AspPush
                 (engine,
-                 isAddressInstruction ?
-                 memberResult.node : memberResult.value);
+                 isAddressInstruction ? memberNode :
+                 AspValueEntry
+                    (engine, AspDataGetTreeNodeValueIndex(memberNode)));
             if (stackEntry == 0)
                 return AspRunResult_OutOfDataMemory;
 
             AspUnref(engine, module);
 
-            break;
+            DISPATCH_NEXT;
         }
 
-        case OpCode_ABORT:
+        OP_CASE(ABORT):
             return AspRunResult_Abort;
 
-        case OpCode_END:
+        OP_CASE(END):
         {
             #ifdef ASP_DEBUG
             fputs("END\n", engine->traceFile);
@@ -2854,6 +3908,75 @@ static AspRunResult Step(AspEngine *engine)
     return AspRunResult_OK;
 }
 
+#ifdef ASP_THREADED_DISPATCH
+#pragma GCC diagnostic pop
+#endif
+
+static AspRunResult FetchInstruction
+    (AspEngine *engine, uint32_t *stepCount, uint8_t *opCode)
+{
+    /* Do some cycle collection work when free entries run low or while a
+       pass is in progress. Between instructions, every reference is held
+       by an entry the collector can see. */
+    if (engine->freeCount < engine->cycleTriggerCount)
+    {
+        AspRunResult cycleResult = AspCycleStep(engine, engine->cycleLimit);
+        if (cycleResult != AspRunResult_OK)
+            return cycleResult;
+    }
+
+    #ifdef ASP_DEBUG
+    fprintf
+        (engine->traceFile, "@0x%07zX: ",
+         AspProgramCounter(engine));
+    #endif
+
+    (*stepCount)++;
+    engine->instructionAddress = engine->pc;
+
+    /* Use the pre-decoded form of the instruction if available. The next
+       instruction in sequence (or the resolved target of a taken jump) is
+       checked first, falling back to a search when control has been
+       transferred some other way (e.g., a call or return). */
+    const AspDecodedInstruction *instruction = 0;
+    if (engine->decodedCodeEnd != 0 &&
+        engine->pc < engine->decodedCodeEnd->address)
+    {
+        instruction = engine->nextDecodedInstruction;
+        if (instruction == 0 || instruction >= engine->decodedCodeEnd ||
+            instruction->address != engine->pc)
+            instruction = AspFindDecodedInstruction(engine, engine->pc);
+    }
+    engine->decodedInstruction = instruction;
+    if (instruction != 0)
+    {
+        engine->nextDecodedInstruction = instruction + 1;
+        engine->decodedOperandIndex = 0;
+        engine->pc = (instruction + 1)->address;
+        *opCode = instruction->opCode;
+    }
+    else
+    {
+        AspRunResult result = AspLoadCodeBytes(engine, opCode, 1);
+        if (result != AspRunResult_OK)
+            return result;
+    }
+    #ifdef ASP_DEBUG
+    fprintf(engine->traceFile, "0x%02X ", *opCode);
+    #endif
+
+    return AspRunResult_OK;
+}
+
+static void ExecuteAgain(AspEngine *engine)
+{
+    /* Arrange for the current instruction to be fetched again so that it can
+       continue an operation left incomplete. */
+    engine->pc = engine->instructionAddress;
+    engine->nextDecodedInstruction = engine->decodedInstruction;
+    engine->again = true;
+}
+
 static AspRunResult LoadUnsignedWordOperand
     (AspEngine *engine, unsigned operandSize, uint32_t *operand)
 {
@@ -2880,6 +4003,14 @@ static AspRunResult LoadUnsignedOperand
     (AspEngine *engine, unsigned operandSize, uint32_t *operand)
 {
     *operand = 0;
+    if (engine->decodedInstruction != 0)
+    {
+        if (operandSize != 0)
+            *operand = engine->decodedInstruction->operand.u
+                [engine->decodedOperandIndex++];
+        return AspRunResult_OK;
+    }
+
     for (unsigned i = 0; i < operandSize; i++)
     {
         uint8_t c;
@@ -2895,6 +4026,14 @@ static AspRunResult LoadUnsignedOperand
 static AspRunResult LoadSignedOperand
     (AspEngine *engine, unsigned operandSize, int32_t *operand)
 {
+    if (engine->decodedInstruction != 0)
+    {
+        *operand = operandSize == 0 ? 0 :
+            engine->decodedInstruction->operand.s
+                [engine->decodedOperandIndex++];
+        return AspRunResult_OK;
+    }
+
     uint32_t unsignedOperand = 0;
     if (operandSize != 0)
     {
@@ -2927,29 +4066,164 @@ static AspRunResult LoadSignedOperand
 static AspRunResult LoadFloatOperand
     (AspEngine *engine, double *operand)
 {
-    static const uint16_t word = 1;
-    bool be = *(const char *)&word == 0;
+    if (engine->decodedInstruction != 0)
+    {
+        *operand = engine->decodedInstruction->operand.f;
+        return AspRunResult_OK;
+    }
 
     uint8_t data[8];
     AspRunResult loadResult = AspLoadCodeBytes(engine, data, sizeof data);
     if (loadResult != AspRunResult_OK)
         return loadResult;
-    if (!be)
+
+    *operand = AspTranslateFloat(engine, data);
+    return AspRunResult_OK;
+}
+
+static AspRunResult LoadCodeAddressOperand
+    (AspEngine *engine, unsigned operandSize, uint32_t *codeAddress)
+{
+    /* An operand size of zero indicates an absolute address. Otherwise,
+       the operand is a signed offset from the following instruction. */
+    if (operandSize == 0)
+        return LoadUnsignedWordOperand(engine, 4, codeAddress);
+
+    int32_t codeOffset;
+    AspRunResult result = LoadSignedOperand
+        (engine, operandSize, &codeOffset);
+    if (result != AspRunResult_OK)
+        return result;
+    int64_t address = (int64_t)engine->pc + codeOffset;
+    if (address < 0 || address > AspWordMax)
+        return AspRunResult_ValueOutOfRange;
+    *codeAddress = (uint32_t)address;
+    return AspRunResult_OK;
+}
+
+static AspRunResult LoadVariable
+    (AspEngine *engine, int32_t symbol, AspDataEntry **value)
+{
+    /* Look up the variable, trying first the local namespace, and then
+       failing that, the global and system namespaces in turn. Note that a
+       local variable can also defer to the global namespace via a global
+       override. A function that uses slots may not have a local namespace. */
+    const AspDataEntry *node = 0;
+    if (engine->localNamespace != 0 &&
+        engine->localNamespace != engine->globalNamespace)
+    {
+        AspTreeResult findResult = AspFindSymbol
+            (engine, engine->localNamespace, symbol);
+        if (findResult.result != AspRunResult_OK)
+            return findResult.result;
+        node = findResult.node;
+        if (node != 0 && AspDataGetNamespaceNodeIsGlobal(node))
+            node = 0;
+    }
+    if (node == 0)
     {
-        for (unsigned i = 0; i < 4; i++)
+        node = AspFindCachedName
+            (engine, engine->globalNamespace, symbol, false);
+        if (node == 0)
         {
-            data[i] ^= data[7 - i];
-            data[7 - i] ^= data[i];
-            data[i] ^= data[7 - i];
+            AspTreeResult findResult = AspFindSymbol
+                (engine, engine->globalNamespace, symbol);
+            if (findResult.result != AspRunResult_OK)
+                return findResult.result;
+            if (findResult.node == 0)
+            {
+                findResult = AspFindSymbol
+                    (engine, engine->systemNamespace, symbol);
+                if (findResult.result != AspRunResult_OK)
+                    return findResult.result;
+            }
+            if (findResult.node == 0)
+                return AspRunResult_NameNotFound;
+            node = findResult.node;
+            AspCacheName(engine, engine->globalNamespace, node, false);
         }
     }
 
-    /* Convert IEEE 754 binary64 to the native format. */
-    *operand = engine->floatConverter != 0 ?
-        engine->floatConverter(data) : *(double *)data;
+    *value = AspValueEntry(engine, AspDataGetTreeNodeValueIndex(node));
+    if (!AspIsObject(*value))
+        return AspRunResult_UnexpectedType;
+    return AspRunResult_OK;
+}
+
+static AspRunResult LoadVariableAddress
+    (AspEngine *engine, int32_t symbol, AspDataEntry **node)
+{
+    /* Outside of functions, where the local namespace is the global one,
+       use the name cache if possible. */
+    bool isGlobalScope = engine->localNamespace == engine->globalNamespace;
+    if (isGlobalScope)
+    {
+        *node = AspFindCachedName
+            (engine, engine->globalNamespace, symbol, true);
+        if (*node != 0)
+            return AspRunResult_OK;
+    }
+
+    /* Look up the variable, creating it if it doesn't exist. */
+    AspDataEntry *ns = AspLocalNamespace(engine);
+    if (ns == 0)
+        return AspRunResult_OutOfDataMemory;
+    AspTreeResult insertResult = AspTreeTryInsertBySymbol
+        (engine, ns, symbol, engine->noneSingleton);
+    if (insertResult.result != AspRunResult_OK)
+        return insertResult.result;
+
+    if (isGlobalScope)
+        AspCacheName
+            (engine, engine->globalNamespace, insertResult.node, true);
+    else if (AspDataGetNamespaceNodeIsGlobal(insertResult.node))
+    {
+        /* Use global scope because of global override. */
+        insertResult = AspTreeTryInsertBySymbol
+            (engine, engine->globalNamespace,
+             symbol, engine->noneSingleton);
+        if (insertResult.result != AspRunResult_OK)
+            return insertResult.result;
+    }
+
+    *node = insertResult.node;
+    return AspRunResult_OK;
+}
+
+static AspRunResult LoadSlotOperand(AspEngine *engine, uint8_t *slot)
+{
+    /* Ensure we're in the context of a function that uses slots. */
+    if (engine->localSlots == 0)
+        return AspRunResult_InvalidContext;
+
+    uint32_t operand;
+    AspRunResult result = LoadUnsignedOperand(engine, 1, &operand);
+    if (result != AspRunResult_OK)
+        return result;
+    *slot = (uint8_t)operand;
     return AspRunResult_OK;
 }
 
+static AspRunResult LoadSlotVariable
+    (AspEngine *engine, uint8_t slot, AspDataEntry **value)
+{
+    AspRunResult valueResult = AspLocalSlotValue
+        (engine, engine->localSlots, slot, value);
+    if (valueResult != AspRunResult_OK)
+        return valueResult;
+    if (*value != 0)
+        return AspRunResult_OK;
+
+    /* Until the local variable is bound, its name refers to any global or
+       system variable of the same name. */
+    int32_t symbol;
+    AspRunResult symbolResult = AspLocalSlotSymbol
+        (engine, engine->localSlots, slot, &symbol);
+    if (symbolResult != AspRunResult_OK)
+        return symbolResult;
+    return LoadVariable(engine, symbol, value);
+}
+
 #ifdef ASP_DEBUG
 static void PrintOp
     (AspEngine *engine, uint8_t opCode, const OpInfo *ops, size_t opsSize,
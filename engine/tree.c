@@ -7,12 +7,17 @@
 
 #include "tree.h"
 #include "data.h"
+#include "cycle.h"
 #include "compare.h"
+#include "lookup.h"
 
 static AspRunResult Insert
-    (AspEngine *, AspDataEntry *tree, AspDataEntry *node);
+    (AspEngine *, AspDataEntry *tree, AspDataEntry *node,
+     AspDataEntry *parentNode, bool rightChild);
 static AspDataEntry *FindNode
-    (AspEngine *, const AspDataEntry *tree, const AspDataEntry *keyNode);
+    (AspEngine *, const AspDataEntry *tree,
+     const AspDataEntry *key, int32_t symbol,
+     AspDataEntry **parentNode, bool *right);
 static AspDataEntry *GetLimitNode
     (AspEngine *, const AspDataEntry *tree, AspDataEntry *node, bool right);
 static AspRunResult Shift
@@ -22,8 +27,8 @@ static AspRunResult Rotate
     (AspEngine *, AspDataEntry *tree, AspDataEntry *node, bool right);
 static AspRunResult CompareKeys
     (AspEngine *, const AspDataEntry *tree,
-     const AspDataEntry *leftNode, const AspDataEntry *rightNode,
-     int *comparison);
+     const AspDataEntry *key, int32_t symbol,
+     const AspDataEntry *node, int *comparison);
 static AspRunResult SetChildIndex
     (AspEngine *, AspDataEntry *node, bool right, uint32_t index);
 static uint32_t GetChildIndex
@@ -77,20 +82,12 @@ AspTreeResult AspTreeInsert
         return result;
     }
 
-    /* Allocate a node entry and link it to the given key. */
-    result.node = AspAllocEntry
-        (engine,
-         treeType == DataType_Dictionary ?
-         DataType_DictionaryNode : DataType_SetNode);
-    if (result.node == 0)
-    {
-        result.result = AspRunResult_OutOfDataMemory;
-        return result;
-    }
-    AspDataSetTreeNodeKeyIndex(result.node, AspIndex(engine, key));
-
-    /* Determine whether the key already exists. */
-    AspDataEntry *foundNode = FindNode(engine, tree, result.node);
+    /* Determine whether the key already exists, noting where to insert it
+       if not. */
+    AspDataEntry *parentNode;
+    bool right;
+    AspDataEntry *foundNode = FindNode
+        (engine, tree, key, 0, &parentNode, &right);
     if (engine->runResult != AspRunResult_OK)
     {
         result.result = engine->runResult;
@@ -98,12 +95,6 @@ AspTreeResult AspTreeInsert
     }
     if (foundNode != 0)
     {
-        AspUnref(engine, result.node);
-        if (engine->runResult != AspRunResult_OK)
-        {
-            result.result = engine->runResult;
-            return result;
-        }
         result.node = foundNode;
         result.key = AspValueEntry
             (engine, AspDataGetTreeNodeKeyIndex(foundNode));
@@ -132,7 +123,18 @@ AspTreeResult AspTreeInsert
         return result;
     }
 
-    /* Link the new node to the value if applicable. */
+    /* Allocate a node entry and link it to the given key, and to the value
+       if applicable. */
+    result.node = AspAllocEntry
+        (engine,
+         treeType == DataType_Dictionary ?
+         DataType_DictionaryNode : DataType_SetNode);
+    if (result.node == 0)
+    {
+        result.result = AspRunResult_OutOfDataMemory;
+        return result;
+    }
+    AspDataSetTreeNodeKeyIndex(result.node, AspIndex(engine, key));
     AspRef(engine, key);
     result.key = key;
     AspDataSetTreeNodeValueIndex(result.node, AspIndex(engine, value));
@@ -143,7 +145,7 @@ AspTreeResult AspTreeInsert
     }
     result.inserted = true;
 
-    result.result = Insert(engine, tree, result.node);
+    result.result = Insert(engine, tree, result.node, parentNode, right);
 
     return result;
 }
@@ -163,10 +165,22 @@ AspTreeResult AspTreeTryInsertBySymbol
     if (result.result != AspRunResult_OK)
         return result;
 
-    /* Determine whether the symbol already exists. */
-    result = AspFindSymbol(engine, tree, symbol);
-    if (result.result != AspRunResult_OK || result.node != 0)
+    /* Determine whether the symbol already exists, noting where to insert
+       it if not. */
+    AspDataEntry *parentNode;
+    bool right;
+    result.node = FindNode(engine, tree, 0, symbol, &parentNode, &right);
+    if (engine->runResult != AspRunResult_OK)
+    {
+        result.result = engine->runResult;
+        return result;
+    }
+    if (result.node != 0)
+    {
+        result.value = AspValueEntry
+            (engine, AspDataGetTreeNodeValueIndex(result.node));
         return result;
+    }
 
     /* Allocate a node entry, assign it the given symbol, and link it to
        the given value. */
@@ -182,7 +196,11 @@ AspTreeResult AspTreeTryInsertBySymbol
     result.value = value;
     result.inserted = true;
 
-    result.result = Insert(engine, tree, result.node);
+    result.result = Insert(engine, tree, result.node, parentNode, right);
+
+    /* Invalidate cached lookups that may be affected by the new name. */
+    if (!AspDataGetNamespaceIsLocal(tree))
+        AspInvalidateNameCache(engine);
 
     return result;
 }
@@ -200,12 +218,27 @@ AspRunResult AspTreeEraseNode
     if (result != AspRunResult_OK)
         return result;
 
-    AspDataEntry *node = FindNode(engine, tree, keyNode);
+    bool isNamespace = AspDataGetType(tree) == DataType_Namespace;
+    AspDataEntry *node = FindNode
+        (engine, tree,
+         isNamespace ? 0 :
+         AspValueEntry(engine, AspDataGetTreeNodeKeyIndex(keyNode)),
+         isNamespace ? AspDataGetNamespaceNodeSymbol(keyNode) : 0,
+         0, 0);
     if (engine->runResult != AspRunResult_OK)
         return engine->runResult;
     if (node == 0)
         return NotFoundResult(tree);
 
+    /* Keep a cycle collection pass in progress informed. */
+    if (engine->cyclePhase == AspCyclePhase_Mark)
+        AspCycleEraseMember(engine, tree, node);
+
+    /* Invalidate cached lookups that may refer to the node. */
+    if (AspDataGetType(tree) == DataType_Namespace &&
+        !AspDataGetNamespaceIsLocal(tree))
+        AspInvalidateNameCache(engine);
+
     /* Remove node from tree and determine whether rebalancing is required. */
     bool rebalance = AspDataGetTreeNodeIsBlack(node);
     uint32_t nodeIndex = AspIndex(engine, node);
@@ -461,17 +494,7 @@ AspTreeResult AspTreeFind
         return result;
     }
 
-    AspDataEntry *keyNode = AspAllocEntry
-        (engine,
-         treeType == DataType_Dictionary ?
-         DataType_DictionaryNode : DataType_SetNode);
-    if (keyNode == 0)
-    {
-        result.result = AspRunResult_OutOfDataMemory;
-        return result;
-    }
-    AspDataSetTreeNodeKeyIndex(keyNode, AspIndex(engine, key));
-    result.node = FindNode(engine, tree, keyNode);
+    result.node = FindNode(engine, tree, key, 0, 0, 0);
     if (engine->runResult != AspRunResult_OK)
     {
         result.result = engine->runResult;
@@ -480,12 +503,6 @@ AspTreeResult AspTreeFind
     if (result.node != 0 && treeType != DataType_Set)
         result.value = AspValueEntry
             (engine, AspDataGetTreeNodeValueIndex(result.node));
-    AspUnref(engine, keyNode);
-    if (engine->runResult != AspRunResult_OK)
-    {
-        result.result = engine->runResult;
-        return result;
-    }
 
     return result;
 }
@@ -502,14 +519,7 @@ AspTreeResult AspFindSymbol
     if (result.result != AspRunResult_OK)
         return result;
 
-    AspDataEntry *keyNode = AspAllocEntry(engine, DataType_NamespaceNode);
-    if (keyNode == 0)
-    {
-        result.result = AspRunResult_OutOfDataMemory;
-        return result;
-    }
-    AspDataSetNamespaceNodeSymbol(keyNode, symbol);
-    result.node = FindNode(engine, tree, keyNode);
+    result.node = FindNode(engine, tree, 0, symbol, 0, 0);
     if (engine->runResult != AspRunResult_OK)
     {
         result.result = engine->runResult;
@@ -518,12 +528,6 @@ AspTreeResult AspFindSymbol
     if (result.node != 0)
         result.value = AspValueEntry
             (engine, AspDataGetTreeNodeValueIndex(result.node));
-    AspUnref(engine, keyNode);
-    if (engine->runResult != AspRunResult_OK)
-    {
-        result.result = engine->runResult;
-        return result;
-    }
 
     return result;
 }
@@ -594,7 +598,8 @@ AspTreeResult AspTreeNext
 }
 
 static AspRunResult Insert
-    (AspEngine *engine, AspDataEntry *tree, AspDataEntry *node)
+    (AspEngine *engine, AspDataEntry *tree, AspDataEntry *node,
+     AspDataEntry *parentNode, bool rightChild)
 {
     AspRunResult result = AspRunResult_OK;
 
@@ -605,40 +610,15 @@ static AspRunResult Insert
     if (result != AspRunResult_OK)
         return result;
 
-    AspDataEntry *parentNode = 0;
-    AspDataEntry *targetNode = AspEntry(engine, AspDataGetTreeRootIndex(tree));
-    uint32_t iterationCount = 0;
-    for (;
-         iterationCount < engine->cycleDetectionLimit && targetNode != 0;
-         iterationCount++)
-    {
-        parentNode = targetNode;
-        int comparison;
-        AspRunResult compareResult = CompareKeys
-            (engine, tree, node, targetNode, &comparison);
-        if (compareResult != AspRunResult_OK)
-            return compareResult;
-        uint32_t childIndex = GetChildIndex
-            (engine, targetNode, comparison > 0);
-        targetNode = AspEntry(engine, childIndex);
-    }
-    if (iterationCount >= engine->cycleDetectionLimit)
-        return AspRunResult_CycleDetected;
-
+    /* Link the node as the given child of the parent determined by an
+       earlier search of the tree. */
     AspDataSetTreeNodeParentIndex(node, AspIndex(engine, parentNode));
     uint32_t nodeIndex = AspIndex(engine, node);
     if (parentNode == 0)
         AspDataSetTreeRootIndex(tree, nodeIndex);
     else
     {
-        int comparison;
-        AspRunResult compareResult = CompareKeys
-            (engine, tree, node, parentNode, &comparison);
-        if (compareResult != AspRunResult_OK)
-            return compareResult;
-        result = SetChildIndex
-            (engine, parentNode, comparison > 0,
-             nodeIndex);
+        result = SetChildIndex(engine, parentNode, rightChild, nodeIndex);
         if (result != AspRunResult_OK)
             return result;
 
@@ -710,16 +690,20 @@ static AspRunResult Insert
 }
 
 static AspDataEntry *FindNode
-    (AspEngine *engine, const AspDataEntry *tree, const AspDataEntry *keyNode)
+    (AspEngine *engine, const AspDataEntry *tree,
+     const AspDataEntry *key, int32_t symbol,
+     AspDataEntry **parentNode, bool *right)
 {
-    AspAssert
-        (engine, tree != 0 && IsTreeType(AspDataGetType(tree)));
     AspRunResult assertResult = AspAssert
-        (engine, keyNode != 0 && IsNodeType(AspDataGetType(keyNode)));
+        (engine, tree != 0 && IsTreeType(AspDataGetType(tree)));
     if (assertResult != AspRunResult_OK)
         return 0;
 
+    /* Search for the key (or symbol, for namespaces). If not found, report
+       the node under which it would be inserted, and on which side. */
     AspDataEntry *node = AspEntry(engine, AspDataGetTreeRootIndex(tree));
+    AspDataEntry *lastNode = 0;
+    bool lastRight = false;
     uint32_t iterationCount = 0;
     for (;
          iterationCount < engine->cycleDetectionLimit && node != 0;
@@ -727,14 +711,16 @@ static AspDataEntry *FindNode
     {
         int comparison;
         AspRunResult compareResult = CompareKeys
-            (engine, tree, keyNode, node, &comparison);
+            (engine, tree, key, symbol, node, &comparison);
         assertResult = AspAssert(engine, compareResult == AspRunResult_OK);
         if (assertResult != AspRunResult_OK)
             return 0;
         if (comparison == 0)
             break;
+        lastNode = node;
+        lastRight = comparison > 0;
         AspDataEntry *nextNode = AspEntry
-            (engine, GetChildIndex(engine, node, comparison > 0));
+            (engine, GetChildIndex(engine, node, lastRight));
         assertResult = AspAssert(engine, nextNode != node);
         if (assertResult != AspRunResult_OK)
             return 0;
@@ -746,6 +732,10 @@ static AspDataEntry *FindNode
         return 0;
     }
 
+    if (parentNode != 0)
+        *parentNode = lastNode;
+    if (right != 0)
+        *right = lastRight;
     return node;
 }
 
@@ -864,35 +854,55 @@ static AspRunResult Rotate
 
 static AspRunResult CompareKeys
     (AspEngine *engine, const AspDataEntry *tree,
-     const AspDataEntry *leftNode, const AspDataEntry *rightNode,
-     int *comparison)
+     const AspDataEntry *key, int32_t symbol,
+     const AspDataEntry *node, int *comparison)
 {
     *comparison = 0;
     AspAssert
         (engine, tree != 0 && IsTreeType(AspDataGetType(tree)));
-    AspAssert
-        (engine, leftNode != 0 && IsNodeType(AspDataGetType(leftNode)));
     AspRunResult assertResult = AspAssert
-        (engine, rightNode != 0 && IsNodeType(AspDataGetType(rightNode)));
+        (engine, node != 0 && IsNodeType(AspDataGetType(node)));
     if (assertResult != AspRunResult_OK)
         return assertResult;
 
-    /* For namespaces, compare the symbols. Otherwise, compare objects. */
+    /* For namespaces, compare the symbols. */
     if (AspDataGetType(tree) == DataType_Namespace)
     {
-        int32_t leftSymbol = AspDataGetNamespaceNodeSymbol(leftNode);
-        int32_t rightSymbol = AspDataGetNamespaceNodeSymbol(rightNode);
+        int32_t nodeSymbol = AspDataGetNamespaceNodeSymbol(node);
         *comparison =
-            leftSymbol == rightSymbol ? 0 :
-            leftSymbol < rightSymbol ? -1 : 1;
+            symbol == nodeSymbol ? 0 :
+            symbol < nodeSymbol ? -1 : 1;
         return AspRunResult_OK;
     }
-    else
-        return AspCompare
-            (engine,
-             AspValueEntry(engine, AspDataGetTreeNodeKeyIndex(leftNode)),
-             AspValueEntry(engine, AspDataGetTreeNodeKeyIndex(rightNode)),
-             AspCompareType_Key, comparison, 0);
+
+    /* Otherwise, compare objects. The same object is always equal to
+       itself, and integer and string keys of the same type are compared
+       directly, avoiding the general comparison's setup. */
+    const AspDataEntry *nodeKey = AspValueEntry
+        (engine, AspDataGetTreeNodeKeyIndex(node));
+    assertResult = AspAssert(engine, key != 0 && nodeKey != 0);
+    if (assertResult != AspRunResult_OK)
+        return assertResult;
+    if (key == nodeKey)
+        return AspRunResult_OK;
+    uint8_t keyType = AspDataGetType(key);
+    if (keyType == AspDataGetType(nodeKey))
+    {
+        if (keyType == DataType_Integer)
+        {
+            int32_t
+                keyValue = AspDataGetInteger(key),
+                nodeValue = AspDataGetInteger(nodeKey);
+            *comparison =
+                keyValue == nodeValue ? 0 :
+                keyValue < nodeValue ? -1 : 1;
+            return AspRunResult_OK;
+        }
+        else if (keyType == DataType_String)
+            return AspCompareStrings(engine, key, nodeKey, comparison);
+    }
+    return AspCompare
+        (engine, key, nodeKey, AspCompareType_Key, comparison, 0);
 }
 
 static AspRunResult SetChildIndex
@@ -52,6 +52,8 @@ const char *AspRunResultToString(int result)
             return "Stack underflow";
         case AspRunResult_CycleDetected:
             return "Cycle detected";
+        case AspRunResult_StackOverflow:
+            return "Stack overflow";
         case AspRunResult_InvalidContext:
             return "Invalid context";
         case AspRunResult_Redundant:
@@ -82,8 +84,12 @@ const char *AspRunResultToString(int result)
             return "Divide by zero";
         case AspRunResult_ArithmeticOverflow:
             return "Arithmetic overflow";
+        case AspRunResult_NestingTooDeep:
+            return "Nesting too deep";
         case AspRunResult_OutOfDataMemory:
             return "Out of data memory";
+        case AspRunResult_Wait:
+            return "Wait";
         case AspRunResult_Again:
             return "Again";
         case AspRunResult_Abort:
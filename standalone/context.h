@@ -5,12 +5,17 @@
 #ifndef ASPS_CONTEXT_H
 #define ASPS_CONTEXT_H
 
-#include <ctime>
+#include <chrono>
 
 typedef struct
 {
-    bool sleeping;
-    clock_t expiry;
+    // Time at which a sleeping script is woken.
+    std::chrono::steady_clock::time_point expiry;
+
+    // Fork state. The fork count is set when the script asks to be cloned,
+    // and the clone index is assigned to each clone (-1 if not a clone).
+    unsigned forkCount;
+    int cloneIndex;
 } StandaloneAspContext;
 
 #endif
@@ -0,0 +1,171 @@
+//
+// Standalone Asp application event loop implementation.
+//
+
+#include "event-loop.hpp"
+#include <chrono>
+#ifdef _WIN32
+#include <thread>
+#else
+#include <ctime>
+#endif
+
+using namespace std;
+
+// Units of deferred destruction work to do between checks of the time
+// while idle.
+static const uint32_t IDLE_COLLECT_LIMIT = 64;
+
+static void SleepFor(chrono::steady_clock::duration);
+
+EventLoop::EventLoop
+    (uint32_t runStepCount, const atomic<bool> &interrupted,
+     uint32_t snapshotInterval) :
+    runStepCount(runStepCount),
+    interrupted(interrupted),
+    snapshotInterval(snapshotInterval)
+{
+}
+
+void EventLoop::Add
+    (AspEngine *engine, StandaloneAspContext *context,
+     unsigned stepCountLimit)
+{
+    Task task = {engine, context, stepCountLimit, AspRunResult_OK, 0, 0};
+    tasks.push_back(task);
+}
+
+void EventLoop::Run()
+{
+    while (!interrupted)
+    {
+        // Give each runnable engine a turn, first waking any whose wait
+        // has expired.
+        bool active = false, ran = false;
+        auto wakeTime = chrono::steady_clock::time_point::max();
+        for (auto &task: tasks)
+        {
+            if (!IsActive(task))
+                continue;
+            active = true;
+
+            if (task.runResult == AspRunResult_Wait)
+            {
+                auto expiry = task.context->expiry;
+                if (chrono::steady_clock::now() < expiry)
+                {
+                    if (expiry < wakeTime)
+                        wakeTime = expiry;
+                    continue;
+                }
+                task.runResult = AspWake
+                    (task.engine, task.context, AspRunResult_OK);
+                if (task.runResult != AspRunResult_OK)
+                    continue;
+            }
+
+            RunTask(task);
+            ran = true;
+        }
+        if (!active)
+            break;
+        if (ran)
+            continue;
+
+        // Every engine is waiting. Use the idle time to complete any
+        // deferred destruction, and then sleep until the earliest wake
+        // time.
+        for (auto &task: tasks)
+        {
+            if (!IsActive(task))
+                continue;
+            while (!AspCollect(task.engine, IDLE_COLLECT_LIMIT) &&
+                   chrono::steady_clock::now() < wakeTime)
+                ;
+        }
+        auto now = chrono::steady_clock::now();
+        if (now < wakeTime)
+            SleepFor(wakeTime - now);
+    }
+}
+
+size_t EventLoop::TaskCount() const
+{
+    return tasks.size();
+}
+
+const EventLoop::Task &EventLoop::TaskAt(size_t index) const
+{
+    return tasks.at(index);
+}
+
+bool EventLoop::IsActive(const Task &task) const
+{
+    return
+        (task.runResult == AspRunResult_OK ||
+         task.runResult == AspRunResult_Wait) &&
+        task.context->forkCount == 0 &&
+        (task.stepCountLimit == UINT_MAX ||
+         task.stepCount < task.stepCountLimit);
+}
+
+void EventLoop::RunTask(Task &task)
+{
+    if (runStepCount == 0)
+    {
+        task.runResult = AspStep(task.engine);
+        task.stepCount++;
+    }
+    else
+    {
+        uint32_t runLimit = runStepCount, runCount;
+        if (task.stepCountLimit != UINT_MAX &&
+            task.stepCountLimit - task.stepCount < runLimit)
+            runLimit = task.stepCountLimit - task.stepCount;
+        if (snapshotInterval != 0 &&
+            snapshotInterval - (task.stepCount - task.snapshotStepCount) <
+            runLimit)
+            runLimit =
+                snapshotInterval - (task.stepCount - task.snapshotStepCount);
+        task.runResult = AspRunFor(task.engine, runLimit, &runCount);
+        task.stepCount += runCount;
+    }
+
+    if (snapshotInterval != 0 && task.runResult == AspRunResult_OK &&
+        task.stepCount - task.snapshotStepCount >= snapshotInterval)
+    {
+        task.snapshotStepCount = task.stepCount;
+        task.runResult = RestoreTask(task);
+    }
+}
+
+AspRunResult EventLoop::RestoreTask(Task &task)
+{
+    // Save the run state, discard it by restarting the engine, and then
+    // continue from the saved state.
+    snapshot.resize(AspSnapshotSize(task.engine));
+    AspRunResult result = AspSnapshot
+        (task.engine, snapshot.data(), snapshot.size());
+    if (result == AspRunResult_OK)
+        result = AspRestart(task.engine);
+    if (result == AspRunResult_OK)
+        result = AspRestore(task.engine, snapshot.data(), snapshot.size());
+    return result;
+}
+
+static void SleepFor(chrono::steady_clock::duration duration)
+{
+    // Sleep for a relative interval, which is unaffected by changes to the
+    // system time. A signal (e.g., an interrupt) ends the sleep early,
+    // letting the caller react to it.
+    #ifdef _WIN32
+    this_thread::sleep_for(duration);
+    #else
+    auto nanoseconds = chrono::duration_cast<chrono::nanoseconds>
+        (duration).count();
+    timespec request;
+    request.tv_sec = static_cast<time_t>(nanoseconds / 1000000000);
+    request.tv_nsec = static_cast<long>(nanoseconds % 1000000000);
+    nanosleep(&request, nullptr);
+    #endif
+}
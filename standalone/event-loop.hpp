@@ -0,0 +1,71 @@
+//
+// Standalone Asp application event loop definitions.
+//
+
+#ifndef EVENT_LOOP_HPP
+#define EVENT_LOOP_HPP
+
+#include "asp.h"
+#include "context.h"
+#include <atomic>
+#include <vector>
+#include <climits>
+#include <cstdint>
+
+// Runs one or more engines on the calling thread. Runnable engines are
+// given a turn each in rotation. When every remaining engine is waiting,
+// idle time is used to complete deferred destruction, after which the
+// thread sleeps until the earliest wake time. When a snapshot interval is
+// given, the run state of each engine is saved, discarded and restored at
+// that interval, which must not change the outcome of the run.
+class EventLoop
+{
+    public:
+
+        // Per-engine run state.
+        struct Task
+        {
+            AspEngine *engine;
+            StandaloneAspContext *context;
+            unsigned stepCountLimit;
+            AspRunResult runResult;
+            unsigned stepCount;
+            unsigned snapshotStepCount;
+        };
+
+        // Constructor.
+        EventLoop
+            (std::uint32_t runStepCount,
+             const std::atomic<bool> &interrupted,
+             std::uint32_t snapshotInterval = 0);
+
+        // Engine addition method.
+        void Add
+            (AspEngine *, StandaloneAspContext *,
+             unsigned stepCountLimit = UINT_MAX);
+
+        // Run method. Returns when no engine can make further progress
+        // (i.e., each has ended, failed, requested a fork, or reached its
+        // step count limit), or when interrupted.
+        void Run();
+
+        // Result access methods.
+        std::size_t TaskCount() const;
+        const Task &TaskAt(std::size_t) const;
+
+    private:
+
+        // Task operations.
+        bool IsActive(const Task &) const;
+        void RunTask(Task &);
+        AspRunResult RestoreTask(Task &);
+
+        // Data.
+        std::uint32_t runStepCount;
+        const std::atomic<bool> &interrupted;
+        std::uint32_t snapshotInterval;
+        std::vector<Task> tasks;
+        std::vector<std::uint8_t> snapshot;
+};
+
+#endif
@@ -0,0 +1,44 @@
+//
+// Standalone Asp application functions implementation: fork.
+//
+
+#include "asp.h"
+#include "standalone.h"
+#include "context.h"
+
+/* fork(n)
+ * Run n clones of the program from this point, by default each on its own
+ * thread.
+ * Return the index of the clone, from 0 to n - 1.
+ */
+extern "C" AspRunResult asp_fork
+    (AspEngine *engine,
+     AspDataEntry *n,
+     AspDataEntry **returnValue)
+{
+    auto context = static_cast<StandaloneAspContext *>
+        (AspContext(engine));
+
+    if (!AspAgain(engine))
+    {
+        // Clones cannot fork in turn.
+        if (context->cloneIndex >= 0)
+            return AspRunResult_InvalidState;
+
+        int32_t nValue;
+        if (!AspIntegerValue(n, &nValue))
+            return AspRunResult_UnexpectedType;
+        if (nValue <= 0)
+            return AspRunResult_ValueOutOfRange;
+        context->forkCount = static_cast<unsigned>(nValue);
+        return AspRunResult_Again;
+    }
+
+    // The application clones the engine when control returns to it, after
+    // which each clone completes the call with its own index.
+    if (context->cloneIndex < 0)
+        return AspRunResult_Again;
+    *returnValue = AspNewInteger(engine, context->cloneIndex);
+    return *returnValue == 0 ?
+        AspRunResult_OutOfDataMemory : AspRunResult_OK;
+}
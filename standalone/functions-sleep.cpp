@@ -5,8 +5,7 @@
 #include "asp.h"
 #include "standalone.h"
 #include "context.h"
-#include <ctime>
-#include <cmath>
+#include <chrono>
 
 /* sleep(s)
  * Sleep for s seconds.
@@ -19,18 +18,16 @@ extern "C" AspRunResult asp_sleep
     auto context = static_cast<StandaloneAspContext *>
         (AspContext(engine));
 
-    clock_t ticks = clock();
+    // Once woken, the sleep is over.
+    if (AspAgain(engine))
+        return AspRunResult_OK;
 
-    if (!AspAgain(engine))
-    {
-        double secValue;
-        if (!AspFloatValue(sec, &secValue))
-            return AspRunResult_UnexpectedType;
-        context->expiry =
-            ticks + static_cast<clock_t>(round(CLOCKS_PER_SEC * secValue));
-        context->sleeping = true;
-        return AspRunResult_Again;
-    }
-
-    return ticks < context->expiry ? AspRunResult_Again : AspRunResult_OK;
+    double secValue;
+    if (!AspFloatValue(sec, &secValue))
+        return AspRunResult_UnexpectedType;
+    context->expiry =
+        std::chrono::steady_clock::now() +
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>
+            (std::chrono::duration<double>(secValue));
+    return AspWait(engine, context);
 }
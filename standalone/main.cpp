@@ -6,13 +6,18 @@
 #include "asp-info.h"
 #include "standalone.h"
 #include "context.h"
+#include "event-loop.hpp"
+#include <atomic>
 #include <ctime>
+#include <chrono>
 #include <csignal>
 #include <iostream>
 #include <iomanip>
 #include <cstdio>
 #include <set>
 #include <string>
+#include <thread>
+#include <vector>
 #include <new>
 #include <cstring>
 #include <memory>
@@ -33,11 +38,14 @@
 using namespace std;
 
 static const size_t DEFAULT_DATA_ENTRY_COUNT = 2048;
+static const uint32_t DEFAULT_RUN_STEP_COUNT = 1000;
 
 static AspRunResult LoadCodePage
     (void *, uint32_t offset, size_t *size, void *codePage);
 static void HandleInterrupt(int);
-static bool Interrupted = false;
+
+// Set by the interrupt handler and read by the main and clone threads.
+static atomic<bool> Interrupted(false);
 
 static void Usage()
 {
@@ -69,6 +77,15 @@ static void Usage()
     cerr
         << ":\n"
         << COMMAND_OPTION_PREFIXES[0]
+        << "b n        Number of instructions to execute per call to the"
+        << " engine. Control\n"
+        << "            returns to the application sooner if the script ends,"
+        << " an error\n"
+        << "            occurs, or an application function needs servicing."
+        << " Specifying 0\n"
+        << "            steps one instruction per call (AspStep)."
+        << " Default is " << DEFAULT_RUN_STEP_COUNT << ".\n"
+        << COMMAND_OPTION_PREFIXES[0]
         << "c n        Code size, in bytes."
         << " The default behaviour is to determine the size\n"
         << "            from the SCRIPT file."
@@ -79,7 +96,46 @@ static void Usage()
         << AspDataEntrySize() << " bytes."
         << " Default is " << DEFAULT_DATA_ENTRY_COUNT << ".\n"
         << COMMAND_OPTION_PREFIXES[0]
+        << "g n        Destruction work limit. When nonzero, objects whose"
+        << " contents must\n"
+        << "            be released when they are destroyed are queued, and at"
+        << " most n units\n"
+        << "            of queued work are done per release, bounding the"
+        << " time taken by\n"
+        << "            any one instruction. The default is 0, which destroys"
+        << " objects in\n"
+        << "            full at once.\n"
+        << COMMAND_OPTION_PREFIXES[0]
         << "h          Print usage information and exit.\n"
+        << COMMAND_OPTION_PREFIXES[0]
+        << "i n        Number of instructions to pre-decode when the code is"
+        << " sealed, where\n"
+        << "            each decoded instruction occupies "
+        << AspDecodedInstructionSize() << " bytes. The default is 0,\n"
+        << "            which disables pre-decoding. Ignored in paging mode.\n"
+        << COMMAND_OPTION_PREFIXES[0]
+        << "j n        Number of threads on which to run the clones created"
+        << " when the\n"
+        << "            script forks. Clones sharing a thread are multiplexed"
+        << " by its event\n"
+        << "            loop. The default is 0, which runs each clone on its"
+        << " own thread.\n"
+        << COMMAND_OPTION_PREFIXES[0]
+        << "k n        String literal cache size, in entries. When nonzero,"
+        << " the cache is\n"
+        << "            reserved from the data area and lets repeated"
+        << " executions of a\n"
+        << "            string literal share one object. The default is 0,"
+        << " which disables\n"
+        << "            the cache.\n"
+        << COMMAND_OPTION_PREFIXES[0]
+        << "l n        Name lookup cache size, in entries. When nonzero,"
+        << " the cache is\n"
+        << "            reserved from the data area and speeds up repeated"
+        << " lookups of\n"
+        << "            global and module variables. The default is 0,"
+        << " which disables\n"
+        << "            the cache.\n"
         #ifdef ASP_DEBUG
         << COMMAND_OPTION_PREFIXES[0]
         << "n n        Number of instructions to execute before exiting."
@@ -91,6 +147,20 @@ static void Usage()
         << " disables paging\n"
         << "            mode. The number of pages is this value divided by the"
         << " code size.\n"
+        << COMMAND_OPTION_PREFIXES[0]
+        << "r m..n     Range of integers to preallocate. Each integer in the"
+        << " range is\n"
+        << "            reserved from the data area and reused whenever the"
+        << " value is\n"
+        << "            needed. The default is to preallocate none.\n"
+        << COMMAND_OPTION_PREFIXES[0]
+        << "s n        Stack depth, in entries. When nonzero, a fixed stack"
+        << " region of n\n"
+        << "            data entries is reserved from the data area, and"
+        << " exceeding it is\n"
+        << "            reported as a stack overflow. The default is 0, which"
+        << " allocates\n"
+        << "            stack entries from the data area as needed.\n"
         #ifdef ASP_DEBUG
         << COMMAND_OPTION_PREFIXES[0]
         << "t file     Trace output file."
@@ -121,7 +191,46 @@ static void Usage()
         << COMMAND_OPTION_PREFIXES[0] << "U option.\n"
         #endif
         << COMMAND_OPTION_PREFIXES[0]
-        << "v          Verbose. Output version and statistical information.\n"
+        << "v          Verbose. Output version and statistical information,"
+        << " including\n"
+        << "            the instruction execution rate.\n"
+        << COMMAND_OPTION_PREFIXES[0]
+        << "w n        Operation work limit. When nonzero, sequence"
+        << " repetition, string\n"
+        << "            formatting and group argument expansion do at most n"
+        << " units of work\n"
+        << "            per step, continuing over as many steps as needed."
+        << " The default is\n"
+        << "            0, which completes each operation in one step.\n"
+        << COMMAND_OPTION_PREFIXES[0]
+        << "x n        Cycle collection trigger, in free data entries. When"
+        << " nonzero, a map\n"
+        << "            of marks is reserved from the data area, and a pass to"
+        << " reclaim\n"
+        << "            unreachable reference cycles starts whenever fewer"
+        << " than n data\n"
+        << "            entries are free. The default is 0, which disables"
+        << " cycle\n"
+        << "            collection.\n"
+        << COMMAND_OPTION_PREFIXES[0]
+        << "y n        Cycle collection work limit. When nonzero, at most n"
+        << " units of cycle\n"
+        << "            collection work are done per instruction while a pass"
+        << " is in\n"
+        << "            progress. The default is 0, which completes each pass"
+        << " at once.\n"
+        << COMMAND_OPTION_PREFIXES[0]
+        << "z n        Snapshot interval, in instructions. When nonzero, the"
+        << " run state is\n"
+        << "            saved with AspSnapshot every n instructions, the engine"
+        << " is\n"
+        << "            restarted, and the run continues from the state restored"
+        << " with\n"
+        << "            AspRestore. The output is the same as without this"
+        << " option. The\n"
+        << "            default is 0, which takes no snapshots. Not supported in"
+        << " paging\n"
+        << "            mode.\n"
         ;
 }
 
@@ -144,6 +253,19 @@ int main(int argc, char **argv)
     bool verbose = false;
     size_t codeByteCount = 0, codePageByteCount = 0;
     size_t dataEntryCount = DEFAULT_DATA_ENTRY_COUNT;
+    size_t decodedInstructionCount = 0;
+    size_t stackDepth = 0;
+    uint32_t collectLimit = 0;
+    uint32_t workLimit = 0;
+    size_t cycleTriggerCount = 0;
+    uint32_t cycleLimit = 0;
+    size_t nameCacheSize = 0;
+    size_t stringCacheSize = 0;
+    bool cacheIntegers = false;
+    int32_t integerCacheMin = 0, integerCacheMax = 0;
+    uint32_t runStepCount = DEFAULT_RUN_STEP_COUNT;
+    unsigned cloneThreadCount = 0;
+    uint32_t snapshotInterval = 0;
     #ifdef ASP_DEBUG
     unsigned stepCountLimit = UINT_MAX;
     string traceFileName, dumpFileName;
@@ -169,6 +291,25 @@ int main(int argc, char **argv)
             Usage();
             return 0;
         }
+        else if (option == "b")
+        {
+            if (argc <= 2)
+            {
+                Usage();
+                return 1;
+            }
+
+            string value = (++argv)[1];
+            argc--;
+            char *p;
+            runStepCount = static_cast<uint32_t>
+                (strtoul(value.c_str(), &p, 0));
+            if (*p != 0)
+            {
+                cerr << "Invalid instruction count: " << value << endl;
+                return 1;
+            }
+        }
         else if (option == "c")
         {
             if (argc <= 2)
@@ -207,6 +348,101 @@ int main(int argc, char **argv)
                 return 1;
             }
         }
+        else if (option == "g")
+        {
+            if (argc <= 2)
+            {
+                Usage();
+                return 1;
+            }
+
+            string value = (++argv)[1];
+            argc--;
+            char *p;
+            collectLimit = static_cast<uint32_t>
+                (strtoul(value.c_str(), &p, 0));
+            if (*p != 0)
+            {
+                cerr << "Invalid destruction work limit: " << value << endl;
+                return 1;
+            }
+        }
+        else if (option == "i")
+        {
+            if (argc <= 2)
+            {
+                Usage();
+                return 1;
+            }
+
+            string value = (++argv)[1];
+            argc--;
+            char *p;
+            decodedInstructionCount = static_cast<size_t>
+                (strtol(value.c_str(), &p, 0));
+            if (*p != 0)
+            {
+                cerr << "Invalid decoded instruction count: " << value << endl;
+                return 1;
+            }
+        }
+        else if (option == "j")
+        {
+            if (argc <= 2)
+            {
+                Usage();
+                return 1;
+            }
+
+            string value = (++argv)[1];
+            argc--;
+            char *p;
+            cloneThreadCount = static_cast<unsigned>
+                (strtoul(value.c_str(), &p, 0));
+            if (*p != 0)
+            {
+                cerr << "Invalid thread count: " << value << endl;
+                return 1;
+            }
+        }
+        else if (option == "k")
+        {
+            if (argc <= 2)
+            {
+                Usage();
+                return 1;
+            }
+
+            string value = (++argv)[1];
+            argc--;
+            char *p;
+            stringCacheSize = static_cast<size_t>
+                (strtol(value.c_str(), &p, 0));
+            if (*p != 0)
+            {
+                cerr << "Invalid string cache size: " << value << endl;
+                return 1;
+            }
+        }
+        else if (option == "l")
+        {
+            if (argc <= 2)
+            {
+                Usage();
+                return 1;
+            }
+
+            string value = (++argv)[1];
+            argc--;
+            char *p;
+            nameCacheSize = static_cast<size_t>
+                (strtol(value.c_str(), &p, 0));
+            if (*p != 0)
+            {
+                cerr << "Invalid name cache size: " << value << endl;
+                return 1;
+            }
+        }
         else if (option == "p")
         {
             if (argc <= 2)
@@ -226,6 +462,53 @@ int main(int argc, char **argv)
                 return 1;
             }
         }
+        else if (option == "r")
+        {
+            if (argc <= 2)
+            {
+                Usage();
+                return 1;
+            }
+
+            string value = (++argv)[1];
+            argc--;
+            char *p;
+            integerCacheMin = static_cast<int32_t>
+                (strtol(value.c_str(), &p, 0));
+            bool valid = p != value.c_str() && p[0] == '.' && p[1] == '.';
+            if (valid)
+            {
+                const char *maxString = p + 2;
+                integerCacheMax = static_cast<int32_t>
+                    (strtol(maxString, &p, 0));
+                valid = p != maxString && *p == 0;
+            }
+            if (!valid)
+            {
+                cerr << "Invalid integer range: " << value << endl;
+                return 1;
+            }
+            cacheIntegers = true;
+        }
+        else if (option == "s")
+        {
+            if (argc <= 2)
+            {
+                Usage();
+                return 1;
+            }
+
+            string value = (++argv)[1];
+            argc--;
+            char *p;
+            stackDepth = static_cast<size_t>
+                (strtol(value.c_str(), &p, 0));
+            if (*p != 0)
+            {
+                cerr << "Invalid stack depth: " << value << endl;
+                return 1;
+            }
+        }
         #ifdef ASP_DEBUG
         else if (option == "n")
         {
@@ -315,6 +598,84 @@ int main(int argc, char **argv)
         #endif
         else if (option == "v")
             verbose = true;
+        else if (option == "w")
+        {
+            if (argc <= 2)
+            {
+                Usage();
+                return 1;
+            }
+
+            string value = (++argv)[1];
+            argc--;
+            char *p;
+            workLimit = static_cast<uint32_t>
+                (strtoul(value.c_str(), &p, 0));
+            if (*p != 0)
+            {
+                cerr << "Invalid operation work limit: " << value << endl;
+                return 1;
+            }
+        }
+        else if (option == "x")
+        {
+            if (argc <= 2)
+            {
+                Usage();
+                return 1;
+            }
+
+            string value = (++argv)[1];
+            argc--;
+            char *p;
+            cycleTriggerCount = strtoul(value.c_str(), &p, 0);
+            if (*p != 0)
+            {
+                cerr
+                    << "Invalid cycle collection trigger: " << value << endl;
+                return 1;
+            }
+        }
+        else if (option == "y")
+        {
+            if (argc <= 2)
+            {
+                Usage();
+                return 1;
+            }
+
+            string value = (++argv)[1];
+            argc--;
+            char *p;
+            cycleLimit = static_cast<uint32_t>
+                (strtoul(value.c_str(), &p, 0));
+            if (*p != 0)
+            {
+                cerr
+                    << "Invalid cycle collection work limit: " << value
+                    << endl;
+                return 1;
+            }
+        }
+        else if (option == "z")
+        {
+            if (argc <= 2)
+            {
+                Usage();
+                return 1;
+            }
+
+            string value = (++argv)[1];
+            argc--;
+            char *p;
+            snapshotInterval = static_cast<uint32_t>
+                (strtoul(value.c_str(), &p, 0));
+            if (*p != 0)
+            {
+                cerr << "Invalid snapshot interval: " << value << endl;
+                return 1;
+            }
+        }
         else
         {
             cerr << "Invalid option: " << arg1 << endl;
@@ -462,6 +823,117 @@ int main(int argc, char **argv)
         return 2;
     }
 
+    // Reserve a fixed stack region if requested.
+    if (stackDepth != 0)
+    {
+        AspRunResult setStackResult = AspSetStackDepth(&engine, stackDepth);
+        if (setStackResult != AspRunResult_OK)
+        {
+            cerr
+                << "Error 0x" << hex << uppercase << setfill('0')
+                << setw(2) << setStackResult
+                << " initializing stack: "
+                << AspRunResultToString(static_cast<int>(setStackResult))
+                << endl;
+            CloseFiles(openedFiles);
+            return 2;
+        }
+    }
+
+    // Limit the work done to destroy objects at once if requested.
+    AspSetCollectLimit(&engine, collectLimit);
+
+    // Limit the work done by one step of an operation if requested.
+    AspSetWorkLimit(&engine, workLimit);
+
+    // Reserve a name lookup cache if requested.
+    if (nameCacheSize != 0)
+    {
+        AspRunResult setCacheResult = AspSetNameCacheSize
+            (&engine, nameCacheSize);
+        if (setCacheResult != AspRunResult_OK)
+        {
+            cerr
+                << "Error 0x" << hex << uppercase << setfill('0')
+                << setw(2) << setCacheResult
+                << " initializing name cache: "
+                << AspRunResultToString(static_cast<int>(setCacheResult))
+                << endl;
+            CloseFiles(openedFiles);
+            return 2;
+        }
+    }
+
+    // Reserve constant caches if requested.
+    if (cacheIntegers || stringCacheSize != 0)
+    {
+        AspRunResult setCacheResult = AspRunResult_OK;
+        if (cacheIntegers)
+            setCacheResult = AspSetIntegerCacheRange
+                (&engine, integerCacheMin, integerCacheMax);
+        if (setCacheResult == AspRunResult_OK && stringCacheSize != 0)
+            setCacheResult = AspSetStringCacheSize
+                (&engine, stringCacheSize);
+        if (setCacheResult != AspRunResult_OK)
+        {
+            cerr
+                << "Error 0x" << hex << uppercase << setfill('0')
+                << setw(2) << setCacheResult
+                << " initializing constant cache: "
+                << AspRunResultToString(static_cast<int>(setCacheResult))
+                << endl;
+            CloseFiles(openedFiles);
+            return 2;
+        }
+    }
+
+    // Enable cycle collection if requested.
+    if (cycleTriggerCount != 0)
+    {
+        AspRunResult setCycleResult = AspSetCycleCollection
+            (&engine, cycleTriggerCount);
+        if (setCycleResult != AspRunResult_OK)
+        {
+            cerr
+                << "Error 0x" << hex << uppercase << setfill('0')
+                << setw(2) << setCycleResult
+                << " initializing cycle collection: "
+                << AspRunResultToString(static_cast<int>(setCycleResult))
+                << endl;
+            CloseFiles(openedFiles);
+            return 2;
+        }
+    }
+    AspSetCycleCollectionLimit(&engine, cycleLimit);
+
+    // Allocate a buffer for pre-decoded instructions if requested.
+    auto decodedCode = unique_ptr<char[]>();
+    if (decodedInstructionCount != 0)
+    {
+        size_t decodedCodeByteSize =
+            decodedInstructionCount * AspDecodedInstructionSize();
+        decodedCode.reset(new (nothrow) char[decodedCodeByteSize]);
+        if (decodedCode == nullptr)
+        {
+            cerr << "Error allocating decoded instruction area" << endl;
+            CloseFiles(openedFiles);
+            return 2;
+        }
+        AspRunResult setDecodingResult = AspSetCodeDecoding
+            (&engine, decodedCode.get(), decodedCodeByteSize);
+        if (setDecodingResult != AspRunResult_OK)
+        {
+            cerr
+                << "Error 0x" << hex << uppercase << setfill('0')
+                << setw(2) << setDecodingResult
+                << " initializing code decoding: "
+                << AspRunResultToString(static_cast<int>(setDecodingResult))
+                << endl;
+            CloseFiles(openedFiles);
+            return 2;
+        }
+    }
+
     // Assign the trace output file.
     #ifdef ASP_DEBUG
     AspTraceFile(&engine, traceFile);
@@ -635,6 +1107,10 @@ int main(int argc, char **argv)
             fprintf(reportFile, "%u", static_cast<unsigned>(codeVersion[i]));
         }
         fputc('\n', reportFile);
+        if (decodedInstructionCount != 0)
+            fprintf
+                (reportFile, "Pre-decoded %zu instructions\n",
+                 AspDecodedInstructionCount(&engine));
     }
 
     // Set arguments.
@@ -653,31 +1129,101 @@ int main(int argc, char **argv)
     // Prepare for the run for the potential of being interrupted by the user.
     signal(SIGINT, HandleInterrupt);
 
-    // Run the code.
-    context.sleeping = false;
-    AspRunResult runResult = AspRunResult_OK;
-    unsigned stepCount = 0;
+    // Run the code on an event loop, which sleeps while the script does.
+    context.forkCount = 0;
+    context.cloneIndex = -1;
     #ifdef ASP_DEBUG
     if (stepCountLimit == UINT_MAX)
         fputs("Executing instructions indefinitely...\n", reportFile);
     else
         fprintf(reportFile, "Executing %u instructions...\n", stepCountLimit);
     #endif
-    for (;
-         !Interrupted && runResult == AspRunResult_OK
-         #ifdef ASP_DEBUG
-         && (stepCountLimit == UINT_MAX || stepCount < stepCountLimit)
-         #endif
-         ; stepCount++)
+    auto startTime = chrono::steady_clock::now();
+    clock_t startCpuTime = clock();
+    EventLoop eventLoop(runStepCount, Interrupted, snapshotInterval);
+    #ifdef ASP_DEBUG
+    eventLoop.Add(&engine, &context, stepCountLimit);
+    #else
+    eventLoop.Add(&engine, &context);
+    #endif
+    eventLoop.Run();
+    AspRunResult runResult = eventLoop.TaskAt(0).runResult;
+    unsigned stepCount = eventLoop.TaskAt(0).stepCount;
+
+    // If the script forked, run the requested number of clones of the
+    // engine from where it left off, each with its own data area and
+    // context. The clones are spread over the requested number of threads,
+    // each running an event loop. The result reported is that of the first
+    // clone to fail, if any.
+    unsigned cloneCount = context.forkCount;
+    vector<AspEngine> cloneEngines(cloneCount);
+    vector<StandaloneAspContext> cloneContexts(cloneCount, context);
+    vector<unique_ptr<char[]>> cloneData;
+    AspEngine *resultEngine = &engine;
+    if (cloneCount != 0 && !Interrupted)
     {
-        runResult = AspStep(&engine);
-        if (context.sleeping)
+        for (unsigned i = 0; i < cloneCount; i++)
+        {
+            cloneContexts[i].forkCount = 0;
+            cloneContexts[i].cloneIndex = static_cast<int>(i);
+            cloneData.emplace_back(new (nothrow) char[dataByteSize]);
+            if (cloneData.back() == nullptr)
+            {
+                cerr << "Error allocating clone data area" << endl;
+                CloseFiles(openedFiles);
+                return 2;
+            }
+            AspRunResult cloneResult = AspClone
+                (&cloneEngines[i], &engine,
+                 cloneData.back().get(), dataByteSize, &cloneContexts[i]);
+            if (cloneResult != AspRunResult_OK)
+            {
+                cerr
+                    << "Clone error 0x" << hex << uppercase << setfill('0')
+                    << setw(2) << cloneResult << ": "
+                    << AspRunResultToString(static_cast<int>(cloneResult))
+                    << endl;
+                CloseFiles(openedFiles);
+                return 2;
+            }
+        }
+
+        unsigned loopCount =
+            cloneThreadCount == 0 || cloneThreadCount > cloneCount ?
+            cloneCount : cloneThreadCount;
+        vector<EventLoop> cloneLoops;
+        cloneLoops.reserve(loopCount);
+        for (unsigned i = 0; i < loopCount; i++)
+            cloneLoops.emplace_back
+                (runStepCount, Interrupted, snapshotInterval);
+        for (unsigned i = 0; i < cloneCount; i++)
+            cloneLoops[i % loopCount].Add
+                (&cloneEngines[i], &cloneContexts[i]);
+        vector<thread> cloneThreads;
+        for (auto &cloneLoop: cloneLoops)
+            cloneThreads.emplace_back(&EventLoop::Run, &cloneLoop);
+        for (auto &cloneThread: cloneThreads)
+            cloneThread.join();
+
+        runResult = AspRunResult_Complete;
+        resultEngine = &cloneEngines[0];
+        for (unsigned i = 0; i < cloneCount; i++)
         {
-            while (clock() < context.expiry) ;
-            context.sleeping = false;
+            const auto &task = cloneLoops[i % loopCount].TaskAt
+                (i / loopCount);
+            stepCount += task.stepCount;
+            if (runResult == AspRunResult_Complete &&
+                task.runResult != AspRunResult_Complete)
+            {
+                runResult = task.runResult;
+                resultEngine = &cloneEngines[i];
+            }
         }
     }
 
+    auto runEndTime = chrono::steady_clock::now();
+    clock_t endCpuTime = clock();
+
     // Close the executable if not already done (e.g., in code paging mode).
     if (executableFile != nullptr)
     {
@@ -691,7 +1237,7 @@ int main(int argc, char **argv)
     if (dumpFile == traceFile)
         fputs("---\n", dumpFile);
     fputs("Dump:\n", dumpFile);
-    AspDump(&engine, dumpFile);
+    AspDump(resultEngine, dumpFile);
     #endif
 
     // Report the number of instructions executed in debug mode.
@@ -722,7 +1268,7 @@ int main(int argc, char **argv)
                  runResult, AspRunResultToString(static_cast<int>(runResult)));
 
         // Report the program counter.
-        auto programCounter = AspProgramCounter(&engine);
+        auto programCounter = AspProgramCounter(resultEngine);
         fprintf(statusFile, "Program counter: 0x%07zX", programCounter);
 
         // Attempt to translate the program counter into a source location
@@ -750,17 +1296,57 @@ int main(int argc, char **argv)
         fputc('\n', statusFile);
     }
 
-    // Report low free count.
+    // Report the instruction execution rate and low free count.
     if (verbose)
     {
+        double runTime = chrono::duration<double>(runEndTime - startTime)
+            .count();
+        fprintf
+            (reportFile, "Executed %u instructions in %.3f s", stepCount,
+             runTime);
+        if (runTime > 0.0)
+            fprintf
+                (reportFile, " (%.0f instructions/s)",
+                 static_cast<double>(stepCount) / runTime);
+        fputc('\n', reportFile);
+        double cpuTime =
+            static_cast<double>(endCpuTime - startCpuTime) / CLOCKS_PER_SEC;
+        fprintf(reportFile, "CPU time: %.3f s", cpuTime);
+        if (runTime > 0.0)
+            fprintf
+                (reportFile, " (%.0f%% utilization)",
+                 100.0 * cpuTime / runTime);
+        fputc('\n', reportFile);
         fprintf
             (reportFile, "Low free count: %zu (max %zu)\n",
-             AspLowFreeCount(&engine), AspMaxDataSize(&engine));
+             AspLowFreeCount(resultEngine),
+             AspMaxDataSize(resultEngine));
+        size_t allocationCount = AspAllocationCount(resultEngine, false);
+        fprintf(reportFile, "Allocation count: %zu", allocationCount);
+        if (stepCount != 0)
+            fprintf
+                (reportFile, " (%.2f per instruction)",
+                 static_cast<double>(allocationCount) / stepCount);
+        fputc('\n', reportFile);
+        if (cacheIntegers || stringCacheSize != 0)
+        {
+            fprintf
+                (reportFile, "Constant cache hit count: %zu\n",
+                 AspConstantCacheHitCount(resultEngine, false));
+        }
         if (codePageByteCount != 0)
         {
             fprintf
                 (reportFile, "Code page read count: %zu\n",
-                 AspCodePageReadCount(&engine, false));
+                 AspCodePageReadCount(resultEngine, false));
+        }
+        if (cycleTriggerCount != 0)
+        {
+            fprintf
+                (reportFile,
+                 "Cycle collection passes: %zu (%zu entries reclaimed)\n",
+                 AspCycleCollectionCount(resultEngine, false),
+                 AspCycleReclaimCount(resultEngine, false));
         }
     }
 
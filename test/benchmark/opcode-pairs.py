@@ -0,0 +1,68 @@
+#!/usr/bin/env python3
+
+#
+# Asp op code pair frequency counter.
+#
+# Reads the instruction trace produced by a debug build of the standalone
+# application (asps-d) and reports how often each pair of consecutively
+# executed instructions occurs, most frequent first. Use it to choose
+# candidates for fused instructions, for example:
+#
+#     asps-d -T 2 script.aspe 2>&1 >/dev/null | opcode-pairs.py
+#
+# Multiple trace files may be given as arguments; standard input is read if
+# none are given.
+#
+
+import sys
+
+min_version = (3, 7)
+if sys.version_info < min_version:
+    sys.exit('Python %s.%s or later is required' % min_version)
+
+import argparse, collections, fileinput, re
+
+parser = argparse.ArgumentParser \
+    (description = 'Count op code pairs in Asp instruction traces.')
+parser.add_argument \
+    ('-n', '--count', type = int, default = 30,
+     help = 'number of pairs to report (default: %(default)s)')
+parser.add_argument \
+    ('-s', '--singles', action = 'store_true',
+     help = 'also report single instruction frequencies')
+parser.add_argument('trace', nargs = '*', help = 'trace file')
+args = parser.parse_args()
+
+# Each traced instruction begins with its address and op code, followed by
+# the mnemonic.
+instruction_pattern = re.compile(r'^@0x[0-9A-F]+: 0x[0-9A-F]{2} (\w+)')
+
+singles = collections.Counter()
+pairs = collections.Counter()
+previous = None
+for line in fileinput.input(args.trace):
+    if fileinput.isfirstline():
+        previous = None
+    match = instruction_pattern.match(line)
+    if match is None:
+        continue
+    mnemonic = match.group(1)
+    singles[mnemonic] += 1
+    if previous is not None:
+        pairs[(previous, mnemonic)] += 1
+    previous = mnemonic
+
+total = sum(singles.values())
+if total == 0:
+    sys.exit('No instructions found in trace')
+
+def report(title, counter, total):
+    print(title)
+    for key, count in counter.most_common(args.count):
+        name = ' '.join(key) if isinstance(key, tuple) else key
+        print('%10d %6.2f%%  %s' % (count, 100.0 * count / total, name))
+
+if args.singles:
+    report('Instructions:', singles, total)
+    print()
+report('Instruction pairs:', pairs, max(total - 1, 1))
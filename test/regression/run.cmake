@@ -0,0 +1,73 @@
+#
+# Asp regression test runner. Runs a compiled script with the standalone
+# application and compares its output with the expected output.
+#
+# Invoke with cmake -P, defining the following variables:
+#   ASPS        Path of the standalone application.
+#   OPTIONS     Standalone application options, separated by spaces.
+#   SCRIPT      Path of the compiled script (*.aspe).
+#   EXPECTED    Path of the file holding the expected standard output.
+#   ERROR       Expected first line of standard error. If given, the run
+#               must fail with this error. Otherwise, it must succeed
+#               without any error output.
+#   SORT        If true, compare the lines of output in sorted order, for
+#               scripts whose clones may print in any order. The lines must
+#               not contain semicolons.
+#   TRACE       Path of a file to receive the instruction trace and data
+#               dump of a debug build of the standalone application, which
+#               would otherwise be written to standard output, along with
+#               any error report.
+#
+
+cmake_minimum_required(VERSION 3.5)
+
+separate_arguments(options UNIX_COMMAND "${OPTIONS}")
+if(DEFINED TRACE)
+    list(APPEND options "-t" "${TRACE}" "-u" "${TRACE}")
+endif()
+execute_process(
+    COMMAND "${ASPS}" ${options} "${SCRIPT}"
+    RESULT_VARIABLE result
+    OUTPUT_VARIABLE output
+    ERROR_VARIABLE error
+    )
+file(READ "${EXPECTED}" expected)
+string(REPLACE "\r" "" output "${output}")
+string(REPLACE "\r" "" error "${error}")
+string(REPLACE "\r" "" expected "${expected}")
+
+# Debug builds report errors along with the trace rather than on standard
+# error.
+if(DEFINED TRACE AND NOT result EQUAL 0)
+    file(STRINGS "${TRACE}" traceErrors REGEX "^[A-Za-z]+ error 0x")
+    if(traceErrors)
+        string(REPLACE ";" "\n" traceErrors "${traceErrors}")
+        set(error "${traceErrors}\n${error}")
+    endif()
+endif()
+
+if(SORT)
+    foreach(text output expected)
+        string(REPLACE "\n" ";" lines "${${text}}")
+        list(SORT lines)
+        string(REPLACE ";" "\n" ${text} "${lines}")
+    endforeach()
+endif()
+
+if(DEFINED ERROR)
+    string(REGEX REPLACE "\n.*" "" errorLine "${error}")
+    if(result EQUAL 0 OR NOT errorLine STREQUAL ERROR)
+        message(FATAL_ERROR
+            "Expected error: ${ERROR}\n"
+            "Actual result: ${result}\n${error}")
+    endif()
+elseif(NOT result EQUAL 0 OR NOT error STREQUAL "")
+    message(FATAL_ERROR "Unexpected result: ${result}\n${error}")
+endif()
+
+if(NOT output STREQUAL expected)
+    message(FATAL_ERROR
+        "Output differs from ${EXPECTED}\n"
+        "Expected:\n${expected}\n"
+        "Actual:\n${output}")
+endif()